@@ -0,0 +1,88 @@
+/*
+
+	Example of use of the FFT library to compute a fixed point FFT for a signal
+  sampled through the ADC.
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+  In this example, the samples are read from the ADC into Q15 values, so the
+  whole transform runs on integers. This is much faster on boards without a
+  floating point unit, like the Arduino Uno, and takes half the memory of
+  float arrays. compute() returns the block exponent of the result: the
+  spectrum is the computed values multiplied by 2 to that power.
+*/
+
+#include "arduinoFFT.h"
+
+/*
+These values can be changed in order to evaluate the functions
+*/
+#define CHANNEL A0
+const uint16_t samples = 256; //This value MUST ALWAYS be a power of 2
+const float samplingFrequency = 1000; //Hz, must be less than 10000 due to ADC
+unsigned int sampling_period_us;
+unsigned long microseconds;
+
+/*
+These are the input and output vectors
+Input vectors receive computed results from FFT
+*/
+int16_t vReal[samples];
+int16_t vImag[samples];
+
+/* Create FFT object with weighing factor storage */
+ArduinoFFT<int16_t> FFT = ArduinoFFT<int16_t>(vReal, vImag, samples, samplingFrequency, true);
+
+void setup()
+{
+  sampling_period_us = round(1000000*(1.0/samplingFrequency));
+  Serial.begin(115200);
+  while(!Serial);
+  Serial.println("Ready");
+}
+
+void loop()
+{
+  /*SAMPLING*/
+  microseconds = micros();
+  for(int i=0; i<samples; i++)
+  {
+      /* Center the 10 bit reading on 0 and scale it to Q15 */
+      vReal[i] = (analogRead(CHANNEL) - 512) * 64;
+      vImag[i] = 0;
+      while(micros() - microseconds < sampling_period_us){
+        //empty loop
+      }
+      microseconds += sampling_period_us;
+  }
+  FFT.dcRemoval();
+  FFT.windowing(FFTWindow::Hamming, FFTDirection::Forward);	/* Weigh data */
+  uint8_t exponent = FFT.compute(FFTDirection::Forward); /* Compute FFT */
+  FFT.complexToMagnitude(); /* Compute magnitudes */
+  Serial.print("Block exponent: ");
+  Serial.println(exponent);
+  Serial.println("Computed magnitudes:");
+  for (uint16_t i = 0; i < (samples >> 1); i++)
+  {
+    Serial.print((i * samplingFrequency) / samples, 2);
+    Serial.print("Hz ");
+    Serial.println(vReal[i]);
+  }
+  float x = FFT.majorPeak();
+  Serial.println(x, 6); //Print out what frequency is the most dominant.
+  delay(2000); /* Repeat after delay */
+}
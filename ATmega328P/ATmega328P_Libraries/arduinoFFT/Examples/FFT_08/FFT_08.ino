@@ -0,0 +1,75 @@
+/*
+
+	Example of use of the FFT library to compute a spectrogram of a
+  continuous stream of samples read through the ADC.
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+  In this example, samples are pushed one by one into an ArduinoFFTStream.
+  Every 32 samples (a 75% overlap for 128 samples), the latest 128 samples are
+  windowed and transformed, and the frequency with the highest peak is
+  printed. The level at 50 Hz is also tracked on every sample with a sliding
+  DFT, which is much cheaper than a full transform.
+*/
+
+#include "arduinoFFT.h"
+
+/*
+These values can be changed in order to evaluate the functions
+*/
+#define CHANNEL A0
+const uint16_t samples = 128; //This value MUST ALWAYS be a power of 2
+const uint16_t hop = 32;
+const float samplingFrequency = 1000; //Hz, must be less than 10000 due to ADC
+unsigned int sampling_period_us;
+unsigned long microseconds;
+
+/*
+These are the output vectors
+*/
+float vReal[samples];
+float vImag[(samples >> 1) + 1];
+
+/* Create streaming FFT object */
+ArduinoFFTStream<float> STFT = ArduinoFFTStream<float>(vReal, vImag, samples, hop, samplingFrequency, FFTWindow::Hann);
+
+/* Bins tracked with the sliding DFT */
+const uint_fast16_t bins[] = {50 * samples / 1000};
+
+void setup()
+{
+  sampling_period_us = round(1000000*(1.0/samplingFrequency));
+  STFT.trackBins(bins, 1);
+  Serial.begin(115200);
+  while(!Serial);
+  Serial.println("Ready");
+}
+
+void loop()
+{
+  microseconds = micros();
+  if (STFT.push(analogRead(CHANNEL) - 512.0f))
+  {
+    STFT.fft().complexToMagnitude(vReal, vImag, (samples >> 1) + 1);
+    Serial.print(STFT.fft().majorPeak(), 2);
+    Serial.print("Hz ");
+    Serial.println(STFT.binMagnitude(0), 2);
+  }
+  while(micros() - microseconds < sampling_period_us){
+    //empty loop
+  }
+}
@@ -0,0 +1,82 @@
+/*
+
+	Example of use of the FFT library to transform several channels at once
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+  In this example, the Arduino simulates the sampling of the three axes of an
+  accelerometer, stored interleaved (x, y, z, x, y, z...) the way they are
+  read from the sensor. The three axes are transformed in one call, with the
+  same kernel and plan as a single channel and without copying the axes out.
+  Then the magnitudes and the main frequency of each axis are obtained.
+*/
+
+#include "arduinoFFT.h"
+
+/*
+These values can be changed in order to evaluate the functions
+*/
+const uint16_t samples = 64; //This value MUST ALWAYS be a power of 2
+const uint8_t channels = 3;
+const float signalFrequency[channels] = {100, 250, 400};
+const float samplingFrequency = 1000;
+const uint8_t amplitude = 100;
+
+/*
+These are the input and output vectors
+Input vectors receive computed results from FFT
+*/
+float vReal[samples * channels];
+float vImag[samples * channels];
+float frequencies[channels];
+
+/* Create FFT object */
+ArduinoFFT<float> FFT = ArduinoFFT<float>();
+
+void setup()
+{
+  Serial.begin(115200);
+  while(!Serial);
+  Serial.println("Ready");
+}
+
+void loop()
+{
+  /* Build raw data */
+  for (uint16_t i = 0; i < samples; i++)
+  {
+    for (uint8_t c = 0; c < channels; c++)
+    {
+      float ratio = twoPi * signalFrequency[c] / samplingFrequency;
+      vReal[i * channels + c] = amplitude * sin(i * ratio) / 2.0;
+      vImag[i * channels + c] = 0.0;
+    }
+  }
+  FFT.compute(vReal, vImag, samples, channels, FFTLayout::Interleaved, FFTDirection::Forward);
+  FFT.complexToMagnitude(vReal, vImag, samples, channels, FFTLayout::Interleaved);
+  FFT.majorPeak(vReal, samples, channels, FFTLayout::Interleaved, samplingFrequency, frequencies, nullptr);
+  for (uint8_t c = 0; c < channels; c++)
+  {
+    Serial.print("Axis ");
+    Serial.print(c);
+    Serial.print(": ");
+    Serial.print(frequencies[c], 2);
+    Serial.println("Hz");
+  }
+  while(1); /* Run Once */
+  // delay(2000); /* Repeat after delay */
+}
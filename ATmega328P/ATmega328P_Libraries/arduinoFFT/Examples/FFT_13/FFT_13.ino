@@ -0,0 +1,108 @@
+/*
+
+	Example of use of the FFT library to average a power spectral density and
+  extract spectral features
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+  In this example, frames sampled through the ADC are averaged into a power
+  spectral density with Welch's method. Every 8 frames, the density is printed
+  along with the RMS, the spectral centroid, the flatness and the energy of
+  three bands of the last frame, all computed in a single pass over the
+  magnitudes.
+*/
+
+#include "arduinoFFT.h"
+
+/*
+These values can be changed in order to evaluate the functions
+*/
+#define CHANNEL A0
+const uint16_t samples = 128; //This value MUST ALWAYS be a power of 2
+const float samplingFrequency = 1000; //Hz, must be less than 10000 due to ADC
+unsigned int sampling_period_us;
+unsigned long microseconds;
+
+/*
+These are the input and output vectors
+*/
+float vReal[samples];
+float vImag[(samples >> 1) + 1];
+float vPSD[(samples >> 1) + 1];
+
+/* Band edges in Hz and their energies */
+const float bandEdges[4] = {0, 100, 250, 500};
+float bandEnergies[3];
+
+/* Create Welch averager, with a Hann window */
+ArduinoFFTWelch<float> welch = ArduinoFFTWelch<float>(vReal, vImag, samples, samplingFrequency, FFTWindow::Hann);
+/* Create FFT object used for the features */
+ArduinoFFT<float> FFT = ArduinoFFT<float>(vReal, vImag, samples, samplingFrequency);
+
+void setup()
+{
+  sampling_period_us = round(1000000*(1.0/samplingFrequency));
+  Serial.begin(115200);
+  while(!Serial);
+  Serial.println("Ready");
+}
+
+void loop()
+{
+  /*SAMPLING*/
+  microseconds = micros();
+  for(int i=0; i<samples; i++)
+  {
+      vReal[i] = analogRead(CHANNEL);
+      while(micros() - microseconds < sampling_period_us){
+        //empty loop
+      }
+      microseconds += sampling_period_us;
+  }
+  FFT.dcRemoval();
+  welch.add(); /* Window, transform and accumulate the frame */
+  if (welch.frames() < 8)
+  {
+    return;
+  }
+  welch.psd(vPSD);
+  for (uint16_t i = 0; i <= (samples >> 1); i++)
+  {
+    Serial.print((i * samplingFrequency) / samples, 1);
+    Serial.print("Hz ");
+    Serial.println(vPSD[i], 6);
+  }
+  welch.reset();
+  /* Features of the last frame, whose spectrum is still in vReal and vImag */
+  FFT.complexToMagnitude();
+  FFTFeatures<float> features;
+  FFT.spectralFeatures(&features, bandEdges, 3, bandEnergies);
+  Serial.print("RMS: ");
+  Serial.println(features.rms, 4);
+  Serial.print("Centroid: ");
+  Serial.println(features.centroid, 2);
+  Serial.print("Flatness: ");
+  Serial.println(features.flatness, 4);
+  for (uint8_t b = 0; b < 3; b++)
+  {
+    Serial.print("Band ");
+    Serial.print(b);
+    Serial.print(": ");
+    Serial.println(bandEnergies[b], 4);
+  }
+  delay(2000);
+}
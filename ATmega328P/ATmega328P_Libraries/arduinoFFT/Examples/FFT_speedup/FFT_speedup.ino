@@ -50,6 +50,10 @@ float vImag[samples];
 /* Create FFT object with weighing factor storage */
 ArduinoFFT<float> FFT = ArduinoFFT<float>(vReal, vImag, samples, samplingFrequency, true);
 
+/* Twiddle factors computed once instead of on every call to compute().
+On AVR the plan stays empty, use ArduinoFFTStatic to get them from flash */
+FFTPlan<float> plan = FFTPlan<float>(samples);
+
 #define SCL_INDEX 0x00
 #define SCL_TIME 0x01
 #define SCL_FREQUENCY 0x02
@@ -58,6 +62,8 @@ ArduinoFFT<float> FFT = ArduinoFFT<float>(vReal, vImag, samples, samplingFrequen
 void setup()
 {
   sampling_period_us = round(1000000*(1.0/samplingFrequency));
+  FFT.setPlan(&plan);
+  FFT.setKernel(FFTKernel::Radix4); /* Fewer multiplications per transform */
   Serial.begin(115200);
   Serial.println("Ready");
 }
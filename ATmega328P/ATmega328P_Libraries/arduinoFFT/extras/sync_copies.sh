@@ -0,0 +1,34 @@
+#!/bin/sh
+# The ATmega328P and ESP8266 folders of the repository hold identical copies
+# of this library. Without arguments, fails and lists the differences when the
+# copies don't match. With --copy, makes the other copy match this one.
+
+set -e
+
+LIBRARY=$(cd "$(dirname "$0")/.." && pwd)
+ROOT=$(cd "$LIBRARY/../../.." && pwd)
+AVR="$ROOT/ATmega328P/ATmega328P_Libraries/arduinoFFT"
+ESP="$ROOT/ESP8266/ESP8266_Libraries/arduinoFFT"
+
+if [ "$LIBRARY" = "$AVR" ]; then
+  OTHER=$ESP
+elif [ "$LIBRARY" = "$ESP" ]; then
+  OTHER=$AVR
+else
+  echo "$LIBRARY is not one of the copies of the library" >&2
+  exit 2
+fi
+
+case "$1" in
+"")
+  diff -r "$LIBRARY" "$OTHER"
+  ;;
+--copy)
+  rm -rf "$OTHER"
+  cp -R "$LIBRARY" "$OTHER"
+  ;;
+*)
+  echo "usage: $0 [--copy]" >&2
+  exit 2
+  ;;
+esac
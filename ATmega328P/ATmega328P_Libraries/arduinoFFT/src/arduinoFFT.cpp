@@ -21,6 +21,72 @@
 
 #include "arduinoFFT.h"
 
+template <typename T> FFTPlan<T>::FFTPlan(uint_fast16_t samples) {
+#if FFT_RAM_PLANS
+  // The quarter-wave symmetry used by sine() needs at least 4 samples
+  if (samples < 4) {
+    return;
+  }
+  T *cosTable = new T[samples >> 1];
+  if (cosTable == nullptr) {
+    return;
+  }
+  const double angle = twoPiDouble / samples;
+  for (uint_fast16_t i = 0; i < (samples >> 1); i++) {
+    cosTable[i] = cos(angle * i);
+  }
+  _cosTable = cosTable;
+  _ownsTable = true;
+  _samples = samples;
+#else
+  // The table would be in RAM, which fftReadTable() can't read on this target.
+  // The empty plan leaves the transforms on the computed twiddle factors.
+  (void)samples;
+#endif
+}
+
+template <typename T>
+FFTPlan<T>::FFTPlan(const T *cosTable, uint_fast16_t samples)
+    : _cosTable(cosTable) {
+  if (cosTable != nullptr && samples >= 4) {
+    _samples = samples;
+  }
+}
+
+template <typename T> FFTPlan<T>::~FFTPlan(void) {
+  if (_ownsTable) {
+    delete[] _cosTable;
+  }
+}
+
+// Returns cos(2 * pi * index / samples), index in [0, samples)
+template <typename T> T FFTPlan<T>::cosine(uint_fast16_t index) const {
+  uint_fast16_t half = (_samples >> 1);
+  if (index >= half) {
+    return -read(index - half);
+  }
+  return read(index);
+}
+
+template <typename T> uint_fast16_t FFTPlan<T>::samples(void) const {
+  return _samples;
+}
+
+// Returns sin(2 * pi * index / samples), index in [0, samples)
+template <typename T> T FFTPlan<T>::sine(uint_fast16_t index) const {
+  uint_fast16_t half = (_samples >> 1);
+  uint_fast16_t quarter = (_samples >> 2);
+  if (index >= half) {
+    index -= half;
+    return -read(index < quarter ? quarter - index : index - quarter);
+  }
+  return read(index < quarter ? quarter - index : index - quarter);
+}
+
+template <typename T> T FFTPlan<T>::read(uint_fast16_t index) const {
+  return fftReadTable(&_cosTable[index]);
+}
+
 template <typename T> ArduinoFFT<T>::ArduinoFFT() {}
 
 template <typename T>
@@ -52,11 +118,28 @@ template <typename T>
 void ArduinoFFT<T>::complexToMagnitude(T *vReal, T *vImag,
                                        uint_fast16_t samples) const {
   // vM is half the size of vReal and vImag
-  for (uint_fast16_t i = 0; i < (samples >> 1) + 1; i++) {
+  uint_fast16_t i = kernelMagnitude(vReal, vImag, (samples >> 1) + 1);
+  for (; i < (samples >> 1) + 1; i++) {
     vReal[i] = sqrt_internal(sq(vReal[i]) + sq(vImag[i]));
   }
 }
 
+// Magnitudes of several channels, left in place in the same layout
+template <typename T>
+void ArduinoFFT<T>::complexToMagnitude(T *vReal, T *vImag,
+                                       uint_fast16_t samples,
+                                       uint_fast8_t channels,
+                                       FFTLayout layout) const {
+  uint_fast16_t stride = (layout == FFTLayout::Interleaved) ? channels : 1;
+  uint_fast16_t offset = (layout == FFTLayout::Interleaved) ? 1 : samples;
+  for (uint_fast16_t i = 0; i < (samples >> 1) + 1; i++) {
+    for (uint_fast8_t c = 0; c < channels; c++) {
+      uint_fast16_t a = (i * stride) + (c * offset);
+      vReal[a] = sqrt_internal(sq(vReal[a]) + sq(vImag[a]));
+    }
+  }
+}
+
 template <typename T> void ArduinoFFT<T>::compute(FFTDirection dir) const {
   compute(this->_vReal, this->_vImag, this->_samples, exponent(this->_samples),
           dir);
@@ -72,77 +155,151 @@ void ArduinoFFT<T>::compute(T *vReal, T *vImag, uint_fast16_t samples,
 template <typename T>
 void ArduinoFFT<T>::compute(T *vReal, T *vImag, uint_fast16_t samples,
                             uint_fast8_t power, FFTDirection dir) const {
-#ifdef FFT_SPEED_OVER_PRECISION
-  T oneOverSamples = this->_oneOverSamples;
-  if (!this->_oneOverSamples)
-    oneOverSamples = 1.0 / samples;
+#ifdef COMPLEX_INPUT
+  transform(vReal, vImag, samples, power, dir, true);
+#else
+  // Forward transforms assume a zeroed imaginary part
+  transform(vReal, vImag, samples, power, dir, dir == FFTDirection::Reverse);
 #endif
-  // Reverse bits
-  uint_fast16_t j = 0;
-  for (uint_fast16_t i = 0; i < (samples - 1); i++) {
-    if (i < j) {
-      swap(&vReal[i], &vReal[j]);
-      #ifdef COMPLEX_INPUT
-      swap(&vImag[i], &vImag[j]);
-      #endif
-      if (dir == FFTDirection::Reverse)
-        swap(&vImag[i], &vImag[j]);
-    }
-    uint_fast16_t k = (samples >> 1);
-
-    while (k <= j) {
-      j -= k;
-      k >>= 1;
-    }
-    j += k;
-  }
-  // Compute the FFT
-  T c1 = -1.0;
-  T c2 = 0.0;
-  uint_fast16_t l2 = 1;
-  for (uint_fast8_t l = 0; (l < power); l++) {
-    uint_fast16_t l1 = l2;
-    l2 <<= 1;
-    T u1 = 1.0;
-    T u2 = 0.0;
-    for (j = 0; j < l1; j++) {
-      for (uint_fast16_t i = j; i < samples; i += l2) {
-        uint_fast16_t i1 = i + l1;
-        T t1 = u1 * vReal[i1] - u2 * vImag[i1];
-        T t2 = u1 * vImag[i1] + u2 * vReal[i1];
-        vReal[i1] = vReal[i] - t1;
-        vImag[i1] = vImag[i] - t2;
-        vReal[i] += t1;
-        vImag[i] += t2;
-      }
-      T z = ((u1 * c1) - (u2 * c2));
-      u2 = ((u1 * c2) + (u2 * c1));
-      u1 = z;
-    }
+}
 
-#if defined(__AVR__) && defined(USE_AVR_PROGMEM)
-    c2 = pgm_read_float_near(&(_c2[l]));
-    c1 = pgm_read_float_near(&(_c1[l]));
+// Computes in-place complex-to-complex FFTs of several channels of the same
+// size. Every channel goes through the kernel, plan and bit reversal used by
+// compute(), with interleaved channels read at a stride.
+template <typename T>
+void ArduinoFFT<T>::compute(T *vReal, T *vImag, uint_fast16_t samples,
+                            uint_fast8_t channels, FFTLayout layout,
+                            FFTDirection dir) const {
+#ifdef COMPLEX_INPUT
+  bool complexInput = true;
 #else
-    T cTemp = 0.5 * c1;
-    c2 = sqrt_internal(0.5 - cTemp);
-    c1 = sqrt_internal(0.5 + cTemp);
+  // Forward transforms assume a zeroed imaginary part
+  bool complexInput = (dir == FFTDirection::Reverse);
 #endif
+  // Element i of channel c is at i * stride + c * offset
+  uint_fast16_t stride = (layout == FFTLayout::Interleaved) ? channels : 1;
+  uint_fast16_t offset = (layout == FFTLayout::Interleaved) ? 1 : samples;
+  uint_fast8_t power = exponent(samples);
+  for (uint_fast8_t c = 0; c < channels; c++) {
+    transform(&vReal[c * offset], &vImag[c * offset], samples, power, dir,
+              complexInput, stride);
+  }
+}
 
-    if (dir == FFTDirection::Forward) {
-      c2 = -c2;
-    }
+template <typename T> void ArduinoFFT<T>::computeReal(FFTDirection dir) const {
+  computeReal(this->_vReal, this->_vImag, this->_samples,
+              exponent(this->_samples), dir);
+}
+
+template <typename T>
+void ArduinoFFT<T>::computeReal(T *vReal, T *vImag, uint_fast16_t samples,
+                                FFTDirection dir) const {
+  computeReal(vReal, vImag, samples, exponent(samples), dir);
+}
+
+// Computes the FFT of a real signal through a complex FFT of half its size.
+// Forward: vReal holds the samples real values and vImag needs only
+// (samples / 2) + 1 elements. On return, bins 0 to samples / 2 are stored in
+// vReal and vImag, ready for complexToMagnitude(), and the upper half of vReal
+// is cleared.
+// Reverse: takes bins 0 to samples / 2 in that layout and returns the real
+// signal in vReal.
+template <typename T>
+void ArduinoFFT<T>::computeReal(T *vReal, T *vImag, uint_fast16_t samples,
+                                uint_fast8_t power, FFTDirection dir) const {
+  uint_fast16_t half = (samples >> 1);
+  if (half < 2) {
+    compute(vReal, vImag, samples, power, dir);
+    return;
   }
-  // Scaling for reverse transform
-  if (dir == FFTDirection::Reverse) {
-    for (uint_fast16_t i = 0; i < samples; i++) {
-#ifdef FFT_SPEED_OVER_PRECISION
-      vReal[i] *= oneOverSamples;
-      vImag[i] *= oneOverSamples;
-#else
-      vReal[i] /= samples;
-      vImag[i] /= samples;
-#endif
+  // Twiddle factors of the split step, exp(-2 * pi * i * k / samples)
+  const FFTPlan<T> *plan = this->_plan;
+  if (plan && plan->samples() < samples) {
+    plan = nullptr;
+  }
+  T stepCos = 1.0;
+  T stepSin = 0.0;
+  if (!plan) {
+    stepCos = cos(twoPiDouble / samples);
+    stepSin = sin(twoPiDouble / samples);
+  }
+  T wr = 1.0;
+  T wi = 0.0;
+  if (dir == FFTDirection::Forward) {
+    // Pack the even samples as real part and the odd ones as imaginary part
+    for (uint_fast16_t i = 0; i < half; i++) {
+      vImag[i] = vReal[(i << 1) + 1];
+      vReal[i] = vReal[i << 1];
+    }
+    transform(vReal, vImag, half, power - 1, dir, true);
+    // Split the packed spectrum into the spectrum of the real signal
+    T r0 = vReal[0];
+    vReal[0] = r0 + vImag[0];
+    vReal[half] = r0 - vImag[0];
+    vImag[0] = 0.0;
+    vImag[half] = 0.0;
+    for (uint_fast16_t k = 1; k < (half >> 1); k++) {
+      if (plan) {
+        uint_fast16_t index = k * (plan->samples() / samples);
+        wr = plan->cosine(index);
+        wi = -plan->sine(index);
+      } else {
+        T z = (wr * stepCos) + (wi * stepSin);
+        wi = (wi * stepCos) - (wr * stepSin);
+        wr = z;
+      }
+      uint_fast16_t m = half - k;
+      // Even part and odd part (times -i) of bin k
+      T er = 0.5 * (vReal[k] + vReal[m]);
+      T ei = 0.5 * (vImag[k] - vImag[m]);
+      T or_ = 0.5 * (vImag[k] + vImag[m]);
+      T oi = 0.5 * (vReal[m] - vReal[k]);
+      T tr = (wr * or_) - (wi * oi);
+      T ti = (wr * oi) + (wi * or_);
+      vReal[k] = er + tr;
+      vImag[k] = ei + ti;
+      vReal[m] = er - tr;
+      vImag[m] = ti - ei;
+    }
+    vImag[half >> 1] = -vImag[half >> 1];
+    for (uint_fast16_t i = half + 1; i < samples; i++) {
+      vReal[i] = 0.0;
+    }
+  } else {
+    // Merge the spectrum back into a packed spectrum of half the size
+    T r0 = vReal[0];
+    vReal[0] = 0.5 * (r0 + vReal[half]);
+    vImag[0] = 0.5 * (r0 - vReal[half]);
+    for (uint_fast16_t k = 1; k < (half >> 1); k++) {
+      if (plan) {
+        uint_fast16_t index = k * (plan->samples() / samples);
+        wr = plan->cosine(index);
+        wi = -plan->sine(index);
+      } else {
+        T z = (wr * stepCos) + (wi * stepSin);
+        wi = (wi * stepCos) - (wr * stepSin);
+        wr = z;
+      }
+      uint_fast16_t m = half - k;
+      T er = 0.5 * (vReal[k] + vReal[m]);
+      T ei = 0.5 * (vImag[k] - vImag[m]);
+      // Odd part, (X[k] - conj(X[half - k])) / 2 rotated by conj(w)
+      T dr = 0.5 * (vReal[k] - vReal[m]);
+      T di = 0.5 * (vImag[k] + vImag[m]);
+      T or_ = (wr * dr) + (wi * di);
+      T oi = (wr * di) - (wi * dr);
+      // Packed bins are even + i * odd
+      vReal[k] = er - oi;
+      vImag[k] = ei + or_;
+      vReal[m] = er + oi;
+      vImag[m] = or_ - ei;
+    }
+    vImag[half >> 1] = -vImag[half >> 1];
+    transform(vReal, vImag, half, power - 1, dir, true);
+    // Unpack the real and imaginary parts into even and odd samples
+    for (uint_fast16_t i = half; i-- > 0;) {
+      vReal[(i << 1) + 1] = vImag[i];
+      vReal[i << 1] = vReal[i];
     }
   }
 }
@@ -185,27 +342,23 @@ template <typename T>
 void ArduinoFFT<T>::majorPeak(T *vData, uint_fast16_t samples,
                               T samplingFrequency, T *frequency,
                               T *magnitude) const {
-  T maxY = 0;
-  uint_fast16_t IndexOfMaxY = 0;
-  findMaxY(vData, (samples >> 1) + 1, &maxY, &IndexOfMaxY);
+  findPeak(vData, 1, samples, samplingFrequency, frequency, magnitude);
+}
 
-  T delta = 0.5 * ((vData[IndexOfMaxY - 1] - vData[IndexOfMaxY + 1]) /
-                   (vData[IndexOfMaxY - 1] - (2.0 * vData[IndexOfMaxY]) +
-                    vData[IndexOfMaxY + 1]));
-  if (IndexOfMaxY == (samples >> 1)) { // To improve calculation on edge values
-    *frequency = ((IndexOfMaxY + delta) * samplingFrequency) / (samples);
-  } else {
-    *frequency = ((IndexOfMaxY + delta) * samplingFrequency) / (samples - 1);
-  }
-  // returned value: interpolated frequency peak apex
-  if (magnitude != nullptr) {
-#if defined(ESP8266) || defined(ESP32)
-    *magnitude = fabs(vData[IndexOfMaxY - 1] - (2.0 * vData[IndexOfMaxY]) +
-                      vData[IndexOfMaxY + 1]);
-#else
-    *magnitude = abs(vData[IndexOfMaxY - 1] - (2.0 * vData[IndexOfMaxY]) +
-                     vData[IndexOfMaxY + 1]);
-#endif
+// Peak of each channel of magnitudes left by the batched complexToMagnitude()
+template <typename T>
+void ArduinoFFT<T>::majorPeak(T *vData, uint_fast16_t samples,
+                              uint_fast8_t channels, FFTLayout layout,
+                              T samplingFrequency, T *frequencies,
+                              T *magnitudes) const {
+  for (uint_fast8_t c = 0; c < channels; c++) {
+    if (layout == FFTLayout::Interleaved) {
+      findPeak(vData + c, channels, samples, samplingFrequency,
+               &frequencies[c], magnitudes ? &magnitudes[c] : nullptr);
+    } else {
+      findPeak(vData + (c * samples), 1, samples, samplingFrequency,
+               &frequencies[c], magnitudes ? &magnitudes[c] : nullptr);
+    }
   }
 }
 
@@ -259,6 +412,68 @@ void ArduinoFFT<T>::majorPeakParabola(T *vData, uint_fast16_t samples,
   }
 }
 
+template <typename T>
+uint_fast8_t ArduinoFFT<T>::majorPeaks(T *frequencies, T *magnitudes,
+                                       uint_fast8_t count,
+                                       uint_fast16_t minSeparation,
+                                       FFTInterpolation interpolation) const {
+  return majorPeaks(this->_vReal, this->_samples, this->_samplingFrequency,
+                    frequencies, magnitudes, count, minSeparation,
+                    interpolation);
+}
+
+// Finds the count largest peaks of the magnitudes in vData in a single scan,
+// sorted by decreasing magnitude. Peaks closer than minSeparation bins are
+// merged into the largest one. Returns the number of peaks found.
+template <typename T>
+uint_fast8_t ArduinoFFT<T>::majorPeaks(T *vData, uint_fast16_t samples,
+                                       T samplingFrequency, T *frequencies,
+                                       T *magnitudes, uint_fast8_t count,
+                                       uint_fast16_t minSeparation,
+                                       FFTInterpolation interpolation) const {
+  if (count == 0) {
+    return 0;
+  }
+  // A min-heap of the largest peaks is kept in the output arrays, with the
+  // bin indexes in frequencies until the end
+  uint_fast8_t size = 0;
+  uint_fast16_t pending = 0;
+  // Bin 0 holds the DC offset and is skipped, like in majorPeak()
+  for (uint_fast16_t i = 1; i < (samples >> 1); i++) {
+    if ((vData[i - 1] < vData[i]) && (vData[i] >= vData[i + 1])) {
+      if (pending && (i - pending) < minSeparation) {
+        // Too close to the previous peak, keep the largest
+        if (vData[i] > vData[pending]) {
+          pending = i;
+        }
+      } else {
+        if (pending) {
+          pushPeak(frequencies, magnitudes, &size, count, pending,
+                   vData[pending]);
+        }
+        pending = i;
+      }
+    }
+  }
+  if (pending) {
+    pushPeak(frequencies, magnitudes, &size, count, pending, vData[pending]);
+  }
+  // Heap sort, the smallest peak goes to the end
+  for (uint_fast8_t last = size; last > 1; last--) {
+    swap(&frequencies[0], &frequencies[last - 1]);
+    swap(&magnitudes[0], &magnitudes[last - 1]);
+    siftDown(frequencies, magnitudes, last - 1, 0);
+  }
+  for (uint_fast8_t n = 0; n < size; n++) {
+    uint_fast16_t index = frequencies[n];
+    T delta;
+    interpolate(vData[index - 1], vData[index], vData[index + 1], interpolation,
+                &delta, &magnitudes[n]);
+    frequencies[n] = ((index + delta) * samplingFrequency) / samples;
+  }
+  return size;
+}
+
 template <typename T> uint8_t ArduinoFFT<T>::revision(void) {
   return (FFT_LIB_REV);
 }
@@ -280,6 +495,103 @@ void ArduinoFFT<T>::setArrays(T *vReal, T *vImag, uint_fast16_t samples) {
   }
 }
 
+// Select the butterfly engine used by compute() and computeReal()
+template <typename T> void ArduinoFFT<T>::setKernel(FFTKernel kernel) {
+  _kernel = kernel;
+}
+
+// Use the twiddle factors of a plan instead of computing them on each call.
+// Pass nullptr to go back to the on-the-fly computation. The plan is not owned.
+template <typename T> void ArduinoFFT<T>::setPlan(const FFTPlan<T> *plan) {
+  _plan = plan;
+}
+
+template <typename T>
+void ArduinoFFT<T>::spectralFeatures(FFTFeatures<T> *features,
+                                     const T *bandEdges, uint_fast8_t bands,
+                                     T *bandEnergies) const {
+  spectralFeatures(this->_vReal, this->_samples, this->_samplingFrequency,
+                   features, bandEdges, bands, bandEnergies);
+}
+
+// Computes the features of the magnitudes left by complexToMagnitude() in a
+// single pass over bins 0 to samples / 2. Band b spans [bandEdges[b],
+// bandEdges[b + 1]) Hz, with edges in increasing order; its energy is its
+// share of rms^2.
+template <typename T>
+void ArduinoFFT<T>::spectralFeatures(T *vData, uint_fast16_t samples,
+                                     T samplingFrequency,
+                                     FFTFeatures<T> *features,
+                                     const T *bandEdges, uint_fast8_t bands,
+                                     T *bandEnergies) const {
+  uint_fast16_t half = (samples >> 1);
+  T binWidth = samplingFrequency / samples;
+  for (uint_fast8_t b = 0; b < bands; b++) {
+    bandEnergies[b] = 0;
+  }
+  uint_fast8_t band = 0;
+  // Moments of the frequency, normalized to [0, 1] to keep precision
+  T sum = 0;
+  T moment1 = 0;
+  T moment2 = 0;
+  T moment3 = 0;
+  T moment4 = 0;
+  T energy = 0;
+  T logPower = 0;
+  for (uint_fast16_t i = 0; i <= half; i++) {
+    T magnitude = vData[i];
+    T power = sq(magnitude);
+    // Bins 0 and samples / 2 appear once in the full spectrum, others twice
+    T share = (i == 0 || i == half) ? power : 2 * power;
+    T x = T(i) / half;
+    T weighted = magnitude * x;
+    sum += magnitude;
+    moment1 += weighted;
+    weighted *= x;
+    moment2 += weighted;
+    weighted *= x;
+    moment3 += weighted;
+    moment4 += weighted * x;
+    energy += share;
+    logPower += log(power > 1e-20 ? power : 1e-20);
+    if (bands) {
+      T frequency = i * binWidth;
+      while (band < bands && frequency >= bandEdges[band + 1]) {
+        band++;
+      }
+      if (band < bands && frequency >= bandEdges[band]) {
+        bandEnergies[band] += share;
+      }
+    }
+  }
+  T bins = half + 1;
+  T scale = 1.0 / (T(samples) * samples);
+  for (uint_fast8_t b = 0; b < bands; b++) {
+    bandEnergies[b] *= scale;
+  }
+  features->rms = sqrt(energy * scale);
+  // Mean of the power over the same bins as the logarithms
+  T meanPower = 0;
+  if (energy > 0) {
+    meanPower = (energy + sq(vData[0]) + sq(vData[half])) / (2 * bins);
+  }
+  features->flatness =
+      (meanPower > 0) ? (exp(logPower / bins) / meanPower) : 0;
+  if (sum > 0) {
+    T mean = moment1 / sum;
+    T variance = (moment2 / sum) - sq(mean);
+    T fourth = (moment4 / sum) - (4 * mean * moment3 / sum) +
+               (6 * sq(mean) * moment2 / sum) - (3 * sq(sq(mean)));
+    features->centroid = mean * half * binWidth;
+    features->spread = (variance > 0) ? (sqrt(variance) * half * binWidth) : 0;
+    features->kurtosis = (variance > 0) ? (fourth / sq(variance)) : 0;
+  } else {
+    features->centroid = 0;
+    features->spread = 0;
+    features->kurtosis = 0;
+  }
+}
+
 template <typename T>
 void ArduinoFFT<T>::windowing(FFTWindow windowType, FFTDirection dir,
                               bool withCompensation) {
@@ -312,7 +624,8 @@ void ArduinoFFT<T>::windowing(T *vData, uint_fast16_t samples,
   // Weighing factors are computed once before multiple use of FFT
   // The weighing function is symmetric; half the weighs are recorded
   if (windowingFactors != nullptr && windowType == FFTWindow::Precompiled) {
-    for (uint_fast16_t i = 0; i < (samples >> 1); i++) {
+    uint_fast16_t i = kernelWindowing(vData, samples, windowingFactors, dir);
+    for (; i < (samples >> 1); i++) {
       if (dir == FFTDirection::Forward) {
         vData[i] *= windowingFactors[i];
         vData[samples - (i + 1)] *= windowingFactors[i];
@@ -328,67 +641,14 @@ void ArduinoFFT<T>::windowing(T *vData, uint_fast16_t samples,
       }
     }
   } else {
-    T samplesMinusOne = (T(samples) - 1.0);
     T compensationFactor;
     if (withCompensation) {
       compensationFactor =
           _WindowCompensationFactors[static_cast<uint_fast8_t>(windowType)];
     }
     for (uint_fast16_t i = 0; i < (samples >> 1); i++) {
-      T indexMinusOne = T(i);
-      T ratio = (indexMinusOne / samplesMinusOne);
-      T weighingFactor = 1.0;
       // Compute and record weighting factor
-      switch (windowType) {
-      case FFTWindow::Hamming: // hamming
-        weighingFactor = 0.54 - (0.46 * cos(twoPi * ratio));
-        break;
-      case FFTWindow::Hann: // hann
-        weighingFactor = 0.54 * (1.0 - cos(twoPi * ratio));
-        break;
-      case FFTWindow::Triangle: // triangle (Bartlett)
-#if defined(ESP8266) || defined(ESP32)
-        weighingFactor =
-            1.0 - ((2.0 * fabs(indexMinusOne - (samplesMinusOne / 2.0))) /
-                   samplesMinusOne);
-#else
-        weighingFactor =
-            1.0 - ((2.0 * abs(indexMinusOne - (samplesMinusOne / 2.0))) /
-                   samplesMinusOne);
-#endif
-        break;
-      case FFTWindow::Nuttall: // nuttall
-        weighingFactor = 0.355768 - (0.487396 * (cos(twoPi * ratio))) +
-                         (0.144232 * (cos(fourPi * ratio))) -
-                         (0.012604 * (cos(sixPi * ratio)));
-        break;
-      case FFTWindow::Blackman: // blackman
-        weighingFactor = 0.42323 - (0.49755 * (cos(twoPi * ratio))) +
-                         (0.07922 * (cos(fourPi * ratio)));
-        break;
-      case FFTWindow::Blackman_Nuttall: // blackman nuttall
-        weighingFactor = 0.3635819 - (0.4891775 * (cos(twoPi * ratio))) +
-                         (0.1365995 * (cos(fourPi * ratio))) -
-                         (0.0106411 * (cos(sixPi * ratio)));
-        break;
-      case FFTWindow::Blackman_Harris: // blackman harris
-        weighingFactor = 0.35875 - (0.48829 * (cos(twoPi * ratio))) +
-                         (0.14128 * (cos(fourPi * ratio))) -
-                         (0.01168 * (cos(sixPi * ratio)));
-        break;
-      case FFTWindow::Flat_top: // flat top
-        weighingFactor = 0.2810639 - (0.5208972 * cos(twoPi * ratio)) +
-                         (0.1980399 * cos(fourPi * ratio));
-        break;
-      case FFTWindow::Welch: // welch
-        weighingFactor = 1.0 - sq((indexMinusOne - samplesMinusOne / 2.0) /
-                                  (samplesMinusOne / 2.0));
-        break;
-      default:
-        // This is Rectangle windowing which doesn't do anything
-        // and Precompiled which shouldn't be selected
-        break;
-      }
+      T weighingFactor = windowingFactor(windowType, i, samples);
       if (withCompensation) {
         weighingFactor *= compensationFactor;
       }
@@ -412,6 +672,68 @@ void ArduinoFFT<T>::windowing(T *vData, uint_fast16_t samples,
   }
 }
 
+// Amplitude compensation of a window function, including the factor 2 of a
+// one-sided spectrum
+template <typename T>
+T ArduinoFFT<T>::windowCompensation(FFTWindow windowType) {
+  return _WindowCompensationFactors[static_cast<uint_fast8_t>(windowType)];
+}
+
+// Weighing factor of sample index (in the first half) for a window function
+template <typename T>
+T ArduinoFFT<T>::windowingFactor(FFTWindow windowType, uint_fast16_t index,
+                                 uint_fast16_t samples) {
+  T samplesMinusOne = (T(samples) - 1.0);
+  T indexMinusOne = T(index);
+  T ratio = (indexMinusOne / samplesMinusOne);
+  T weighingFactor = 1.0;
+  switch (windowType) {
+  case FFTWindow::Hamming: // hamming
+    weighingFactor = 0.54 - (0.46 * cos(twoPi * ratio));
+    break;
+  case FFTWindow::Hann: // hann
+    weighingFactor = 0.54 * (1.0 - cos(twoPi * ratio));
+    break;
+  case FFTWindow::Triangle: // triangle (Bartlett)
+    weighingFactor =
+        1.0 - ((2.0 * fabs(indexMinusOne - (samplesMinusOne / 2.0))) /
+               samplesMinusOne);
+    break;
+  case FFTWindow::Nuttall: // nuttall
+    weighingFactor = 0.355768 - (0.487396 * (cos(twoPi * ratio))) +
+                     (0.144232 * (cos(fourPi * ratio))) -
+                     (0.012604 * (cos(sixPi * ratio)));
+    break;
+  case FFTWindow::Blackman: // blackman
+    weighingFactor = 0.42323 - (0.49755 * (cos(twoPi * ratio))) +
+                     (0.07922 * (cos(fourPi * ratio)));
+    break;
+  case FFTWindow::Blackman_Nuttall: // blackman nuttall
+    weighingFactor = 0.3635819 - (0.4891775 * (cos(twoPi * ratio))) +
+                     (0.1365995 * (cos(fourPi * ratio))) -
+                     (0.0106411 * (cos(sixPi * ratio)));
+    break;
+  case FFTWindow::Blackman_Harris: // blackman harris
+    weighingFactor = 0.35875 - (0.48829 * (cos(twoPi * ratio))) +
+                     (0.14128 * (cos(fourPi * ratio))) -
+                     (0.01168 * (cos(sixPi * ratio)));
+    break;
+  case FFTWindow::Flat_top: // flat top
+    weighingFactor = 0.2810639 - (0.5208972 * cos(twoPi * ratio)) +
+                     (0.1980399 * cos(fourPi * ratio));
+    break;
+  case FFTWindow::Welch: // welch
+    weighingFactor = 1.0 - sq((indexMinusOne - samplesMinusOne / 2.0) /
+                              (samplesMinusOne / 2.0));
+    break;
+  default:
+    // This is Rectangle windowing which doesn't do anything
+    // and Precompiled which shouldn't be selected
+    break;
+  }
+  return weighingFactor;
+}
+
 // Private functions
 
 template <typename T>
@@ -425,7 +747,7 @@ uint_fast8_t ArduinoFFT<T>::exponent(uint_fast16_t value) const {
 
 template <typename T>
 void ArduinoFFT<T>::findMaxY(T *vData, uint_fast16_t length, T *maxY,
-                             uint_fast16_t *index) const {
+                             uint_fast16_t *index, uint_fast16_t stride) const {
   *maxY = 0;
   // A signal with a DC offset produces a spike on bin 0 that should be ignored.
   // Start the search on bin 1.
@@ -433,13 +755,58 @@ void ArduinoFFT<T>::findMaxY(T *vData, uint_fast16_t length, T *maxY,
   // If sampling_frequency = 2 * max_frequency in signal,
   // value would be stored at position samples/2
   for (uint_fast16_t i = 1; i < length; i++) {
-    if ((vData[i - 1] < vData[i]) && (vData[i] > vData[i + 1])) {
-      if (vData[i] > vData[*index]) {
+    T y = vData[i * stride];
+    if ((vData[(i - 1) * stride] < y) && (y > vData[(i + 1) * stride])) {
+      if (y > vData[*index * stride]) {
         *index = i;
       }
     }
   }
-  *maxY = vData[*index];
+  *maxY = vData[*index * stride];
+}
+
+// Interpolated peak of magnitudes spaced stride values apart
+template <typename T>
+void ArduinoFFT<T>::findPeak(T *vData, uint_fast16_t stride,
+                             uint_fast16_t samples, T samplingFrequency,
+                             T *frequency, T *magnitude) const {
+  T maxY = 0;
+  uint_fast16_t IndexOfMaxY = 0;
+  findMaxY(vData, (samples >> 1) + 1, &maxY, &IndexOfMaxY, stride);
+
+  T yPrev = vData[(IndexOfMaxY - 1) * stride];
+  T yPeak = vData[IndexOfMaxY * stride];
+  T yNext = vData[(IndexOfMaxY + 1) * stride];
+  T delta = 0.5 * ((yPrev - yNext) / (yPrev - (2.0 * yPeak) + yNext));
+  if (IndexOfMaxY == (samples >> 1)) { // To improve calculation on edge values
+    *frequency = ((IndexOfMaxY + delta) * samplingFrequency) / (samples);
+  } else {
+    *frequency = ((IndexOfMaxY + delta) * samplingFrequency) / (samples - 1);
+  }
+  // returned value: interpolated frequency peak apex
+  if (magnitude != nullptr) {
+    *magnitude = fabs(yPrev - (2.0 * yPeak) + yNext);
+  }
+}
+
+// Offset in bins and magnitude of the apex of a peak at y2
+template <typename T>
+void ArduinoFFT<T>::interpolate(T y1, T y2, T y3,
+                                FFTInterpolation interpolation, T *delta,
+                                T *magnitude) const {
+  if (interpolation == FFTInterpolation::Gaussian && y1 > 0 && y3 > 0) {
+    y1 = log(y1);
+    y2 = log(y2);
+    y3 = log(y3);
+  } else {
+    interpolation = FFTInterpolation::Parabola;
+  }
+  T denominator = y1 - (2.0 * y2) + y3;
+  *delta = (denominator == 0) ? 0 : (0.5 * (y1 - y3) / denominator);
+  *magnitude = y2 - (0.25 * (y1 - y3) * *delta);
+  if (interpolation == FFTInterpolation::Gaussian) {
+    *magnitude = exp(*magnitude);
+  }
 }
 
 template <typename T>
@@ -458,12 +825,299 @@ void ArduinoFFT<T>::parabola(T x1, T y1, T x2, T y2, T x3, T y3, T *a, T *b,
        reversed_denom;
 }
 
+// Advances the twiddle factor rotation (c1, c2) of stage l to stage l + 1
+template <typename T>
+void ArduinoFFT<T>::nextRotation(uint_fast8_t l, FFTDirection dir, T *c1,
+                                 T *c2) const {
+  if (!fftRotationTable(l, c1, c2)) {
+    T cTemp = 0.5 * *c1;
+    *c2 = sqrt_internal(0.5 - cTemp);
+    *c1 = sqrt_internal(0.5 + cTemp);
+  }
+
+  if (dir == FFTDirection::Forward) {
+    *c2 = -*c2;
+  }
+}
+
+// Radix-2 decimation-in-time stages over bit-reversed data, whose elements are
+// stride apart
+template <typename T>
+void ArduinoFFT<T>::radix2(T *vReal, T *vImag, uint_fast16_t samples,
+                           uint_fast8_t power, FFTDirection dir,
+                           const FFTPlan<T> *plan,
+                           uint_fast16_t stride) const {
+  T c1 = -1.0;
+  T c2 = 0.0;
+  uint_fast16_t end = samples * stride;
+  uint_fast16_t l2 = 1;
+  for (uint_fast8_t l = 0; (l < power); l++) {
+    uint_fast16_t l1 = l2;
+    l2 <<= 1;
+    // The vector kernels take contiguous elements
+    if (stride == 1 &&
+        kernelStage(vReal, vImag, samples, l, dir, plan, c1, c2)) {
+      if (!plan) {
+        nextRotation(l, dir, &c1, &c2);
+      }
+      continue;
+    }
+    T u1 = 1.0;
+    T u2 = 0.0;
+    for (uint_fast16_t j = 0; j < l1; j++) {
+      if (plan) {
+        uint_fast16_t index = j * (plan->samples() >> (l + 1));
+        u1 = plan->cosine(index);
+        u2 = plan->sine(index);
+        if (dir == FFTDirection::Forward) {
+          u2 = -u2;
+        }
+      }
+      for (uint_fast16_t i = j * stride; i < end; i += l2 * stride) {
+        uint_fast16_t i1 = i + (l1 * stride);
+        T t1 = u1 * vReal[i1] - u2 * vImag[i1];
+        T t2 = u1 * vImag[i1] + u2 * vReal[i1];
+        vReal[i1] = vReal[i] - t1;
+        vImag[i1] = vImag[i] - t2;
+        vReal[i] += t1;
+        vImag[i] += t2;
+      }
+      if (!plan) {
+        T z = ((u1 * c1) - (u2 * c2));
+        u2 = ((u1 * c2) + (u2 * c1));
+        u1 = z;
+      }
+    }
+    // The plan already holds the twiddle factors of the next stage
+    if (!plan) {
+      nextRotation(l, dir, &c1, &c2);
+    }
+  }
+}
+
+// Radix-4 decimation-in-time stages over bit-reversed data. Each pass merges
+// two radix-2 stages: with w the twiddle factor of the larger one, the four
+// inputs are weighted by 1, w^2, w and w^3, which takes 3 complex
+// multiplications per 4 points instead of 4. An odd power starts with a
+// radix-2 stage, whose twiddle factors are all 1.
+template <typename T>
+void ArduinoFFT<T>::radix4(T *vReal, T *vImag, uint_fast16_t samples,
+                           uint_fast8_t power, FFTDirection dir,
+                           const FFTPlan<T> *plan,
+                           uint_fast16_t stride) const {
+  T c1 = -1.0;
+  T c2 = 0.0;
+  uint_fast16_t end = samples * stride;
+  uint_fast8_t l = 0;
+  if (power & 1) {
+    for (uint_fast16_t i = 0; i < end; i += 2 * stride) {
+      T tr = vReal[i + stride];
+      T ti = vImag[i + stride];
+      vReal[i + stride] = vReal[i] - tr;
+      vImag[i + stride] = vImag[i] - ti;
+      vReal[i] += tr;
+      vImag[i] += ti;
+    }
+    if (!plan) {
+      nextRotation(l, dir, &c1, &c2);
+    }
+    l++;
+  }
+  for (; (l + 1) < power; l += 2) {
+    uint_fast16_t l1 = ((uint_fast16_t)1 << l);
+    uint_fast16_t l4 = (l1 << 2);
+    // Rotation of the larger stage of the pair
+    if (!plan) {
+      nextRotation(l, dir, &c1, &c2);
+    }
+    T u1 = 1.0;
+    T u2 = 0.0;
+    for (uint_fast16_t j = 0; j < l1; j++) {
+      T w1r, w1i, w2r, w2i, w3r, w3i;
+      if (plan) {
+        uint_fast16_t index = j * (plan->samples() >> (l + 2));
+        w1r = plan->cosine(index);
+        w1i = plan->sine(index);
+        w2r = plan->cosine(index << 1);
+        w2i = plan->sine(index << 1);
+        w3r = plan->cosine(3 * index);
+        w3i = plan->sine(3 * index);
+        if (dir == FFTDirection::Forward) {
+          w1i = -w1i;
+          w2i = -w2i;
+          w3i = -w3i;
+        }
+      } else {
+        w1r = u1;
+        w1i = u2;
+        w2r = (u1 * u1) - (u2 * u2);
+        w2i = 2 * u1 * u2;
+        w3r = (w2r * u1) - (w2i * u2);
+        w3i = (w2r * u2) + (w2i * u1);
+      }
+      for (uint_fast16_t i0 = j * stride; i0 < end; i0 += l4 * stride) {
+        uint_fast16_t i1 = i0 + (l1 * stride);
+        uint_fast16_t i2 = i1 + (l1 * stride);
+        uint_fast16_t i3 = i2 + (l1 * stride);
+        T t1r = w2r * vReal[i1] - w2i * vImag[i1];
+        T t1i = w2r * vImag[i1] + w2i * vReal[i1];
+        T t2r = w1r * vReal[i2] - w1i * vImag[i2];
+        T t2i = w1r * vImag[i2] + w1i * vReal[i2];
+        T t3r = w3r * vReal[i3] - w3i * vImag[i3];
+        T t3i = w3r * vImag[i3] + w3i * vReal[i3];
+        T a0r = vReal[i0] + t1r;
+        T a0i = vImag[i0] + t1i;
+        T a1r = vReal[i0] - t1r;
+        T a1i = vImag[i0] - t1i;
+        T b0r = t2r + t3r;
+        T b0i = t2i + t3i;
+        // (t2 - t3) rotated by -i (forward) or +i (reverse)
+        T b1r = t2i - t3i;
+        T b1i = t3r - t2r;
+        if (dir == FFTDirection::Reverse) {
+          b1r = -b1r;
+          b1i = -b1i;
+        }
+        vReal[i0] = a0r + b0r;
+        vImag[i0] = a0i + b0i;
+        vReal[i2] = a0r - b0r;
+        vImag[i2] = a0i - b0i;
+        vReal[i1] = a1r + b1r;
+        vImag[i1] = a1i + b1i;
+        vReal[i3] = a1r - b1r;
+        vImag[i3] = a1i - b1i;
+      }
+      if (!plan) {
+        T z = ((u1 * c1) - (u2 * c2));
+        u2 = ((u1 * c2) + (u2 * c1));
+        u1 = z;
+      }
+    }
+    if (!plan) {
+      nextRotation(l + 1, dir, &c1, &c2);
+    }
+  }
+}
+
+// Adds a peak to a min-heap holding up to count peaks
+template <typename T>
+void ArduinoFFT<T>::pushPeak(T *heapIndexes, T *heapValues, uint_fast8_t *size,
+                             uint_fast8_t count, uint_fast16_t index,
+                             T value) const {
+  if (*size < count) {
+    // Sift up
+    uint_fast8_t position = (*size)++;
+    while (position > 0) {
+      uint_fast8_t parent = (position - 1) >> 1;
+      if (heapValues[parent] <= value) {
+        break;
+      }
+      heapIndexes[position] = heapIndexes[parent];
+      heapValues[position] = heapValues[parent];
+      position = parent;
+    }
+    heapIndexes[position] = index;
+    heapValues[position] = value;
+  } else if (value > heapValues[0]) {
+    // Replace the smallest peak
+    heapIndexes[0] = index;
+    heapValues[0] = value;
+    siftDown(heapIndexes, heapValues, *size, 0);
+  }
+}
+
+template <typename T>
+void ArduinoFFT<T>::siftDown(T *heapIndexes, T *heapValues, uint_fast8_t size,
+                             uint_fast8_t position) const {
+  while (true) {
+    uint_fast8_t smallest = position;
+    uint_fast16_t left = ((uint_fast16_t)position << 1) + 1;
+    uint_fast16_t right = left + 1;
+    if (left < size && heapValues[left] < heapValues[smallest]) {
+      smallest = left;
+    }
+    if (right < size && heapValues[right] < heapValues[smallest]) {
+      smallest = right;
+    }
+    if (smallest == position) {
+      return;
+    }
+    swap(&heapIndexes[position], &heapIndexes[smallest]);
+    swap(&heapValues[position], &heapValues[smallest]);
+    position = smallest;
+  }
+}
+
 template <typename T> void ArduinoFFT<T>::swap(T *a, T *b) const {
   T temp = *a;
   *a = *b;
   *b = temp;
 }
 
+// Transforms samples elements that are stride apart
+template <typename T>
+void ArduinoFFT<T>::transform(T *vReal, T *vImag, uint_fast16_t samples,
+                              uint_fast8_t power, FFTDirection dir,
+                              bool complexInput, uint_fast16_t stride) const {
+#ifdef FFT_SPEED_OVER_PRECISION
+  T oneOverSamples = this->_oneOverSamples;
+  if (!this->_oneOverSamples || samples != this->_samples)
+    oneOverSamples = 1.0 / samples;
+#endif
+  // Reverse bits
+  if (this->_bitReversal && samples == this->_samples) {
+    // Table of a compile-time sized transform
+    for (uint_fast16_t i = 1; i < (samples - 1); i++) {
+      uint_fast16_t j = fftReadTable(&this->_bitReversal[i]);
+      if (i < j) {
+        swap(&vReal[i * stride], &vReal[j * stride]);
+        if (complexInput)
+          swap(&vImag[i * stride], &vImag[j * stride]);
+      }
+    }
+  } else {
+    uint_fast16_t j = 0;
+    for (uint_fast16_t i = 0; i < (samples - 1); i++) {
+      if (i < j) {
+        swap(&vReal[i * stride], &vReal[j * stride]);
+        if (complexInput)
+          swap(&vImag[i * stride], &vImag[j * stride]);
+      }
+      uint_fast16_t k = (samples >> 1);
+
+      while (k <= j) {
+        j -= k;
+        k >>= 1;
+      }
+      j += k;
+    }
+  }
+  // Use the precomputed twiddle factors when a large enough plan is set
+  const FFTPlan<T> *plan = this->_plan;
+  if (plan && plan->samples() < samples) {
+    plan = nullptr;
+  }
+  // Compute the FFT
+  if (this->_kernel == FFTKernel::Radix4) {
+    radix4(vReal, vImag, samples, power, dir, plan, stride);
+  } else {
+    radix2(vReal, vImag, samples, power, dir, plan, stride);
+  }
+  // Scaling for reverse transform
+  if (dir == FFTDirection::Reverse) {
+    for (uint_fast16_t i = 0; i < (samples * stride); i += stride) {
+#ifdef FFT_SPEED_OVER_PRECISION
+      vReal[i] *= oneOverSamples;
+      vImag[i] *= oneOverSamples;
+#else
+      vReal[i] /= samples;
+      vImag[i] /= samples;
+#endif
+    }
+  }
+}
+
+
 #ifdef FFT_SQRT_APPROXIMATION
 // Fast inverse square root aka "Quake 3 fast inverse square root", multiplied
 // by x. Uses one iteration of Halley's method for precision. See:
@@ -523,5 +1177,7 @@ const T ArduinoFFT<T>::_WindowCompensationFactors[11] = {
     1.0 // Custom, precompiled value.
 };
 
+template class FFTPlan<double>;
+template class FFTPlan<float>;
 template class ArduinoFFT<double>;
 template class ArduinoFFT<float>;
@@ -34,7 +34,6 @@
 
 #ifdef __AVR__
 #include <avr/io.h>
-#include <avr/pgmspace.h>
 #endif
 #include "defs.h"
 #include "types.h"
@@ -55,6 +54,42 @@
 
 #define FFT_LIB_REV 0x20
 
+// Precomputed twiddle factors for a given transform size. A plan holds
+// cos(2 * pi * k / samples) for k in [0, samples / 2), either computed at run
+// time or supplied by the caller in FFT_PROGMEM storage. The sines are read
+// from the same table through the quarter-wave symmetry. A plan can serve any
+// transform whose size is a power of 2 not larger than its own. Targets whose
+// tables live in flash only (FFT_RAM_PLANS is 0, as on AVR) can't compute a
+// plan at run time and leave it empty.
+template <typename T> class FFTPlan {
+public:
+  FFTPlan(uint_fast16_t samples);
+  FFTPlan(const T *cosTable, uint_fast16_t samples);
+
+  ~FFTPlan();
+
+  T cosine(uint_fast16_t index) const;
+  uint_fast16_t samples(void) const;
+  T sine(uint_fast16_t index) const;
+
+private:
+  /* Variables */
+  const T *_cosTable = nullptr;
+  bool _ownsTable = false;
+  uint_fast16_t _samples = 0;
+  /* Functions */
+  T read(uint_fast16_t index) const;
+};
+
+// Spectral features of a frame, see ArduinoFFT::spectralFeatures()
+template <typename T> struct FFTFeatures {
+  T centroid; // Magnitude weighted mean frequency, in Hz
+  T flatness; // Geometric over arithmetic mean of the power, 0 to 1
+  T kurtosis; // Of the magnitudes over frequency, 3 for a Gaussian shape
+  T rms;      // Of the transformed frame, through Parseval's theorem
+  T spread;   // Standard deviation around the centroid, in Hz
+};
+
 template <typename T> class ArduinoFFT {
 public:
   ArduinoFFT();
@@ -65,12 +100,23 @@ public:
 
   void complexToMagnitude(void) const;
   void complexToMagnitude(T *vReal, T *vImag, uint_fast16_t samples) const;
+  void complexToMagnitude(T *vReal, T *vImag, uint_fast16_t samples,
+                          uint_fast8_t channels, FFTLayout layout) const;
 
   void compute(FFTDirection dir) const;
   void compute(T *vReal, T *vImag, uint_fast16_t samples,
                FFTDirection dir) const;
   void compute(T *vReal, T *vImag, uint_fast16_t samples, uint_fast8_t power,
                FFTDirection dir) const;
+  void compute(T *vReal, T *vImag, uint_fast16_t samples,
+               uint_fast8_t channels, FFTLayout layout,
+               FFTDirection dir) const;
+
+  void computeReal(FFTDirection dir) const;
+  void computeReal(T *vReal, T *vImag, uint_fast16_t samples,
+                   FFTDirection dir) const;
+  void computeReal(T *vReal, T *vImag, uint_fast16_t samples,
+                   uint_fast8_t power, FFTDirection dir) const;
 
   void dcRemoval(void) const;
   void dcRemoval(T *vData, uint_fast16_t samples) const;
@@ -80,6 +126,9 @@ public:
   T majorPeak(T *vData, uint_fast16_t samples, T samplingFrequency) const;
   void majorPeak(T *vData, uint_fast16_t samples, T samplingFrequency,
                  T *frequency, T *magnitude) const;
+  void majorPeak(T *vData, uint_fast16_t samples, uint_fast8_t channels,
+                 FFTLayout layout, T samplingFrequency, T *frequencies,
+                 T *magnitudes) const;
 
   T majorPeakParabola(void) const;
   void majorPeakParabola(T *frequency, T *magnitude) const;
@@ -88,25 +137,58 @@ public:
   void majorPeakParabola(T *vData, uint_fast16_t samples, T samplingFrequency,
                          T *frequency, T *magnitude) const;
 
+  uint_fast8_t majorPeaks(T *frequencies, T *magnitudes, uint_fast8_t count,
+                          uint_fast16_t minSeparation = 1,
+                          FFTInterpolation interpolation =
+                              FFTInterpolation::Parabola) const;
+  uint_fast8_t majorPeaks(T *vData, uint_fast16_t samples, T samplingFrequency,
+                          T *frequencies, T *magnitudes, uint_fast8_t count,
+                          uint_fast16_t minSeparation = 1,
+                          FFTInterpolation interpolation =
+                              FFTInterpolation::Parabola) const;
+
   uint8_t revision(void);
 
   void setArrays(T *vReal, T *vImag, uint_fast16_t samples = 0);
 
+  void setKernel(FFTKernel kernel);
+
+  void setPlan(const FFTPlan<T> *plan);
+
+  void spectralFeatures(FFTFeatures<T> *features,
+                        const T *bandEdges = nullptr, uint_fast8_t bands = 0,
+                        T *bandEnergies = nullptr) const;
+  void spectralFeatures(T *vData, uint_fast16_t samples, T samplingFrequency,
+                        FFTFeatures<T> *features, const T *bandEdges = nullptr,
+                        uint_fast8_t bands = 0,
+                        T *bandEnergies = nullptr) const;
+
   void windowing(FFTWindow windowType, FFTDirection dir,
                  bool withCompensation = false);
   void windowing(T *vData, uint_fast16_t samples, FFTWindow windowType,
                  FFTDirection dir, T *windowingFactors = nullptr,
                  bool withCompensation = false);
 
+  static T windowCompensation(FFTWindow windowType);
+  static T windowingFactor(FFTWindow windowType, uint_fast16_t index,
+                           uint_fast16_t samples);
+
 private:
+  template <typename U, uint16_t N, FFTWindow W>
+  friend class ArduinoFFTStatic;
+
   /* Variables */
   static const T _WindowCompensationFactors[11];
 #ifdef FFT_SPEED_OVER_PRECISION
   T _oneOverSamples = 0.0;
 #endif
+  // Bit reversal permutation of a compile-time size, in FFT_PROGMEM
+  const uint16_t *_bitReversal = nullptr;
   bool _isPrecompiled = false;
+  FFTKernel _kernel = FFTKernel::Radix2;
   bool _precompiledWithCompensation = false;
   uint_fast8_t _power = 0;
+  const FFTPlan<T> *_plan = nullptr;
   T *_precompiledWindowingFactors = nullptr;
   uint_fast16_t _samples;
   T _samplingFrequency;
@@ -116,9 +198,27 @@ private:
   /* Functions */
   uint_fast8_t exponent(uint_fast16_t value) const;
   void findMaxY(T *vData, uint_fast16_t length, T *maxY,
-                uint_fast16_t *index) const;
+                uint_fast16_t *index, uint_fast16_t stride = 1) const;
+  void findPeak(T *vData, uint_fast16_t stride, uint_fast16_t samples,
+                T samplingFrequency, T *frequency, T *magnitude) const;
+  void nextRotation(uint_fast8_t l, FFTDirection dir, T *c1, T *c2) const;
+  void interpolate(T y1, T y2, T y3, FFTInterpolation interpolation, T *delta,
+                   T *magnitude) const;
   void parabola(T x1, T y1, T x2, T y2, T x3, T y3, T *a, T *b, T *c) const;
+  void pushPeak(T *heapIndexes, T *heapValues, uint_fast8_t *size,
+                uint_fast8_t count, uint_fast16_t index, T value) const;
+  void siftDown(T *heapIndexes, T *heapValues, uint_fast8_t size,
+                uint_fast8_t position) const;
+  void radix2(T *vReal, T *vImag, uint_fast16_t samples, uint_fast8_t power,
+              FFTDirection dir, const FFTPlan<T> *plan,
+              uint_fast16_t stride = 1) const;
+  void radix4(T *vReal, T *vImag, uint_fast16_t samples, uint_fast8_t power,
+              FFTDirection dir, const FFTPlan<T> *plan,
+              uint_fast16_t stride = 1) const;
   void swap(T *a, T *b) const;
+  void transform(T *vReal, T *vImag, uint_fast16_t samples, uint_fast8_t power,
+                 FFTDirection dir, bool complexInput,
+                 uint_fast16_t stride = 1) const;
 
 #ifdef FFT_SQRT_APPROXIMATION
   float sqrt_internal(float x) const;
@@ -126,17 +226,16 @@ private:
 #endif
 };
 
-#if defined(__AVR__) && defined(USE_AVR_PROGMEM)
-static const float _c1[] PROGMEM = {
-    0.0000000000, 0.7071067812, 0.9238795325, 0.9807852804, 0.9951847267,
-    0.9987954562, 0.9996988187, 0.9999247018, 0.9999811753, 0.9999952938,
-    0.9999988235, 0.9999997059, 0.9999999265, 0.9999999816, 0.9999999954,
-    0.9999999989, 0.9999999997};
-static const float _c2[] PROGMEM = {
-    1.0000000000, 0.7071067812, 0.3826834324, 0.1950903220, 0.0980171403,
-    0.0490676743, 0.0245412285, 0.0122715383, 0.0061358846, 0.0030679568,
-    0.0015339802, 0.0007669903, 0.0003834952, 0.0001917476, 0.0000958738,
-    0.0000479369, 0.0000239684};
-#endif
+#include "arduinoFFTBackend.h"
+#include "arduinoFFTConvolver.h"
+#include "arduinoFFTFixed.h"
+#include "arduinoFFTGoertzel.h"
+#include "arduinoFFTHarmonics.h"
+#include "arduinoFFTStatic.h"
+#include "arduinoFFTStream.h"
+#include "arduinoFFTWelch.h"
+
+// The transform suited to the target: Q15 fixed point on AVR, float elsewhere
+typedef ArduinoFFT<FFTSample> ArduinoFFTDefault;
 
 #endif
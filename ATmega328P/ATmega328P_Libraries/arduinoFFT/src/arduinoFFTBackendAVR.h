@@ -0,0 +1,92 @@
+/*
+
+        FFT library, AVR backend
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoFFTBackendAVR_h /* Prevent loading library twice */
+#define ArduinoFFTBackendAVR_h
+
+// Tables in flash, which the 2 KB of RAM of an ATmega328P can't spare. Define
+// USE_AVR_PROGMEM to also read the twiddle rotations from a table instead of
+// computing two square roots per stage. The default transform is the fixed
+// point ArduinoFFT<int16_t>, which needs no FPU emulation at all.
+
+#include <avr/pgmspace.h>
+
+typedef int16_t FFTSample;
+
+#define FFT_PROGMEM PROGMEM
+#define FFT_RAM_PLANS 0
+
+template <typename T> static inline T fftReadTable(const T *p) {
+  T value;
+  memcpy_P(&value, p, sizeof(T));
+  return value;
+}
+
+static inline uint16_t fftReadTable(const uint16_t *p) {
+  return pgm_read_word_near(p);
+}
+
+static inline int32_t fftReadTable(const int32_t *p) {
+  return (int32_t)pgm_read_dword_near(p);
+}
+
+#ifdef USE_AVR_PROGMEM
+static const float _c1[] PROGMEM = {
+    0.0000000000, 0.7071067812, 0.9238795325, 0.9807852804, 0.9951847267,
+    0.9987954562, 0.9996988187, 0.9999247018, 0.9999811753, 0.9999952938,
+    0.9999988235, 0.9999997059, 0.9999999265, 0.9999999816, 0.9999999954,
+    0.9999999989, 0.9999999997};
+static const float _c2[] PROGMEM = {
+    1.0000000000, 0.7071067812, 0.3826834324, 0.1950903220, 0.0980171403,
+    0.0490676743, 0.0245412285, 0.0122715383, 0.0061358846, 0.0030679568,
+    0.0015339802, 0.0007669903, 0.0003834952, 0.0001917476, 0.0000958738,
+    0.0000479369, 0.0000239684};
+
+template <typename T>
+static inline bool fftRotationTable(uint_fast8_t l, T *c1, T *c2) {
+  *c2 = pgm_read_float_near(&(_c2[l]));
+  *c1 = pgm_read_float_near(&(_c1[l]));
+  return true;
+}
+#else
+template <typename T>
+static inline bool fftRotationTable(uint_fast8_t, T *, T *) {
+  return false;
+}
+#endif
+
+// No vector unit
+template <typename T>
+static inline bool kernelStage(T *, T *, uint_fast16_t, uint_fast8_t,
+                               FFTDirection, const FFTPlan<T> *, T, T) {
+  return false;
+}
+
+template <typename T>
+static inline uint_fast16_t kernelMagnitude(T *, T *, uint_fast16_t) {
+  return 0;
+}
+
+template <typename T>
+static inline uint_fast16_t kernelWindowing(T *, uint_fast16_t, const T *,
+                                            FFTDirection) {
+  return 0;
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*
+
+        FFT library, RAM backend
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoFFTBackendRAM_h /* Prevent loading library twice */
+#define ArduinoFFTBackendRAM_h
+
+// Tables in RAM, for ESP32 and host builds. The twiddle rotations are
+// computed, which is cheap with an FPU. Host builds get the vector kernels of
+// arduinoFFTSimd.h for float.
+
+typedef float FFTSample;
+
+#define FFT_PROGMEM
+#define FFT_RAM_PLANS 1
+
+template <typename T> static inline T fftReadTable(const T *p) { return *p; }
+
+template <typename T>
+static inline bool fftRotationTable(uint_fast8_t, T *, T *) {
+  return false;
+}
+
+// Scalar loops for the types and targets without vector kernels
+template <typename T>
+static inline bool kernelStage(T *, T *, uint_fast16_t, uint_fast8_t,
+                               FFTDirection, const FFTPlan<T> *, T, T) {
+  return false;
+}
+
+template <typename T>
+static inline uint_fast16_t kernelMagnitude(T *, T *, uint_fast16_t) {
+  return 0;
+}
+
+template <typename T>
+static inline uint_fast16_t kernelWindowing(T *, uint_fast16_t, const T *,
+                                            FFTDirection) {
+  return 0;
+}
+
+#include "arduinoFFTSimd.h"
+
+#endif
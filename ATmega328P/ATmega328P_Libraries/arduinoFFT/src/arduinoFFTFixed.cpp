@@ -0,0 +1,373 @@
+/*
+
+        FFT library, fixed point specializations
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "arduinoFFT.h"
+
+// Q31 rotation of stage l: cos and sin of 2 * pi / 2^(l + 1)
+static const int32_t _fixedCos[] FFT_PROGMEM = {
+    -2147483647, 0,          1518500250, 1984016189, 2106220352, 2137142927,
+    2144896910,  2146836866, 2147321946, 2147443222, 2147473542, 2147481121,
+    2147483016,  2147483490, 2147483609, 2147483638};
+static const int32_t _fixedSin[] FFT_PROGMEM = {
+    0,        2147483647, 1518500250, 821806413, 418953276, 210490206,
+    105372028, 52701887,  26352928,   13176712,  6588387,   3294197,
+    1647099,   823550,    411775,     205887};
+
+template <typename T> ArduinoFFTFixed<T>::ArduinoFFTFixed() {}
+
+template <typename T>
+ArduinoFFTFixed<T>::ArduinoFFTFixed(T *vReal, T *vImag, uint_fast16_t samples,
+                                    float samplingFrequency,
+                                    bool windowingFactors)
+    : _samples(samples), _samplingFrequency(samplingFrequency), _vImag(vImag),
+      _vReal(vReal) {
+  if (windowingFactors) {
+    _precompiledWindowingFactors = new T[samples / 2];
+  }
+}
+
+template <typename T> ArduinoFFTFixed<T>::~ArduinoFFTFixed(void) {
+  // Destructor
+  if (_precompiledWindowingFactors) {
+    delete[] _precompiledWindowingFactors;
+  }
+}
+
+template <typename T> void ArduinoFFTFixed<T>::complexToMagnitude(void) const {
+  complexToMagnitude(this->_vReal, this->_vImag, this->_samples);
+}
+
+template <typename T>
+void ArduinoFFTFixed<T>::complexToMagnitude(T *vReal, T *vImag,
+                                            uint_fast16_t samples) const {
+  // vM is half the size of vReal and vImag
+  for (uint_fast16_t i = 0; i < (samples >> 1) + 1; i++) {
+    square_t re = (square_t)((wide_t)vReal[i] * vReal[i]);
+    square_t im = (square_t)((wide_t)vImag[i] * vImag[i]);
+    square_t magnitude = isqrt(re + im);
+    if (magnitude > (square_t)FFTFixedTraits<T>::max) {
+      magnitude = FFTFixedTraits<T>::max;
+    }
+    vReal[i] = (T)magnitude;
+  }
+}
+
+template <typename T>
+uint_fast8_t ArduinoFFTFixed<T>::compute(FFTDirection dir) const {
+  return compute(this->_vReal, this->_vImag, this->_samples,
+                 exponent(this->_samples), dir);
+}
+
+template <typename T>
+uint_fast8_t ArduinoFFTFixed<T>::compute(T *vReal, T *vImag,
+                                         uint_fast16_t samples,
+                                         FFTDirection dir) const {
+  return compute(vReal, vImag, samples, exponent(samples), dir);
+}
+
+// Computes in-place complex-to-complex FFT with block floating point scaling.
+// Returns the block exponent of the result.
+template <typename T>
+uint_fast8_t ArduinoFFTFixed<T>::compute(T *vReal, T *vImag,
+                                         uint_fast16_t samples,
+                                         uint_fast8_t power,
+                                         FFTDirection dir) const {
+  const uint_fast8_t bits = FFTFixedTraits<T>::bits;
+  const wide_t rounding = ((wide_t)1 << (bits - 1));
+  // Reverse bits
+  uint_fast16_t j = 0;
+  for (uint_fast16_t i = 0; i < (samples - 1); i++) {
+    if (i < j) {
+      swap(&vReal[i], &vReal[j]);
+      swap(&vImag[i], &vImag[j]);
+    }
+    uint_fast16_t k = (samples >> 1);
+
+    while (k <= j) {
+      j -= k;
+      k >>= 1;
+    }
+    j += k;
+  }
+  // Upper bound of the absolute values, as the OR of all of them
+  wide_t maxAbs = 0;
+  for (uint_fast16_t i = 0; i < samples; i++) {
+    maxAbs |= (vReal[i] < 0) ? ~(wide_t)vReal[i] : (wide_t)vReal[i];
+    maxAbs |= (vImag[i] < 0) ? ~(wide_t)vImag[i] : (wide_t)vImag[i];
+  }
+  // Compute the FFT
+  uint_fast8_t blockExponent = 0;
+  uint_fast16_t l2 = 1;
+  for (uint_fast8_t l = 0; (l < power); l++) {
+    uint_fast16_t l1 = l2;
+    l2 <<= 1;
+    uint_fast8_t shift = shiftFor(maxAbs);
+    blockExponent += shift;
+    maxAbs = 0;
+    int32_t c1 = fftReadTable(&_fixedCos[l]);
+    int32_t c2 = fftReadTable(&_fixedSin[l]);
+    if (dir == FFTDirection::Forward) {
+      c2 = -c2;
+    }
+    // Twiddle factor kept in Q30, so that the rounding drift of the
+    // recurrence can't overflow, and used in the precision of T
+    int32_t u1 = ((int32_t)1 << 30);
+    int32_t u2 = 0;
+    for (j = 0; j < l1; j++) {
+      wide_t w1 = (wide_t)(((int64_t)u1 << 1) >> (31 - bits));
+      wide_t w2 = (wide_t)(((int64_t)u2 << 1) >> (31 - bits));
+      for (uint_fast16_t i = j; i < samples; i += l2) {
+        uint_fast16_t i1 = i + l1;
+        wide_t xr = ((wide_t)vReal[i1] >> shift);
+        wide_t xi = ((wide_t)vImag[i1] >> shift);
+        wide_t t1 = ((w1 * xr) - (w2 * xi) + rounding) >> bits;
+        wide_t t2 = ((w1 * xi) + (w2 * xr) + rounding) >> bits;
+        wide_t ar = ((wide_t)vReal[i] >> shift);
+        wide_t ai = ((wide_t)vImag[i] >> shift);
+        wide_t v[4] = {ar - t1, ai - t2, ar + t1, ai + t2};
+        vReal[i1] = (T)v[0];
+        vImag[i1] = (T)v[1];
+        vReal[i] = (T)v[2];
+        vImag[i] = (T)v[3];
+        for (uint_fast8_t n = 0; n < 4; n++) {
+          maxAbs |= (v[n] < 0) ? ~v[n] : v[n];
+        }
+      }
+      int32_t z = (int32_t)((((int64_t)u1 * c1) - ((int64_t)u2 * c2)) >> 31);
+      u2 = (int32_t)((((int64_t)u1 * c2) + ((int64_t)u2 * c1)) >> 31);
+      u1 = z;
+    }
+  }
+  // Scaling for reverse transform, as far as the exponent allows
+  if (dir == FFTDirection::Reverse) {
+    if (blockExponent >= power) {
+      return blockExponent - power;
+    }
+    uint_fast8_t shift = power - blockExponent;
+    for (uint_fast16_t i = 0; i < samples; i++) {
+      vReal[i] = (T)((wide_t)vReal[i] >> shift);
+      vImag[i] = (T)((wide_t)vImag[i] >> shift);
+    }
+    return 0;
+  }
+  return blockExponent;
+}
+
+template <typename T> void ArduinoFFTFixed<T>::dcRemoval(void) const {
+  dcRemoval(this->_vReal, this->_samples);
+}
+
+template <typename T>
+void ArduinoFFTFixed<T>::dcRemoval(T *vData, uint_fast16_t samples) const {
+  // calculate the mean of vData
+  wide_t mean = 0;
+  for (uint_fast16_t i = 0; i < samples; i++) {
+    mean += vData[i];
+  }
+  mean /= (wide_t)samples;
+  // Subtract the mean from vData
+  for (uint_fast16_t i = 0; i < samples; i++) {
+    vData[i] -= (T)mean;
+  }
+}
+
+template <typename T> float ArduinoFFTFixed<T>::majorPeak(void) const {
+  return majorPeak(this->_vReal, this->_samples, this->_samplingFrequency);
+}
+
+template <typename T>
+void ArduinoFFTFixed<T>::majorPeak(float *f, float *v) const {
+  majorPeak(this->_vReal, this->_samples, this->_samplingFrequency, f, v);
+}
+
+template <typename T>
+float ArduinoFFTFixed<T>::majorPeak(T *vData, uint_fast16_t samples,
+                                    float samplingFrequency) const {
+  float frequency;
+  majorPeak(vData, samples, samplingFrequency, &frequency, nullptr);
+  return frequency;
+}
+
+template <typename T>
+void ArduinoFFTFixed<T>::majorPeak(T *vData, uint_fast16_t samples,
+                                   float samplingFrequency, float *frequency,
+                                   float *magnitude) const {
+  // Same search and interpolation as ArduinoFFT<float>::majorPeak()
+  uint_fast16_t IndexOfMaxY = 1;
+  for (uint_fast16_t i = 1; i < (samples >> 1) + 1; i++) {
+    if ((vData[i - 1] < vData[i]) && (vData[i] > vData[i + 1])) {
+      if (vData[i] > vData[IndexOfMaxY]) {
+        IndexOfMaxY = i;
+      }
+    }
+  }
+  float y1 = vData[IndexOfMaxY - 1];
+  float y2 = vData[IndexOfMaxY];
+  float y3 = vData[IndexOfMaxY + 1];
+  float delta = 0.5 * ((y1 - y3) / (y1 - (2.0 * y2) + y3));
+  if (IndexOfMaxY == (samples >> 1)) { // To improve calculation on edge values
+    *frequency = ((IndexOfMaxY + delta) * samplingFrequency) / (samples);
+  } else {
+    *frequency = ((IndexOfMaxY + delta) * samplingFrequency) / (samples - 1);
+  }
+  if (magnitude != nullptr) {
+    *magnitude = fabs(y1 - (2.0 * y2) + y3);
+  }
+}
+
+template <typename T> uint8_t ArduinoFFTFixed<T>::revision(void) {
+  return (FFT_LIB_REV);
+}
+
+// Replace the data array pointers
+template <typename T>
+void ArduinoFFTFixed<T>::setArrays(T *vReal, T *vImag, uint_fast16_t samples) {
+  _vReal = vReal;
+  _vImag = vImag;
+  if (samples) {
+    _samples = samples;
+    if (_precompiledWindowingFactors) {
+      delete[] _precompiledWindowingFactors;
+    }
+    _precompiledWindowingFactors = new T[samples / 2];
+    _isPrecompiled = false;
+  }
+}
+
+template <typename T>
+void ArduinoFFTFixed<T>::windowing(FFTWindow windowType, FFTDirection dir) {
+  if (this->_precompiledWindowingFactors && this->_isPrecompiled &&
+      this->_windowFunction == windowType) {
+    windowing(this->_vReal, this->_samples, FFTWindow::Precompiled, dir,
+              this->_precompiledWindowingFactors);
+  } else if (this->_precompiledWindowingFactors) {
+    windowing(this->_vReal, this->_samples, windowType, dir,
+              this->_precompiledWindowingFactors);
+    this->_isPrecompiled = true;
+    this->_windowFunction = windowType;
+  } else {
+    windowing(this->_vReal, this->_samples, windowType, dir, nullptr);
+  }
+}
+
+template <typename T>
+void ArduinoFFTFixed<T>::windowing(T *vData, uint_fast16_t samples,
+                                   FFTWindow windowType, FFTDirection dir,
+                                   T *windowingFactors) {
+  const uint_fast8_t bits = FFTFixedTraits<T>::bits;
+  const wide_t rounding = ((wide_t)1 << (bits - 1));
+  const wide_t max = FFTFixedTraits<T>::max;
+  bool precompiled =
+      (windowingFactors != nullptr && windowType == FFTWindow::Precompiled);
+  for (uint_fast16_t i = 0; i < (samples >> 1); i++) {
+    wide_t weighingFactor;
+    if (precompiled) {
+      weighingFactor = windowingFactors[i];
+    } else {
+      // The window functions are shared with the floating point version
+      weighingFactor =
+          toFixed(ArduinoFFT<float>::windowingFactor(windowType, i, samples));
+      if (windowingFactors) {
+        windowingFactors[i] = (T)weighingFactor;
+      }
+    }
+    T *pair[2] = {&vData[i], &vData[samples - (i + 1)]};
+    for (uint_fast8_t n = 0; n < 2; n++) {
+      wide_t value = *pair[n];
+      if (dir == FFTDirection::Forward) {
+        value = (value * weighingFactor + rounding) >> bits;
+      } else if (weighingFactor != 0) {
+        value = (value * ((wide_t)1 << bits)) / weighingFactor;
+        if (value > max) {
+          value = max;
+        } else if (value < -max) {
+          value = -max;
+        }
+      }
+      *pair[n] = (T)value;
+    }
+  }
+}
+
+// Converts a value in [-1, 1] to Q15 or Q31, with saturation
+template <typename T> T ArduinoFFTFixed<T>::toFixed(float value) {
+  const float max = FFTFixedTraits<T>::max;
+  float scaled = value * max;
+  if (scaled >= max) {
+    return FFTFixedTraits<T>::max;
+  }
+  if (scaled <= -max) {
+    return -FFTFixedTraits<T>::max;
+  }
+  return (T)(scaled + (scaled < 0 ? -0.5 : 0.5));
+}
+
+// Private functions
+
+template <typename T>
+uint_fast8_t ArduinoFFTFixed<T>::exponent(uint_fast16_t value) const {
+  // Calculates the base 2 logarithm of a value
+  uint_fast8_t result = 0;
+  while (value >>= 1)
+    result++;
+  return result;
+}
+
+// Bitwise integer square root
+template <typename T>
+typename ArduinoFFTFixed<T>::square_t
+ArduinoFFTFixed<T>::isqrt(square_t value) const {
+  square_t result = 0;
+  square_t bit = (square_t)1 << ((sizeof(square_t) * 8) - 2);
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit) {
+    if (value >= result + bit) {
+      value -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return result;
+}
+
+// Right shift that brings the largest value under a quarter of full scale.
+// A butterfly then grows it by at most 1 + sqrt(2), which can't overflow.
+template <typename T>
+uint_fast8_t ArduinoFFTFixed<T>::shiftFor(wide_t maxAbs) const {
+  const wide_t limit = ((wide_t)1 << (FFTFixedTraits<T>::bits - 2));
+  uint_fast8_t shift = 0;
+  while (maxAbs >= limit) {
+    maxAbs >>= 1;
+    shift++;
+  }
+  return shift;
+}
+
+template <typename T> void ArduinoFFTFixed<T>::swap(T *a, T *b) const {
+  T temp = *a;
+  *a = *b;
+  *b = temp;
+}
+
+template class ArduinoFFTFixed<int16_t>;
+template class ArduinoFFTFixed<int32_t>;
@@ -0,0 +1,129 @@
+/*
+
+        FFT library, fixed point specializations
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoFFTFixed_h /* Prevent loading library twice */
+#define ArduinoFFTFixed_h
+
+// Fixed point transforms for targets without an FPU. ArduinoFFT<int16_t>
+// works on Q15 values and ArduinoFFT<int32_t> on Q31 values.
+//
+// compute() uses block floating point: before each stage, the whole block is
+// shifted right just enough to rule out an overflow in the butterflies. The
+// total shift is returned as the block exponent, so the transform equals the
+// output multiplied by 2^exponent. The reverse transform folds its 1/samples
+// scaling into that exponent.
+//
+// Twiddle factors come from a Q31 rotation per stage (stored in flash on AVR
+// and ESP8266) and windows are applied from Q15/Q31 factor tables. Window
+// factors can't exceed 1 in these formats, so there is no amplitude
+// compensation.
+
+template <typename T> struct FFTFixedTraits;
+
+template <> struct FFTFixedTraits<int16_t> {
+  typedef int32_t wide_t;    // Holds the product of two values
+  typedef uint32_t square_t; // Holds the sum of two squared values
+  static const uint_fast8_t bits = 15;
+  static const int16_t max = 0x7FFF;
+};
+
+template <> struct FFTFixedTraits<int32_t> {
+  typedef int64_t wide_t;
+  typedef uint64_t square_t;
+  static const uint_fast8_t bits = 31;
+  static const int32_t max = 0x7FFFFFFF;
+};
+
+template <typename T> class ArduinoFFTFixed {
+public:
+  typedef typename FFTFixedTraits<T>::wide_t wide_t;
+  typedef typename FFTFixedTraits<T>::square_t square_t;
+
+  ArduinoFFTFixed();
+  ArduinoFFTFixed(T *vReal, T *vImag, uint_fast16_t samples,
+                  float samplingFrequency, bool windowingFactors = false);
+
+  ~ArduinoFFTFixed();
+
+  void complexToMagnitude(void) const;
+  void complexToMagnitude(T *vReal, T *vImag, uint_fast16_t samples) const;
+
+  uint_fast8_t compute(FFTDirection dir) const;
+  uint_fast8_t compute(T *vReal, T *vImag, uint_fast16_t samples,
+                       FFTDirection dir) const;
+  uint_fast8_t compute(T *vReal, T *vImag, uint_fast16_t samples,
+                       uint_fast8_t power, FFTDirection dir) const;
+
+  void dcRemoval(void) const;
+  void dcRemoval(T *vData, uint_fast16_t samples) const;
+
+  float majorPeak(void) const;
+  void majorPeak(float *f, float *v) const;
+  float majorPeak(T *vData, uint_fast16_t samples,
+                  float samplingFrequency) const;
+  void majorPeak(T *vData, uint_fast16_t samples, float samplingFrequency,
+                 float *frequency, float *magnitude) const;
+
+  uint8_t revision(void);
+
+  void setArrays(T *vReal, T *vImag, uint_fast16_t samples = 0);
+
+  void windowing(FFTWindow windowType, FFTDirection dir);
+  void windowing(T *vData, uint_fast16_t samples, FFTWindow windowType,
+                 FFTDirection dir, T *windowingFactors = nullptr);
+
+  static T toFixed(float value);
+
+private:
+  /* Variables */
+  bool _isPrecompiled = false;
+  T *_precompiledWindowingFactors = nullptr;
+  uint_fast16_t _samples = 0;
+  float _samplingFrequency = 0;
+  T *_vImag = nullptr;
+  T *_vReal = nullptr;
+  FFTWindow _windowFunction;
+  /* Functions */
+  uint_fast8_t exponent(uint_fast16_t value) const;
+  square_t isqrt(square_t value) const;
+  uint_fast8_t shiftFor(wide_t maxAbs) const;
+  void swap(T *a, T *b) const;
+};
+
+template <>
+class ArduinoFFT<int16_t> : public ArduinoFFTFixed<int16_t> {
+public:
+  ArduinoFFT() {}
+  ArduinoFFT(int16_t *vReal, int16_t *vImag, uint_fast16_t samples,
+             float samplingFrequency, bool windowingFactors = false)
+      : ArduinoFFTFixed<int16_t>(vReal, vImag, samples, samplingFrequency,
+                                 windowingFactors) {}
+};
+
+template <>
+class ArduinoFFT<int32_t> : public ArduinoFFTFixed<int32_t> {
+public:
+  ArduinoFFT() {}
+  ArduinoFFT(int32_t *vReal, int32_t *vImag, uint_fast16_t samples,
+             float samplingFrequency, bool windowingFactors = false)
+      : ArduinoFFTFixed<int32_t>(vReal, vImag, samples, samplingFrequency,
+                                 windowingFactors) {}
+};
+
+#endif
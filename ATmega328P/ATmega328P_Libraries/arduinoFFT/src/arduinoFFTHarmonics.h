@@ -0,0 +1,68 @@
+/*
+
+        FFT library, harmonic series tracker
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoFFTHarmonics_h /* Prevent loading library twice */
+#define ArduinoFFTHarmonics_h
+
+// Tracks a fundamental frequency and its first harmonics across frames, from
+// the peaks returned by ArduinoFFT::majorPeaks().
+//
+// On each update, every peak divided by 1 to `harmonics` gives a candidate
+// fundamental within [minFrequency, maxFrequency], as does the previous
+// estimate. Each candidate scores the magnitudes of the peaks found within
+// `tolerance` (relative) of its multiples, and the best one is refined by a
+// weighted least squares fit over the matched peaks. While locked, estimates
+// are smoothed: new = old + smoothing * (measured - old). Harmonics missing
+// from a frame fade out instead of dropping to zero.
+template <typename T> class ArduinoFFTHarmonics {
+public:
+  ArduinoFFTHarmonics(uint_fast8_t harmonics, T minFrequency, T maxFrequency,
+                      T tolerance = 0.03, T smoothing = 0.5);
+
+  ~ArduinoFFTHarmonics();
+
+  T frequency(uint_fast8_t harmonic) const;
+
+  T fundamental(void) const;
+
+  bool locked(void) const;
+
+  T magnitude(uint_fast8_t harmonic) const;
+
+  void reset(void);
+
+  bool update(const T *frequencies, const T *magnitudes, uint_fast8_t count);
+
+private:
+  /* Variables */
+  T _fundamental = 0;
+  uint_fast8_t _harmonics;
+  bool _locked = false;
+  T *_magnitudes = nullptr;
+  T _maxFrequency;
+  T _minFrequency;
+  T _smoothing;
+  T _tolerance;
+  /* Functions */
+  T fit(T candidate, const T *frequencies, const T *magnitudes,
+        uint_fast8_t count, T *score) const;
+  int_fast16_t match(T target, const T *frequencies, uint_fast8_t count) const;
+};
+
+#endif
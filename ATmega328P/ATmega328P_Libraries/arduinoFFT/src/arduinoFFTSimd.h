@@ -0,0 +1,192 @@
+/*
+
+        FFT library, vector kernels for host builds
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoFFTSimd_h /* Prevent loading library twice */
+#define ArduinoFFTSimd_h
+
+// When the library is compiled off-target (ARDUINO not defined), the float
+// versions of the radix-2 butterflies, complexToMagnitude() and the
+// precompiled window multiply use AVX2, SSE2 or NEON (AArch64), whichever the
+// compiler targets. Other types and kernels keep the scalar loops of the
+// RAM backend. Define FFT_NO_SIMD to disable the vector kernels.
+
+#if !defined(ARDUINO) && !defined(FFT_NO_SIMD)
+#if defined(__AVX2__)
+#define FFT_SIMD_AVX2
+#elif defined(__SSE2__)
+#define FFT_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define FFT_SIMD_NEON
+#endif
+#endif
+
+#if defined(FFT_SIMD_AVX2)
+#include <immintrin.h>
+#define FFT_SIMD
+#define FFT_SIMD_WIDTH 8
+typedef __m256 simd_t;
+static inline simd_t simdLoad(const float *p) { return _mm256_loadu_ps(p); }
+static inline void simdStore(float *p, simd_t a) { _mm256_storeu_ps(p, a); }
+static inline simd_t simdSet(float a) { return _mm256_set1_ps(a); }
+static inline simd_t simdAdd(simd_t a, simd_t b) { return _mm256_add_ps(a, b); }
+static inline simd_t simdSub(simd_t a, simd_t b) { return _mm256_sub_ps(a, b); }
+static inline simd_t simdMul(simd_t a, simd_t b) { return _mm256_mul_ps(a, b); }
+static inline simd_t simdDiv(simd_t a, simd_t b) { return _mm256_div_ps(a, b); }
+static inline simd_t simdSqrt(simd_t a) { return _mm256_sqrt_ps(a); }
+static inline simd_t simdReverse(simd_t a) {
+  return _mm256_permutevar8x32_ps(a, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+#elif defined(FFT_SIMD_SSE2)
+#include <emmintrin.h>
+#define FFT_SIMD
+#define FFT_SIMD_WIDTH 4
+typedef __m128 simd_t;
+static inline simd_t simdLoad(const float *p) { return _mm_loadu_ps(p); }
+static inline void simdStore(float *p, simd_t a) { _mm_storeu_ps(p, a); }
+static inline simd_t simdSet(float a) { return _mm_set1_ps(a); }
+static inline simd_t simdAdd(simd_t a, simd_t b) { return _mm_add_ps(a, b); }
+static inline simd_t simdSub(simd_t a, simd_t b) { return _mm_sub_ps(a, b); }
+static inline simd_t simdMul(simd_t a, simd_t b) { return _mm_mul_ps(a, b); }
+static inline simd_t simdDiv(simd_t a, simd_t b) { return _mm_div_ps(a, b); }
+static inline simd_t simdSqrt(simd_t a) { return _mm_sqrt_ps(a); }
+static inline simd_t simdReverse(simd_t a) {
+  return _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 1, 2, 3));
+}
+#elif defined(FFT_SIMD_NEON)
+#include <arm_neon.h>
+#define FFT_SIMD
+#define FFT_SIMD_WIDTH 4
+typedef float32x4_t simd_t;
+static inline simd_t simdLoad(const float *p) { return vld1q_f32(p); }
+static inline void simdStore(float *p, simd_t a) { vst1q_f32(p, a); }
+static inline simd_t simdSet(float a) { return vdupq_n_f32(a); }
+static inline simd_t simdAdd(simd_t a, simd_t b) { return vaddq_f32(a, b); }
+static inline simd_t simdSub(simd_t a, simd_t b) { return vsubq_f32(a, b); }
+static inline simd_t simdMul(simd_t a, simd_t b) { return vmulq_f32(a, b); }
+static inline simd_t simdDiv(simd_t a, simd_t b) { return vdivq_f32(a, b); }
+static inline simd_t simdSqrt(simd_t a) { return vsqrtq_f32(a); }
+static inline simd_t simdReverse(simd_t a) {
+  simd_t pairs = vrev64q_f32(a);
+  return vextq_f32(pairs, pairs, 2);
+}
+#endif
+
+#ifdef FFT_SIMD
+// Radix-2 stage l over bit-reversed data, FFT_SIMD_WIDTH butterflies at a
+// time. Stages with fewer than FFT_SIMD_WIDTH butterflies per group are left
+// to the scalar loop. Without a plan, the twiddle factors of consecutive
+// butterflies are generated from the rotation (c1, c2) of the stage.
+static inline bool kernelStage(float *vReal, float *vImag,
+                               uint_fast16_t samples, uint_fast8_t l,
+                               FFTDirection dir, const FFTPlan<float> *plan,
+                               float c1, float c2) {
+  uint_fast16_t l1 = ((uint_fast16_t)1 << l);
+  if (l1 < FFT_SIMD_WIDTH) {
+    return false;
+  }
+  uint_fast16_t l2 = (l1 << 1);
+  float wr[FFT_SIMD_WIDTH];
+  float wi[FFT_SIMD_WIDTH];
+  float u1 = 1.0;
+  float u2 = 0.0;
+  for (uint_fast8_t k = 0; k < FFT_SIMD_WIDTH; k++) {
+    wr[k] = u1;
+    wi[k] = u2;
+    float z = ((u1 * c1) - (u2 * c2));
+    u2 = ((u1 * c2) + (u2 * c1));
+    u1 = z;
+  }
+  // (u1, u2) now rotates by FFT_SIMD_WIDTH butterflies
+  simd_t stepR = simdSet(u1);
+  simd_t stepI = simdSet(u2);
+  simd_t ur = simdLoad(wr);
+  simd_t ui = simdLoad(wi);
+  for (uint_fast16_t j = 0; j < l1; j += FFT_SIMD_WIDTH) {
+    if (plan) {
+      for (uint_fast8_t k = 0; k < FFT_SIMD_WIDTH; k++) {
+        uint_fast16_t index = (j + k) * (plan->samples() >> (l + 1));
+        wr[k] = plan->cosine(index);
+        wi[k] = (dir == FFTDirection::Forward) ? -plan->sine(index)
+                                               : plan->sine(index);
+      }
+      ur = simdLoad(wr);
+      ui = simdLoad(wi);
+    }
+    for (uint_fast16_t i = j; i < samples; i += l2) {
+      float *r0 = &vReal[i];
+      float *i0 = &vImag[i];
+      float *r1 = r0 + l1;
+      float *i1 = i0 + l1;
+      simd_t xr = simdLoad(r1);
+      simd_t xi = simdLoad(i1);
+      simd_t t1 = simdSub(simdMul(ur, xr), simdMul(ui, xi));
+      simd_t t2 = simdAdd(simdMul(ur, xi), simdMul(ui, xr));
+      simd_t yr = simdLoad(r0);
+      simd_t yi = simdLoad(i0);
+      simdStore(r1, simdSub(yr, t1));
+      simdStore(i1, simdSub(yi, t2));
+      simdStore(r0, simdAdd(yr, t1));
+      simdStore(i0, simdAdd(yi, t2));
+    }
+    if (!plan) {
+      simd_t z = simdSub(simdMul(ur, stepR), simdMul(ui, stepI));
+      ui = simdAdd(simdMul(ur, stepI), simdMul(ui, stepR));
+      ur = z;
+    }
+  }
+  return true;
+}
+
+// Magnitudes of the first values, returns how many were computed
+static inline uint_fast16_t kernelMagnitude(float *vReal, float *vImag,
+                                            uint_fast16_t count) {
+  uint_fast16_t i = 0;
+  for (; (i + FFT_SIMD_WIDTH) <= count; i += FFT_SIMD_WIDTH) {
+    simd_t re = simdLoad(&vReal[i]);
+    simd_t im = simdLoad(&vImag[i]);
+    simdStore(&vReal[i], simdSqrt(simdAdd(simdMul(re, re), simdMul(im, im))));
+  }
+  return i;
+}
+
+// Applies the first precompiled factors to both ends of vData, returns how
+// many factors were applied
+static inline uint_fast16_t kernelWindowing(float *vData,
+                                            uint_fast16_t samples,
+                                            const float *windowingFactors,
+                                            FFTDirection dir) {
+  uint_fast16_t i = 0;
+  for (; (i + FFT_SIMD_WIDTH) <= (samples >> 1); i += FFT_SIMD_WIDTH) {
+    simd_t factors = simdLoad(&windowingFactors[i]);
+    simd_t reversed = simdReverse(factors);
+    float *head = &vData[i];
+    float *tail = &vData[samples - (i + FFT_SIMD_WIDTH)];
+    if (dir == FFTDirection::Forward) {
+      simdStore(head, simdMul(simdLoad(head), factors));
+      simdStore(tail, simdMul(simdLoad(tail), reversed));
+    } else {
+      simdStore(head, simdDiv(simdLoad(head), factors));
+      simdStore(tail, simdDiv(simdLoad(tail), reversed));
+    }
+  }
+  return i;
+}
+#endif
+
+#endif
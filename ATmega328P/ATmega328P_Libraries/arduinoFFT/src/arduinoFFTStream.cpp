@@ -0,0 +1,181 @@
+/*
+
+        FFT library, streaming front end
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "arduinoFFT.h"
+
+template <typename T>
+ArduinoFFTStream<T>::ArduinoFFTStream(T *vReal, T *vImag,
+                                      uint_fast16_t samples, uint_fast16_t hop,
+                                      T samplingFrequency,
+                                      FFTWindow windowType)
+    : _fft(vReal, vImag, samples, samplingFrequency, true),
+      _hop((hop == 0 || hop > samples) ? samples : hop), _samples(samples),
+      _vImag(vImag), _vReal(vReal), _windowType(windowType) {
+  _ring = new T[samples];
+  _dampingN = pow(_damping, samples);
+  reset();
+}
+
+template <typename T> ArduinoFFTStream<T>::~ArduinoFFTStream(void) {
+  // Destructor
+  delete[] _ring;
+  freeBins();
+}
+
+// Magnitude of the n-th tracked bin, scaled like the output of compute()
+template <typename T> T ArduinoFFTStream<T>::binMagnitude(uint_fast8_t n) const {
+  if (n >= _bins) {
+    return 0;
+  }
+  return sqrt(sq(_binReal[n]) + sq(_binImag[n]));
+}
+
+// Phase of the n-th tracked bin in radians, relative to the oldest sample
+template <typename T> T ArduinoFFTStream<T>::binPhase(uint_fast8_t n) const {
+  if (n >= _bins) {
+    return 0;
+  }
+  return atan2(_binImag[n], _binReal[n]);
+}
+
+// The underlying transform, e.g. for complexToMagnitude() or majorPeak()
+template <typename T> ArduinoFFT<T> &ArduinoFFTStream<T>::fft(void) {
+  return _fft;
+}
+
+// Adds a sample. Returns true when a new spectrum is ready in vReal/vImag.
+template <typename T> bool ArduinoFFTStream<T>::push(T sample) {
+  T oldest = _ring[_position];
+  _ring[_position] = sample;
+  if (++_position == _samples) {
+    _position = 0;
+  }
+  // Sliding DFT: S = e^(2 * pi * i * k / N) * (S + x(n) - x(n - N))
+  for (uint_fast8_t n = 0; n < _bins; n++) {
+    T re = _binReal[n] + sample - (_dampingN * oldest);
+    T im = _binImag[n];
+    T c = _binRotation[n << 1];
+    T s = _binRotation[(n << 1) + 1];
+    _binReal[n] = _damping * ((re * c) - (im * s));
+    _binImag[n] = _damping * ((re * s) + (im * c));
+  }
+  if (_filled < _samples) {
+    _filled++;
+    if (_filled < _samples) {
+      return false;
+    }
+  } else if (++_sinceFrame < _hop) {
+    return false;
+  }
+  frame();
+  return true;
+}
+
+// Adds samples until a spectrum is ready or the data runs out. Returns the
+// number of samples consumed: call again with the rest after using the
+// spectrum.
+template <typename T>
+uint_fast16_t ArduinoFFTStream<T>::push(const T *data, uint_fast16_t count) {
+  for (uint_fast16_t i = 0; i < count; i++) {
+    if (push(data[i])) {
+      return i + 1;
+    }
+  }
+  return count;
+}
+
+// Clears the ring buffer and the tracked bins
+template <typename T> void ArduinoFFTStream<T>::reset(void) {
+  for (uint_fast16_t i = 0; i < _samples; i++) {
+    _ring[i] = 0;
+  }
+  for (uint_fast8_t n = 0; n < _bins; n++) {
+    _binReal[n] = 0;
+    _binImag[n] = 0;
+  }
+  _filled = 0;
+  _position = 0;
+  _sinceFrame = 0;
+}
+
+// Tracks the given bin indexes with a sliding DFT, replacing any previous
+// ones. The bins start from the current content of the ring buffer.
+template <typename T>
+bool ArduinoFFTStream<T>::trackBins(const uint_fast16_t *bins,
+                                    uint_fast8_t count) {
+  freeBins();
+  if (count == 0) {
+    return true;
+  }
+  _binReal = new T[count];
+  _binImag = new T[count];
+  _binRotation = new T[count << 1];
+  if (!_binReal || !_binImag || !_binRotation) {
+    freeBins();
+    return false;
+  }
+  for (uint_fast8_t n = 0; n < count; n++) {
+    T angle = (twoPi * bins[n]) / _samples;
+    _binRotation[n << 1] = cos(angle);
+    _binRotation[(n << 1) + 1] = sin(angle);
+    // Full DFT of the current window, oldest sample first
+    T re = 0;
+    T im = 0;
+    for (uint_fast16_t i = 0; i < _samples; i++) {
+      T value = _ring[(_position + i) % _samples];
+      re += value * cos(angle * i);
+      im -= value * sin(angle * i);
+    }
+    _binReal[n] = re;
+    _binImag[n] = im;
+  }
+  _bins = count;
+  return true;
+}
+
+// Private functions
+
+// Also frees the buffers of a trackBins() that failed halfway
+template <typename T> void ArduinoFFTStream<T>::freeBins(void) {
+  delete[] _binReal;
+  delete[] _binImag;
+  delete[] _binRotation;
+  _binReal = nullptr;
+  _binImag = nullptr;
+  _binRotation = nullptr;
+  _bins = 0;
+}
+
+template <typename T> void ArduinoFFTStream<T>::frame(void) {
+  _sinceFrame = 0;
+  // Unroll the ring buffer, oldest sample first
+  uint_fast16_t tail = _samples - _position;
+  for (uint_fast16_t i = 0; i < tail; i++) {
+    _vReal[i] = _ring[_position + i];
+  }
+  for (uint_fast16_t i = 0; i < _position; i++) {
+    _vReal[tail + i] = _ring[i];
+  }
+  // Uses the precompiled weighing factors after the first frame
+  _fft.windowing(_windowType, FFTDirection::Forward);
+  _fft.computeReal(FFTDirection::Forward);
+}
+
+template class ArduinoFFTStream<double>;
+template class ArduinoFFTStream<float>;
@@ -0,0 +1,80 @@
+/*
+
+        FFT library, streaming front end
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoFFTStream_h /* Prevent loading library twice */
+#define ArduinoFFTStream_h
+
+// Damping of the sliding DFT, keeps rounding errors from accumulating
+#ifndef FFT_SDFT_DAMPING
+#define FFT_SDFT_DAMPING 0.99999
+#endif
+
+// Short-time Fourier transform over a continuous stream of samples.
+// Samples are pushed one at a time (or in blocks) into a ring buffer of
+// `samples` values. Once the buffer is full, every `hop` samples the latest
+// `samples` values are windowed with precompiled factors and transformed with
+// computeReal(), leaving bins 0 to samples / 2 in vReal and vImag. A hop of
+// samples / 2 gives a 50% overlap, samples / 4 gives 75%.
+//
+// A few bins can also be tracked with a sliding DFT, which updates them on
+// every sample at O(1) cost each, with a rectangular window.
+template <typename T> class ArduinoFFTStream {
+public:
+  ArduinoFFTStream(T *vReal, T *vImag, uint_fast16_t samples,
+                   uint_fast16_t hop, T samplingFrequency,
+                   FFTWindow windowType = FFTWindow::Hamming);
+
+  ~ArduinoFFTStream();
+
+  T binMagnitude(uint_fast8_t n) const;
+  T binPhase(uint_fast8_t n) const;
+
+  ArduinoFFT<T> &fft(void);
+
+  bool push(T sample);
+  uint_fast16_t push(const T *data, uint_fast16_t count);
+
+  void reset(void);
+
+  bool trackBins(const uint_fast16_t *bins, uint_fast8_t count);
+
+private:
+  /* Variables */
+  T *_binImag = nullptr;
+  T *_binReal = nullptr;
+  T *_binRotation = nullptr;
+  uint_fast8_t _bins = 0;
+  T _damping = FFT_SDFT_DAMPING;
+  T _dampingN;
+  ArduinoFFT<T> _fft;
+  uint_fast16_t _filled = 0;
+  uint_fast16_t _hop;
+  uint_fast16_t _position = 0;
+  T *_ring;
+  uint_fast16_t _samples;
+  uint_fast16_t _sinceFrame = 0;
+  T *_vImag;
+  T *_vReal;
+  FFTWindow _windowType;
+  /* Functions */
+  void frame(void);
+  void freeBins(void);
+};
+
+#endif
@@ -0,0 +1,104 @@
+/*
+
+        FFT library, Welch power spectral density
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "arduinoFFT.h"
+
+template <typename T>
+ArduinoFFTWelch<T>::ArduinoFFTWelch(T *vReal, T *vImag, uint_fast16_t samples,
+                                    T samplingFrequency, FFTWindow windowType)
+    : _fft(vReal, vImag, samples, samplingFrequency, true), _samples(samples),
+      _samplingFrequency(samplingFrequency), _vImag(vImag), _vReal(vReal),
+      _windowType(windowType) {
+  _accumulator = new T[(samples >> 1) + 1];
+  // Sum of the squared window, both halves
+  for (uint_fast16_t i = 0; i < (samples >> 1); i++) {
+    _windowPower +=
+        2 * sq(ArduinoFFT<T>::windowingFactor(windowType, i, samples));
+  }
+  reset();
+}
+
+template <typename T> ArduinoFFTWelch<T>::~ArduinoFFTWelch(void) {
+  // Destructor
+  delete[] _accumulator;
+}
+
+// Adds the frame of real samples in vReal to the average
+template <typename T> void ArduinoFFTWelch<T>::add(void) {
+  if (!_accumulator) {
+    return;
+  }
+  _fft.windowing(_windowType, FFTDirection::Forward);
+  _fft.computeReal(FFTDirection::Forward);
+  for (uint_fast16_t i = 0; i <= (_samples >> 1); i++) {
+    _accumulator[i] += sq(_vReal[i]) + sq(_vImag[i]);
+  }
+  _frames++;
+}
+
+template <typename T> uint_fast32_t ArduinoFFTWelch<T>::frames(void) const {
+  return _frames;
+}
+
+// Writes the averaged power of bins 0 to samples / 2 in vData
+template <typename T>
+void ArduinoFFTWelch<T>::powerSpectrum(T *vData) const {
+  // A sinusoid of amplitude A gives |X| = A * samples / compensation, where
+  // the compensation includes the factor 2 of a one-sided spectrum
+  T compensation = ArduinoFFT<T>::windowCompensation(_windowType) / _samples;
+  average(vData, sq(compensation) / 2);
+}
+
+// Writes the averaged power spectral density of bins 0 to samples / 2 in
+// vData
+template <typename T> void ArduinoFFTWelch<T>::psd(T *vData) const {
+  average(vData, 2 / (_samplingFrequency * _windowPower));
+}
+
+template <typename T> void ArduinoFFTWelch<T>::reset(void) {
+  if (_accumulator) {
+    for (uint_fast16_t i = 0; i <= (_samples >> 1); i++) {
+      _accumulator[i] = 0;
+    }
+  }
+  _frames = 0;
+}
+
+// Private functions
+
+// Average times scale, with bins 0 and samples / 2 counted once
+template <typename T>
+void ArduinoFFTWelch<T>::average(T *vData, T scale) const {
+  uint_fast16_t half = (_samples >> 1);
+  if (!_accumulator || _frames == 0) {
+    for (uint_fast16_t i = 0; i <= half; i++) {
+      vData[i] = 0;
+    }
+    return;
+  }
+  scale /= _frames;
+  for (uint_fast16_t i = 0; i <= half; i++) {
+    vData[i] = _accumulator[i] * scale;
+  }
+  vData[0] /= 2;
+  vData[half] /= 2;
+}
+
+template class ArduinoFFTWelch<double>;
+template class ArduinoFFTWelch<float>;
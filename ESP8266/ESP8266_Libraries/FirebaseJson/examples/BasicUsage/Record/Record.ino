@@ -0,0 +1,57 @@
+/**
+ * Created by K. Suwatchai (Mobizt)
+ *
+ * Email: k_suwatchai@hotmail.com
+ *
+ * Github: https://github.com/mobizt/FirebaseJson
+ *
+ * Copyright (c) 2023 mobizt
+ *
+ */
+
+// Prints a telemetry record of the same shape every cycle with FirebaseJsonRecord,
+// which declares the paths once instead of calling FirebaseJson.set for each value.
+
+#include <Arduino.h>
+#include <FirebaseJson.h>
+
+FirebaseJsonRecord record;
+
+int idSlot, tempSlot, humSlot, okSlot, uptimeSlot;
+
+void setup()
+{
+    Serial.begin(115200);
+    Serial.println();
+    Serial.println();
+
+    // The paths are the same as in FirebaseJson.set
+    idSlot = record.add("device/id");
+    tempSlot = record.add("sensor/temp");
+    humSlot = record.add("sensor/hum");
+    okSlot = record.add("ok");
+    uptimeSlot = record.add("uptime");
+
+    record.setFloatDigits(2);
+
+    // The value stays until it is set again
+    record.set(idSlot, "node-1");
+}
+
+void loop()
+{
+    record.set(tempSlot, random(2000, 3000) / 100.0f);
+    record.set(humSlot, (int)random(30, 70));
+    record.set(okSlot, true);
+    record.set(uptimeSlot, millis());
+
+    // {"device":{"id":"node-1"},"sensor":{"temp":24.17,"hum":52},"ok":true,"uptime":5012}
+    record.toString(Serial);
+    Serial.println();
+
+    char buf[128];
+    if (record.toString(buf, sizeof(buf)) > 0)
+        Serial.println(buf);
+
+    delay(5000);
+}
@@ -0,0 +1,90 @@
+/**
+ * Created by K. Suwatchai (Mobizt)
+ *
+ * Email: k_suwatchai@hotmail.com
+ *
+ * Github: https://github.com/mobizt/FirebaseJson
+ *
+ * Copyright (c) 2023 mobizt
+ *
+ */
+
+// Times the number handling of a telemetry like document (an array of readings)
+// against the sprintf/strtod conversions the library used before.
+
+#include <Arduino.h>
+#include <FirebaseJson.h>
+
+#define READINGS 200
+
+float readings[READINGS];
+
+void setup()
+{
+    Serial.begin(115200);
+    Serial.println();
+    Serial.println();
+
+    for (int i = 0; i < READINGS; i++)
+        readings[i] = random(-2000000, 2000000) / 1000.0f;
+}
+
+void loop()
+{
+    FirebaseJsonArray arr;
+    FirebaseJsonData result;
+    String text;
+    char buf[32];
+    double sum = 0;
+
+    arr.setFloatDigits(3);
+
+    // Fixed decimals, as set with setFloatDigits
+    unsigned long ms = micros();
+    for (int i = 0; i < READINGS; i++)
+        arr.add(readings[i]);
+    unsigned long addTime = micros() - ms;
+
+    ms = micros();
+    for (int i = 0; i < READINGS; i++)
+        sprintf(buf, "%.3f", readings[i]);
+    unsigned long sprintfTime = micros() - ms;
+
+    arr.toString(text);
+
+    // Parsing prints the numbers back with the shortest round trip digits
+    ms = micros();
+    arr.setJsonArrayData(text);
+    unsigned long parseTime = micros() - ms;
+
+    ms = micros();
+    arr.toString(text);
+    unsigned long printTime = micros() - ms;
+
+    ms = micros();
+    for (int i = 0; i < READINGS; i++)
+    {
+        arr.get(result, i);
+        sum += result.to<double>();
+    }
+    unsigned long getTime = micros() - ms;
+
+    ms = micros();
+    const char *p = text.c_str();
+    for (int i = 0; i < READINGS; i++)
+    {
+        char *end;
+        p++; // '[' or ','
+        sum -= strtod(p, &end);
+        p = end;
+    }
+    unsigned long strtodTime = micros() - ms;
+
+    Serial.printf("%d readings, %d bytes (checksum %f)\n", READINGS, text.length(), sum);
+    Serial.printf("add  %8lu us   sprintf %8lu us\n", addTime, sprintfTime);
+    Serial.printf("get  %8lu us   strtod  %8lu us\n", getTime, strtodTime);
+    Serial.printf("parse %7lu us   print   %8lu us\n", parseTime, printTime);
+    Serial.println();
+
+    delay(5000);
+}
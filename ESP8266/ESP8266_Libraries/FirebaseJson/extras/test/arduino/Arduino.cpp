@@ -0,0 +1,18 @@
+#include "Arduino.h"
+
+#include <time.h>
+
+HardwareSerial Serial;
+
+unsigned long millis(void)
+{
+    return (unsigned long)(clock() / (CLOCKS_PER_SEC / 1000));
+}
+
+void delay(unsigned long)
+{
+}
+
+void yield(void)
+{
+}
@@ -0,0 +1,153 @@
+/*
+ * The parts of the Arduino core that FirebaseJson uses, enough to build and test it on a computer. Not a port: there
+ * is no I/O, Serial discards what it is given.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strcat_P strcat
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define memcpy_P memcpy
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+
+typedef const char *PGM_P;
+typedef uint8_t byte;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+unsigned long millis(void);
+void delay(unsigned long ms);
+void yield(void);
+#ifdef __cplusplus
+}
+
+#include <string>
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+
+class String
+{
+public:
+    String() {}
+    String(const char *cstr) : s(cstr ? cstr : "") {}
+    const char *c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.length(); }
+    bool reserve(unsigned int size)
+    {
+        s.reserve(size);
+        return true;
+    }
+    bool concat(const char *cstr, unsigned int length)
+    {
+        s.append(cstr, length);
+        return true;
+    }
+    bool concat(const char *cstr) { return concat(cstr, strlen(cstr)); }
+    bool concat(char c) { return concat(&c, 1); }
+    String &operator=(const char *cstr)
+    {
+        s = cstr ? cstr : "";
+        return *this;
+    }
+    String &operator+=(const String &rhs)
+    {
+        s += rhs.s;
+        return *this;
+    }
+    String &operator+=(const char *cstr)
+    {
+        concat(cstr);
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        concat(c);
+        return *this;
+    }
+    char operator[](unsigned int index) const { return s[index]; }
+    void remove(unsigned int index) { s.erase(index); }
+    void remove(unsigned int index, unsigned int count) { s.erase(index, count); }
+    void trim() {}
+
+private:
+    std::string s;
+};
+
+class StringSumHelper : public String
+{
+public:
+    StringSumHelper(const String &s) : String(s) {}
+    StringSumHelper(const char *cstr) : String(cstr) {}
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (n < size && write(buffer[n]))
+            n++;
+        return n;
+    }
+    size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+    size_t print(const char *str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(const String &s) { return write(s.c_str()); }
+    size_t println(const char *str = "") { return write(str) + write("\n"); }
+    int printf(const char *, ...) { return 0; }
+    virtual void flush() {}
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    size_t readBytes(char *buffer, size_t length)
+    {
+        size_t n = 0;
+        while (n < length && available())
+            buffer[n++] = (char)read();
+        return n;
+    }
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    void setTimeout(unsigned long) {}
+};
+
+class HardwareSerial : public Stream
+{
+public:
+    size_t write(uint8_t) { return 1; }
+    using Print::write;
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+#endif
+
+#endif
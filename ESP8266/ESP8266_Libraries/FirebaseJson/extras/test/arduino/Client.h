@@ -0,0 +1,16 @@
+/* The network client interface of the Arduino core, see Arduino.h */
+
+#ifndef Client_h
+#define Client_h
+
+#include "Arduino.h"
+
+class Client : public Stream
+{
+public:
+    virtual uint8_t connected() = 0;
+    virtual void stop() = 0;
+    using Print::write;
+};
+
+#endif
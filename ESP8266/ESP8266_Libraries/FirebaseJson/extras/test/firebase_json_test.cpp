@@ -0,0 +1,160 @@
+/*
+ * Host regression tests for the C++ classes of FirebaseJson, built against the
+ * Arduino core stand-in in the arduino folder.
+ *
+ * Build and run with "make run" in this folder. Each check prints its name on
+ * failure and the program exits with the number of failed checks.
+ */
+
+#include "FirebaseJson.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char *name)
+{
+    if (!ok)
+    {
+        printf("FAILED: %s\n", name);
+        failures++;
+    }
+}
+
+/* Reads the arena counters of a FirebaseJson */
+class ArenaJson : public FirebaseJson
+{
+public:
+    size_t used() const { return MB_JSON_ArenaUsed(arena); }
+    size_t live() const { return MB_JSON_ArenaLive(arena); }
+};
+
+/* Replacing values over and over compacts the arena instead of filling it */
+static void test_arena_compaction()
+{
+    const size_t size = 2048;
+    ArenaJson json;
+    String printed;
+    bool compacted = false;
+    bool fits = true;
+    char text[64];
+
+    check(json.setArenaSize(size), "arena of a FirebaseJson");
+    json.set("name", "arena");
+    for (int i = 0; i < 1000; i++)
+    {
+        size_t used = json.used();
+        snprintf(text, sizeof(text), "%.*s", i % 40, "a string that grows and shrinks again...");
+        json.set("counter", i);
+        json.set("text", text);
+        if (json.used() < used / 2)
+            compacted = true;
+        if (json.used() > size / 4 * 3 + 256)
+            fits = false;
+    }
+    check(compacted, "replacing values compacts the arena");
+    check(fits, "a compacted arena stays below its size");
+    check(json.live() <= json.used(), "arena counters are consistent");
+
+    json.toString(printed);
+    check(strcmp(printed.c_str(), "{\"name\":\"arena\",\"counter\":999,\"text\":\"a string that grows and shrinks again..\"}") == 0, "values survive the compaction");
+
+    json.clear();
+    check((json.used() == 0) && (json.live() == 0), "clear empties the arena");
+}
+
+/* Whether the contents are stored inside the object */
+static bool isInline(const MB_String &s)
+{
+    const char *p = s.c_str();
+    return p >= reinterpret_cast<const char *>(&s) && p < reinterpret_cast<const char *>(&s + 1);
+}
+
+/* Short contents stay inline, moves hand over heap buffers, clear() keeps them */
+static void test_mb_string()
+{
+    const char *shortText = "fifteen chars..";
+    const char *longText = "a text too long for the inline buffer";
+
+    MB_String s = shortText;
+    check(isInline(s) && strcmp(s.c_str(), shortText) == 0, "short string is inline");
+    s += "!";
+    check(!isInline(s) && strcmp(s.c_str(), "fifteen chars..!") == 0, "longer string moves to the heap");
+
+    MB_String heap = longText;
+    const char *p = heap.c_str();
+    MB_String moved(std::move(heap));
+    check(moved.c_str() == p && strcmp(moved.c_str(), longText) == 0, "move constructor takes the heap buffer");
+    check(heap.length() == 0, "moved from string is empty");
+
+    MB_String assigned;
+    assigned = std::move(moved);
+    check(assigned.c_str() == p && moved.length() == 0, "move assignment takes the heap buffer");
+
+    MB_String small = "key";
+    MB_String smallMoved(std::move(small));
+    check(isInline(smallMoved) && strcmp(smallMoved.c_str(), "key") == 0 && small.length() == 0, "inline contents are copied on move");
+
+    MB_String kept = "head";
+    MB_String sum = kept + "tail";
+    sum = MB_String("<") + '-';
+    check(strcmp(kept.c_str(), "head") == 0 && strcmp((kept + '.').c_str(), "head.") == 0 && strcmp(('.' + kept).c_str(), ".head") == 0,
+          "operator+ leaves its operands alone");
+    check(strcmp(sum.c_str(), "<-") == 0, "operator+ appends a char to a temporary");
+
+    size_t capacity = assigned.bufferLength();
+    assigned.clear();
+    check(assigned.length() == 0 && assigned.c_str()[0] == '\0', "clear empties the string");
+    check(assigned.bufferLength() == capacity && assigned.c_str() == p, "clear keeps the buffer");
+    assigned += "reused";
+    check(assigned.c_str() == p && strcmp(assigned.c_str(), "reused") == 0, "cleared buffer is reused");
+    assigned.shrink_to_fit();
+    check(isInline(assigned) && strcmp(assigned.c_str(), "reused") == 0, "shrink_to_fit returns the buffer");
+}
+
+/* The update holds the changed values at their paths and null for the removed ones */
+static void test_diff()
+{
+    const char *sent = "{\"sensor\":{\"temp\":23.5,\"hum\":40},\"name\":\"dev\",\"tags\":[1,2],\"gone\":true}";
+    FirebaseJson from;
+    FirebaseJson json;
+    FirebaseJson update;
+    String printed;
+
+    from.setJsonData(sent);
+    json.setJsonData(sent);
+    check(json.diff(from, update) == 0, "no changes, no update");
+    update.toString(printed);
+    check(strcmp(printed.c_str(), "{}") == 0, "an empty update");
+
+    // numbers set as raw text equal the same numbers parsed
+    json.set("sensor/hum", 40);
+    json.set("sensor/temp", 23.5);
+    check(json.diff(from, update) == 0, "set numbers equal parsed ones");
+
+    json.set("sensor/temp", 24.25);
+    json.set("tags/[1]", 3);
+    json.set("new/deep", "x");
+    json.remove("gone");
+    check(json.diff(from, update) == 4, "number of changed paths");
+    update.toString(printed);
+    check(strcmp(printed.c_str(), "{\"sensor/temp\":24.25,\"tags\":[1,3],\"new\":{\"deep\":\"x\"},\"gone\":null}") == 0,
+          "update of changed, added and removed values");
+
+    // a value whose type changed is sent whole
+    json.clear();
+    json.setJsonData(sent);
+    json.set("sensor", "off");
+    json.diff(from, update);
+    update.toString(printed);
+    check(strcmp(printed.c_str(), "{\"sensor\":\"off\"}") == 0, "a changed type replaces the value");
+}
+
+int main()
+{
+    test_mb_string();
+    test_arena_compaction();
+    test_diff();
+
+    if (failures == 0)
+        printf("all passed\n");
+    return failures;
+}
@@ -0,0 +1,767 @@
+/*
+ * Host regression tests for MB_JSON, the JSON core of FirebaseJson.
+ *
+ * Build and run with "make run" in this folder. The _asan build also catches
+ * bad frees and leaks. Each check prints its name on failure and the program
+ * exits with the number of failed checks.
+ */
+
+#include "MB_JSON.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int failures = 0;
+
+static void check(int ok, const char *name)
+{
+    if (!ok)
+    {
+        printf("FAILED: %s\n", name);
+        failures++;
+    }
+}
+
+/* Parse text through the stream parser in one feed */
+static MB_JSON *stream_parse(const char *text)
+{
+    MB_JSON_Stream *stream = MB_JSON_StreamCreate();
+    MB_JSON *json = NULL;
+    size_t consumed = 0;
+
+    if (stream == NULL)
+    {
+        return NULL;
+    }
+    if (MB_JSON_StreamFeed(stream, text, strlen(text), &consumed) == MB_JSON_StreamDone)
+    {
+        json = MB_JSON_StreamDetach(stream);
+    }
+    MB_JSON_StreamDelete(stream);
+    return json;
+}
+
+/* A key with an escaped NUL ends at the NUL, whichever parser reads it */
+static void test_key_with_nul(MB_JSON_bool intern)
+{
+    const char *text = "{\"ab\\u0000cd\":1,\"ab\":2}";
+    MB_JSON *streamed = NULL;
+    MB_JSON *parsed = NULL;
+
+    MB_JSON_InternKeys(intern);
+    streamed = stream_parse(text);
+    parsed = MB_JSON_Parse(text);
+    check(streamed != NULL, "stream parse of a key with NUL");
+    check(parsed != NULL, "parse of a key with NUL");
+    if ((streamed != NULL) && (parsed != NULL))
+    {
+        check(strcmp(streamed->child->string, "ab") == 0, "streamed key ends at NUL");
+        check(strcmp(parsed->child->string, "ab") == 0, "parsed key ends at NUL");
+        check(!intern || (streamed->child->string == parsed->child->string), "interned keys are shared");
+    }
+    MB_JSON_Delete(streamed);
+    MB_JSON_Delete(parsed);
+    MB_JSON_InternKeys(0);
+}
+
+/* Documents that reach every state of the stream parser */
+static const char *const documents[] = {
+    "{\"a\":1,\"b\":[true,false,null],\"c\":{\"d\":\"e\"}}",
+    " [ 0 , -0 , 1.5e3 , -2.25E-2 , 123456789012345678901234567890 , 1e400 ] ",
+    "{\"esc\":\"q\\\"b\\\\s\\/n\\n\\r\\t\\b\\f\",\"u\":\"\\u00e9\\u20ac\\ud83d\\ude00\"}",
+    "[[],{},[[[]]],{\"\":{}},\"\"]",
+    "{\"nested\":[{\"id\":1,\"tags\":[\"x\",\"y\"]},{\"id\":2,\"tags\":[]}],\"n\":null}",
+    "\"only a string\"",
+    "true",
+    "\n\t{ \"spaced\" :\r\n [ 1 ,\t2 ] }\n",
+};
+
+/* Feeds text in chunks of 1 to max_chunk characters, or in one piece when max_chunk is 0 */
+static MB_JSON *stream_parse_chunks(const char *text, size_t max_chunk)
+{
+    MB_JSON_Stream *stream = MB_JSON_StreamCreate();
+    MB_JSON *json = NULL;
+    size_t length = strlen(text);
+    size_t position = 0;
+    size_t consumed = 0;
+    int result = MB_JSON_StreamMore;
+
+    if (stream == NULL)
+    {
+        return NULL;
+    }
+    while ((position < length) && (result == MB_JSON_StreamMore))
+    {
+        size_t chunk = (max_chunk == 0) ? length : 1 + (size_t)rand() % max_chunk;
+        if (chunk > length - position)
+        {
+            chunk = length - position;
+        }
+        result = MB_JSON_StreamFeed(stream, text + position, chunk, &consumed);
+        position += consumed;
+    }
+    if (result == MB_JSON_StreamMore)
+    {
+        result = MB_JSON_StreamEnd(stream);
+    }
+    if (result == MB_JSON_StreamDone)
+    {
+        json = MB_JSON_StreamDetach(stream);
+    }
+    MB_JSON_StreamDelete(stream);
+    return json;
+}
+
+/* Printed the same as the tree of MB_JSON_Parse, however the input is split */
+static void test_stream_chunks(void)
+{
+    const char *numbers[] = {"42", "-0.5e-3"};
+    size_t i = 0;
+    int round = 0;
+
+    srand(1);
+    for (i = 0; i < sizeof(documents) / sizeof(documents[0]); i++)
+    {
+        MB_JSON *parsed = MB_JSON_Parse(documents[i]);
+        char *expected = MB_JSON_PrintUnformatted(parsed);
+
+        check(expected != NULL, documents[i]);
+        for (round = 0; (expected != NULL) && (round < 200); round++)
+        {
+            MB_JSON *streamed = stream_parse_chunks(documents[i], (round == 0) ? 0 : 1 + round % 12);
+            char *printed = MB_JSON_PrintUnformatted(streamed);
+            int same = (printed != NULL) && (strcmp(printed, expected) == 0);
+
+            check(same, "stream parse in chunks equals MB_JSON_Parse");
+            MB_JSON_free(printed);
+            MB_JSON_Delete(streamed);
+            if (!same)
+            {
+                printf("  %s\n", documents[i]);
+                break;
+            }
+        }
+        MB_JSON_free(expected);
+        MB_JSON_Delete(parsed);
+    }
+
+    /* A number at the root only ends with the input */
+    for (i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++)
+    {
+        MB_JSON *streamed = stream_parse_chunks(numbers[i], 1);
+        check((streamed != NULL) && (streamed->valuedouble == strtod(numbers[i], NULL)), "stream parse of a number at the root");
+        MB_JSON_Delete(streamed);
+    }
+
+    /* Truncated and malformed input is an error, not a tree */
+    check(stream_parse_chunks("{\"a\":[1,2", 3) == NULL, "stream parse of truncated input");
+    check(stream_parse_chunks("{\"a\" 1}", 3) == NULL, "stream parse of a missing colon");
+    check(stream_parse_chunks("[1,,2]", 3) == NULL, "stream parse of a missing value");
+    check(stream_parse_chunks("\"\\x\"", 3) == NULL, "stream parse of a bad escape");
+}
+
+/* Collects the pieces of MB_JSON_PrintToWriter */
+typedef struct
+{
+    char text[4096];
+    size_t length;
+    int terminated;
+} collected_t;
+
+static MB_JSON_bool collect_writer(const char *data, size_t length, void *user)
+{
+    collected_t *c = (collected_t *)user;
+
+    if ((length == 0) || (c->length + length >= sizeof(c->text)))
+    {
+        return 0;
+    }
+    c->terminated = c->terminated && (data[length] == '\0');
+    memcpy(c->text + c->length, data, length);
+    c->length += length;
+    c->text[c->length] = '\0';
+    return 1;
+}
+
+/* Printing through a small buffer gives the text of MB_JSON_Print and MB_JSON_PrintUnformatted */
+static void test_print_to_writer(void)
+{
+    const char *text = "{\"long\":\"a string much longer than the buffers used in this test, with \\\"escapes\\\"\","
+                       "\"deep\":[[[{\"k\":[1.5,-2,3e-7]}]]],\"empty\":{},\"list\":[]}";
+    const char *texts[sizeof(documents) / sizeof(documents[0]) + 1];
+    size_t i = 0;
+    size_t size = 0;
+    int format = 0;
+
+    memcpy(texts, documents, sizeof(documents));
+    texts[sizeof(documents) / sizeof(documents[0])] = text;
+    for (i = 0; i < sizeof(texts) / sizeof(texts[0]); i++)
+    {
+        MB_JSON *json = MB_JSON_Parse(texts[i]);
+
+        for (format = 0; format <= 1; format++)
+        {
+            char *expected = format ? MB_JSON_Print(json) : MB_JSON_PrintUnformatted(json);
+
+            for (size = 2; (expected != NULL) && (size <= 40); size++)
+            {
+                char buffer[40];
+                collected_t c;
+
+                c.length = 0;
+                c.text[0] = '\0';
+                c.terminated = 1;
+                check(MB_JSON_PrintToWriter(json, format, buffer, size, collect_writer, &c), "print to writer");
+                check(strcmp(c.text, expected) == 0, format ? "formatted print to writer" : "unformatted print to writer");
+                check(c.terminated, "pieces of print to writer are terminated");
+                check(MB_JSON_SerializedBufferLength(json, format) == strlen(expected), "serialized length");
+            }
+            MB_JSON_free(expected);
+        }
+        MB_JSON_Delete(json);
+    }
+}
+
+/* Hands out the bytes of a buffer one at a time */
+typedef struct
+{
+    const unsigned char *data;
+    size_t length;
+} cbor_source_t;
+
+static size_t cbor_byte_reader(unsigned char *data, size_t length, void *user)
+{
+    cbor_source_t *source = (cbor_source_t *)user;
+
+    if ((length == 0) || (source->length == 0))
+    {
+        return 0;
+    }
+    *data = *source->data++;
+    source->length--;
+    return 1;
+}
+
+/* Parses CBOR bytes written as hex, e.g. "a1616101" */
+static MB_JSON *cbor_from_hex(const char *hex, size_t *length)
+{
+    unsigned char bytes[64];
+    size_t used = 0;
+
+    *length = 0;
+    while ((hex[0] != '\0') && (*length < sizeof(bytes)))
+    {
+        unsigned int byte = 0;
+        sscanf(hex, "%2x", &byte);
+        bytes[(*length)++] = (unsigned char)byte;
+        hex += 2;
+    }
+    return MB_JSON_ParseCBOR(bytes, *length, &used);
+}
+
+/* JSON to CBOR and back gives the same tree, and incomplete or malformed CBOR gives none */
+static void test_cbor(void)
+{
+    /* RFC 8949 appendix A examples and what they read as */
+    static const char *const decoded[][2] = {
+        {"00", "0"},
+        {"1864", "100"},
+        {"3903e7", "-1000"},
+        {"f93c00", "1"},
+        {"f9c400", "-4"},
+        {"fa47c35000", "100000"},
+        {"fb3ff199999999999a", "1.1"},
+        {"f4", "false"},
+        {"f5", "true"},
+        {"f6", "null"},
+        {"6449455446", "\"IETF\""},
+        {"7f657374726561646d696e67ff", "\"streaming\""},
+        {"9f018202039f0405ffff", "[1,[2,3],[4,5]]"},
+        {"a26161016162820203", "{\"a\":1,\"b\":[2,3]}"},
+        {"bf6346756ef563416d7421ff", "{\"Fun\":true,\"Amt\":-2}"},
+        {"c11a514b67b0", "1363896240"},
+    };
+    /* Byte strings, keys that are not text, reserved and misplaced codes */
+    static const char *const rejected[] = {
+        "4401020304", "a10102", "1c", "ff", "9f01", "7f01ff", "5f4101ff", "f8",
+    };
+    size_t i = 0;
+    size_t n = 0;
+
+    for (i = 0; i < sizeof(documents) / sizeof(documents[0]); i++)
+    {
+        MB_JSON *json = MB_JSON_Parse(documents[i]);
+        size_t length = MB_JSON_CBORLength(json);
+        unsigned char *bytes = (unsigned char *)malloc(length + 1);
+        collected_t c;
+        char buffer[10];
+        size_t used = 0;
+        MB_JSON *decoded_json = NULL;
+        cbor_source_t source;
+        char *expected = MB_JSON_PrintUnformatted(json);
+        char *printed = NULL;
+
+        check((length > 0) && (MB_JSON_PrintCBORPreallocated(json, bytes, length) == length), "CBOR into a buffer");
+        check(MB_JSON_PrintCBORPreallocated(json, bytes, length - 1) == 0, "CBOR into a buffer too small");
+        c.length = 0;
+        c.terminated = 1;
+        check(MB_JSON_PrintCBORToWriter(json, buffer, sizeof(buffer), collect_writer, &c), "CBOR to writer");
+        check((c.length == length) && (memcmp(c.text, bytes, length) == 0), "CBOR to writer equals CBOR into a buffer");
+
+        decoded_json = MB_JSON_ParseCBOR(bytes, length, &used);
+        printed = MB_JSON_PrintUnformatted(decoded_json);
+        check((used == length) && (printed != NULL) && (strcmp(printed, expected) == 0), "CBOR round trip");
+        MB_JSON_free(printed);
+        MB_JSON_Delete(decoded_json);
+
+        source.data = bytes;
+        source.length = length;
+        decoded_json = MB_JSON_ParseCBORFromReader(cbor_byte_reader, &source);
+        printed = MB_JSON_PrintUnformatted(decoded_json);
+        check((printed != NULL) && (strcmp(printed, expected) == 0), "CBOR round trip from a reader");
+        MB_JSON_free(printed);
+        MB_JSON_Delete(decoded_json);
+
+        for (n = 0; n < length; n++)
+        {
+            decoded_json = MB_JSON_ParseCBOR(bytes, n, &used);
+            check(decoded_json == NULL, "truncated CBOR");
+            MB_JSON_Delete(decoded_json);
+            source.data = bytes;
+            source.length = n;
+            decoded_json = MB_JSON_ParseCBORFromReader(cbor_byte_reader, &source);
+            check(decoded_json == NULL, "truncated CBOR from a reader");
+            MB_JSON_Delete(decoded_json);
+        }
+
+        MB_JSON_free(expected);
+        MB_JSON_Delete(json);
+        free(bytes);
+    }
+
+    for (i = 0; i < sizeof(decoded) / sizeof(decoded[0]); i++)
+    {
+        size_t length = 0;
+        MB_JSON *json = cbor_from_hex(decoded[i][0], &length);
+        char *printed = MB_JSON_PrintUnformatted(json);
+
+        check((printed != NULL) && (strcmp(printed, decoded[i][1]) == 0), decoded[i][0]);
+        MB_JSON_free(printed);
+        MB_JSON_Delete(json);
+    }
+
+    for (i = 0; i < sizeof(rejected) / sizeof(rejected[0]); i++)
+    {
+        size_t length = 0;
+        MB_JSON *json = cbor_from_hex(rejected[i], &length);
+
+        check(json == NULL, rejected[i]);
+        MB_JSON_Delete(json);
+    }
+}
+
+/* An empty key is valid JSON, the stream parser has no token buffer for it */
+static void test_empty_key(MB_JSON_bool intern)
+{
+    const char *text = "{\"\":1}";
+    MB_JSON *streamed = NULL;
+    char *printed = NULL;
+
+    MB_JSON_InternKeys(intern);
+    streamed = stream_parse(text);
+    check(streamed != NULL, "stream parse of an empty key");
+    if (streamed != NULL)
+    {
+        check(strcmp(streamed->child->string, "") == 0, "streamed empty key");
+        printed = MB_JSON_PrintUnformatted(streamed);
+        check((printed != NULL) && (strcmp(printed, text) == 0), "print of an empty key");
+        MB_JSON_free(printed);
+    }
+    MB_JSON_Delete(streamed);
+    MB_JSON_InternKeys(0);
+}
+
+/* The numbers of an array in order, e.g. "1,2,3" */
+static void array_numbers(const MB_JSON *array, char *out)
+{
+    const MB_JSON *item = NULL;
+
+    out[0] = '\0';
+    for (item = array->child; item != NULL; item = item->next)
+    {
+        sprintf(out + strlen(out), (item == array->child) ? "%d" : ",%d", (int)item->valuedouble);
+    }
+}
+
+/* Appends after detaching, inserting and replacing go after the current last item */
+static void test_list_changes(void)
+{
+    MB_JSON *array = MB_JSON_CreateArray();
+    char numbers[64];
+    int i = 0;
+
+    for (i = 1; i <= 3; i++)
+    {
+        MB_JSON_AddItemToArray(array, MB_JSON_CreateNumber(i));
+    }
+    MB_JSON_Delete(MB_JSON_DetachItemFromArray(array, 2));
+    MB_JSON_AddItemToArray(array, MB_JSON_CreateNumber(4));
+    MB_JSON_Delete(MB_JSON_DetachItemFromArray(array, 0));
+    MB_JSON_AddItemToArray(array, MB_JSON_CreateNumber(5));
+    MB_JSON_InsertItemInArray(array, 0, MB_JSON_CreateNumber(6));
+    MB_JSON_InsertItemInArray(array, 2, MB_JSON_CreateNumber(7));
+    MB_JSON_ReplaceItemInArray(array, 4, MB_JSON_CreateNumber(8));
+    MB_JSON_AddItemToArray(array, MB_JSON_CreateNumber(9));
+    MB_JSON_ReplaceItemInArray(array, 0, MB_JSON_CreateNumber(10));
+    MB_JSON_AddItemToArray(array, MB_JSON_CreateNumber(11));
+    array_numbers(array, numbers);
+    check(strcmp(numbers, "10,2,7,4,8,9,11") == 0, "list order after changes");
+
+    while (array->child != NULL)
+    {
+        MB_JSON_Delete(MB_JSON_DetachItemViaPointer(array, array->child));
+    }
+    MB_JSON_AddItemToArray(array, MB_JSON_CreateNumber(12));
+    array_numbers(array, numbers);
+    check(strcmp(numbers, "12") == 0, "list order after emptying");
+    MB_JSON_Delete(array);
+
+    array = MB_JSON_CreateIntArray((const int[]){1, 2}, 2);
+    MB_JSON_AddItemToArray(array, MB_JSON_CreateNumber(3));
+    MB_JSON_AddItemToArray(array, MB_JSON_Duplicate(array, 1));
+    MB_JSON_AddItemToArray(array->child->next->next->next, MB_JSON_CreateNumber(4));
+    array_numbers(array->child->next->next->next, numbers);
+    check(strcmp(numbers, "1,2,3,4") == 0, "list order of created and duplicated arrays");
+    MB_JSON_Delete(array);
+}
+
+/* Value of every member k<i> of an indexed object as expected[i], -1 for none */
+static void check_members(const MB_JSON *object, const int *expected, int count, const char *name)
+{
+    char key[16];
+    int ok = 1;
+    int i = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        const MB_JSON *item = NULL;
+
+        sprintf(key, "k%d", i);
+        item = MB_JSON_GetObjectItemCaseSensitive(object, key);
+        if (expected[i] < 0)
+        {
+            ok = ok && (item == NULL);
+        }
+        else
+        {
+            ok = ok && (item != NULL) && (MB_JSON_GetNumberValue(item) == expected[i]);
+        }
+    }
+    check(ok, name);
+}
+
+/* Lookups through the member index follow adds, replaces and deletes */
+static void test_object_index(void)
+{
+    MB_JSON *objects[MB_JSON_INDEX_LIMIT + 1];
+    MB_JSON *object = NULL;
+    MB_JSON *inserted = NULL;
+    int expected[48];
+    char key[16];
+    int i = 0;
+    int j = 0;
+
+    MB_JSON_IndexObjects(1);
+    object = MB_JSON_CreateObject();
+    for (i = 0; i < 40; i++)
+    {
+        sprintf(key, "k%d", i);
+        MB_JSON_AddItemToObject(object, key, MB_JSON_CreateNumber(i));
+        expected[i] = i;
+    }
+    for (i = 40; i < 48; i++)
+    {
+        expected[i] = -1;
+    }
+    check_members(object, expected, 48, "lookups in an indexed object");
+
+    MB_JSON_AddItemToObject(object, "k40", MB_JSON_CreateNumber(40));
+    MB_JSON_AddItemToObject(object, "k3", MB_JSON_CreateNumber(300));
+    expected[40] = 40;
+    check_members(object, expected, 48, "lookups after adding members");
+
+    /* a member inserted in front hides the one with the same name */
+    inserted = MB_JSON_Parse("{\"k1\":100}");
+    MB_JSON_InsertItemInArray(object, 0, MB_JSON_DetachItemFromObjectCaseSensitive(inserted, "k1"));
+    MB_JSON_Delete(inserted);
+    expected[1] = 100;
+    check_members(object, expected, 48, "lookups after inserting a member");
+
+    MB_JSON_ReplaceItemInObjectCaseSensitive(object, "k5", MB_JSON_CreateNumber(500));
+    MB_JSON_ReplaceItemInObjectCaseSensitive(object, "k39", MB_JSON_CreateNumber(3900));
+    expected[5] = 500;
+    expected[39] = 3900;
+    check_members(object, expected, 48, "lookups after replacing members");
+
+    MB_JSON_DeleteItemFromObjectCaseSensitive(object, "k0");
+    MB_JSON_DeleteItemFromObjectCaseSensitive(object, "k20");
+    MB_JSON_Delete(MB_JSON_DetachItemViaPointer(object, MB_JSON_GetObjectItemCaseSensitive(object, "k40")));
+    expected[0] = -1;
+    expected[20] = -1;
+    expected[40] = -1;
+    check_members(object, expected, 48, "lookups after deleting members");
+
+    /* the first of two members with the same name is found */
+    MB_JSON_DeleteItemFromObjectCaseSensitive(object, "k3");
+    expected[3] = 300;
+    check_members(object, expected, 48, "lookups after deleting a duplicate name");
+    MB_JSON_Delete(object);
+
+    /* more indexed objects than MB_JSON_INDEX_LIMIT, deleted and recreated in the same memory */
+    for (j = 0; j < 2; j++)
+    {
+        for (i = 0; i <= MB_JSON_INDEX_LIMIT; i++)
+        {
+            objects[i] = MB_JSON_Parse(j == 0 ? "{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,\"k7\":7,\"k8\":8,\"k9\":9,\"k10\":10,\"k11\":11,\"k12\":12,\"k13\":13,\"k14\":14,\"k15\":15,\"k16\":16,\"k17\":17}"
+                                              : "{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,\"k7\":7,\"k8\":8,\"k9\":9,\"k10\":10,\"k11\":11,\"k12\":12,\"k13\":13,\"k14\":14,\"k15\":15,\"k16\":16}");
+        }
+        for (i = 0; i < 18; i++)
+        {
+            expected[i] = ((j == 1) && (i == 17)) ? -1 : i;
+        }
+        for (i = 0; i <= MB_JSON_INDEX_LIMIT; i++)
+        {
+            check_members(objects[i], expected, 18, "lookups in many indexed objects");
+        }
+        for (i = 0; i <= MB_JSON_INDEX_LIMIT; i++)
+        {
+            MB_JSON_Delete(objects[i]);
+        }
+    }
+    MB_JSON_IndexObjects(0);
+}
+
+/* A random double of any exponent, the bits taken as they come */
+static double random_double(void)
+{
+    unsigned long long bits = 0;
+    double number = 0;
+    int i = 0;
+
+    do
+    {
+        for (i = 0; i < 4; i++)
+        {
+            bits = (bits << 16) ^ (unsigned long long)(rand() & 0xFFFF);
+        }
+        memcpy(&number, &bits, sizeof(number));
+    } while (isnan(number) || isinf(number));
+    return number;
+}
+
+/* Formatted numbers read back as the same double, and parse like strtod */
+static void test_numbers(void)
+{
+    static const struct
+    {
+        double number;
+        const char *text;
+    } known[] = {
+        {0.0, "0"},
+        {1.0, "1"},
+        {-2.5, "-2.5"},
+        {0.1, "0.1"},
+        {0.30000000000000004, "0.30000000000000004"},
+        {100.0, "100"},
+        {1e15, "1e+15"},
+        {123456789012345.0, "123456789012345"},
+        {1e-5, "1e-05"},
+        {0.0001, "0.0001"},
+        {5e-324, "5e-324"},
+        {1.7976931348623157e308, "1.7976931348623157e+308"},
+    };
+    static const char *const texts[] = {
+        "0", "-0", "1", "-1", "0.5", "1.5e3", "-2.25E-2", "1e22", "1e23", "9007199254740993", "123456789012345678901234567890",
+        "0.1e-310", "2.2250738585072011e-308", "1e400", "-1e-400", "3.141592653589793238462643383279",
+    };
+    char buffer[32];
+    char reference[32];
+    double number = 0;
+    double parsed = 0;
+    size_t used = 0;
+    int length = 0;
+    int exact = 1;
+    int strtod_equal = 1;
+    int i = 0;
+
+    for (i = 0; i < (int)(sizeof(known) / sizeof(known[0])); i++)
+    {
+        length = MB_JSON_FormatNumber(known[i].number, buffer);
+        check((length == (int)strlen(known[i].text)) && (strcmp(buffer, known[i].text) == 0), known[i].text);
+    }
+    check((MB_JSON_FormatNumber(NAN, buffer) == 4) && (strcmp(buffer, "null") == 0), "NaN prints as null");
+    check(strcmp((MB_JSON_FormatNumber(-INFINITY, buffer), buffer), "null") == 0, "Infinity prints as null");
+
+    for (i = 0; i < (int)(sizeof(texts) / sizeof(texts[0])); i++)
+    {
+        used = MB_JSON_ParseNumber(texts[i], strlen(texts[i]), &parsed);
+        check((used == strlen(texts[i])) && (memcmp(&parsed, &(double){strtod(texts[i], NULL)}, sizeof(parsed)) == 0), texts[i]);
+    }
+    check((MB_JSON_ParseNumber("12,3", 4, &parsed) == 2) && (parsed == 12), "a number ends at the first other character");
+    check(MB_JSON_ParseNumber("1.5", 2, &parsed) == 2, "a number ends at the given length");
+    check(MB_JSON_ParseNumber("x1", 2, &parsed) == 0, "text that is not a number");
+
+    srand(21);
+    for (i = 0; i < 200000; i++)
+    {
+        number = (i % 2 == 0) ? random_double() : (double)(rand() % 2000001 - 1000000) / 1000.0;
+        length = MB_JSON_FormatNumber(number, buffer);
+        used = MB_JSON_ParseNumber(buffer, (size_t)length, &parsed);
+        exact = exact && (used == (size_t)length) && (memcmp(&parsed, &number, sizeof(number)) == 0) && (strtod(buffer, NULL) == number);
+
+        /* decimal texts of every length, as other writers produce them */
+        sprintf(reference, "%.*g", 1 + i % 17, number);
+        used = MB_JSON_ParseNumber(reference, strlen(reference), &parsed);
+        number = strtod(reference, NULL);
+        strtod_equal = strtod_equal && (used == strlen(reference)) && (memcmp(&parsed, &number, sizeof(number)) == 0);
+    }
+    check(exact, "formatted numbers read back as the same double");
+    check(strtod_equal, "parsed numbers equal strtod");
+}
+
+/* Heap allocations made through the hooks and not freed yet */
+static int heap_blocks = 0;
+
+static void *counting_malloc(size_t size)
+{
+    heap_blocks++;
+    return malloc(size);
+}
+
+static void counting_free(void *pointer)
+{
+    if (pointer != NULL)
+    {
+        heap_blocks--;
+    }
+    free(pointer);
+}
+
+static void *counting_realloc(void *pointer, size_t size)
+{
+    if (pointer == NULL)
+    {
+        heap_blocks++;
+    }
+    return realloc(pointer, size);
+}
+
+/* The arena counts what is taken and what is still in use, and empties once nothing is */
+static void test_arena(void)
+{
+    MB_JSON_Hooks hooks = {counting_malloc, counting_free, counting_realloc};
+    MB_JSON_Arena *arena = NULL;
+    MB_JSON *json = NULL;
+    MB_JSON *large = NULL;
+    char *printed = NULL;
+    size_t used = 0;
+    int blocks = 0;
+
+    MB_JSON_InitHooks(&hooks);
+    arena = MB_JSON_ArenaCreate(1024);
+    check(arena != NULL, "arena created");
+    if (arena == NULL)
+    {
+        MB_JSON_InitHooks(NULL);
+        return;
+    }
+    blocks = heap_blocks;
+
+    MB_JSON_ArenaSelect(arena);
+    json = MB_JSON_Parse(documents[0]);
+    check(json != NULL, "parse into the arena");
+    used = MB_JSON_ArenaUsed(arena);
+    check((used > 0) && (MB_JSON_ArenaLive(arena) == used), "a parsed tree is all in use");
+    check(heap_blocks == blocks, "a small tree takes nothing from the heap");
+
+    /* the print buffer is the last allocation, freeing it gives its bytes back */
+    printed = MB_JSON_PrintUnformatted(json);
+    check((printed != NULL) && (strcmp(printed, documents[0]) == 0), "print from the arena");
+    check(MB_JSON_ArenaUsed(arena) > used, "the print buffer is taken from the arena");
+    MB_JSON_free(printed);
+    check((MB_JSON_ArenaUsed(arena) == used) && (MB_JSON_ArenaLive(arena) == used), "MB_JSON_free returns the print buffer");
+
+    /* replaced items stay taken but not in use */
+    MB_JSON_ReplaceItemInObject(json, "a", MB_JSON_CreateNumber(2));
+    check(MB_JSON_ArenaLive(arena) < MB_JSON_ArenaUsed(arena), "a replaced item is no longer in use");
+
+    /* what doesn't fit comes from the heap and goes back to it */
+    large = MB_JSON_CreateArray();
+    while ((large != NULL) && (heap_blocks == blocks))
+    {
+        MB_JSON_AddItemToArray(large, MB_JSON_CreateString("filling up the arena"));
+    }
+    check(heap_blocks > blocks, "a full arena falls back to the heap");
+    check(MB_JSON_ArenaUsed(arena) <= 1024, "the arena doesn't overflow");
+    MB_JSON_Delete(large);
+    check(heap_blocks == blocks, "heap items of a full arena are freed");
+
+    MB_JSON_Delete(json);
+    check((MB_JSON_ArenaUsed(arena) == 0) && (MB_JSON_ArenaLive(arena) == 0), "the arena empties with its last item");
+
+    json = MB_JSON_Parse(documents[4]);
+    check(MB_JSON_ArenaUsed(arena) > 0, "parse into an emptied arena");
+    MB_JSON_ArenaReset(arena);
+    check((MB_JSON_ArenaUsed(arena) == 0) && (MB_JSON_ArenaLive(arena) == 0), "reset empties the arena");
+
+    MB_JSON_ArenaSelect(NULL);
+    MB_JSON_ArenaDelete(arena);
+    check(heap_blocks == 0, "the arena block is freed");
+    MB_JSON_InitHooks(NULL);
+}
+
+/* Building a large array and object takes linear time */
+static void test_append_cost(void)
+{
+    MB_JSON *array = MB_JSON_CreateArray();
+    MB_JSON *object = MB_JSON_CreateObject();
+    clock_t start = clock();
+    char name[16];
+    int i = 0;
+
+    for (i = 0; i < 65536; i++)
+    {
+        sprintf(name, "%d", i);
+        MB_JSON_AddItemToArray(array, MB_JSON_CreateNumber(i));
+        MB_JSON_AddItemToObject(object, name, MB_JSON_CreateNumber(i));
+    }
+    check(MB_JSON_GetArraySize(array) == 65536, "size of a large array");
+    check((double)(clock() - start) / CLOCKS_PER_SEC < 1.0, "appends are O(1)");
+    MB_JSON_Delete(array);
+    MB_JSON_Delete(object);
+}
+
+int main(void)
+{
+    test_key_with_nul(0);
+    test_key_with_nul(1);
+    test_empty_key(0);
+    test_empty_key(1);
+    test_stream_chunks();
+    test_print_to_writer();
+    test_cbor();
+    test_numbers();
+    test_arena();
+    test_object_index();
+    test_list_changes();
+    test_append_cost();
+
+    if (failures == 0)
+    {
+        printf("all passed\n");
+    }
+    return failures;
+}
@@ -10,4 +10,20 @@
 /** Use filesystems */
 #define FIREBASEJSON_USE_FS
 
+/** Share one copy of the object keys repeated across items */
+// #define FIREBASEJSON_INTERN_KEYS
+
+/** Keep MB_JSON items in 24 bytes instead of 40 on 32-bit targets, without the prev link and valueint.
+ * Removing or inserting an item then walks from the first item of its array or object. */
+// #define FIREBASEJSON_COMPACT_ITEMS
+
+/** Index the members of large objects for get and set by path */
+// #define FIREBASEJSON_INDEX_OBJECTS
+
+/** Size of the buffer taken from the stack to serialize to a string, Stream or Client */
+#define FIREBASEJSON_PRINT_BUFFER_SIZE 128
+
+/** Bytes of short strings (keys, path segments, numbers) kept inside the string object instead of the heap */
+#define FIREBASEJSON_STRING_INLINE_SIZE 16
+
 #endif
\ No newline at end of file
@@ -44,11 +44,19 @@
 FirebaseJsonBase::FirebaseJsonBase()
 {
     MB_JSON_InitHooks(&MB_JSON_hooks);
+#if defined(FIREBASEJSON_INTERN_KEYS)
+    MB_JSON_InternKeys(true);
+#endif
+#if defined(FIREBASEJSON_INDEX_OBJECTS)
+    MB_JSON_IndexObjects(true);
+#endif
 }
 
 FirebaseJsonBase::~FirebaseJsonBase()
 {
     mClear();
+    MB_JSON_StreamDelete(serData.parser);
+    MB_JSON_ArenaDelete(arena);
 }
 
 FirebaseJsonBase &FirebaseJsonBase::mClear()
@@ -58,24 +66,25 @@ FirebaseJsonBase &FirebaseJsonBase::mClear()
         MB_JSON_Delete(root);
     root = NULL;
     buf.clear();
+    shrinkS(buf);
     errorPos = -1;
     return *this;
 }
 void FirebaseJsonBase::mCopy(FirebaseJsonBase &other)
 {
+    fb_js::arena_scope_t scope(mArena());
     mClear();
     this->root = MB_JSON_Duplicate(other.root, true);
     this->doubleDigits = other.doubleDigits;
     this->floatDigits = other.floatDigits;
     this->httpCode = other.httpCode;
-    this->serData = other.serData;
     this->root_type = other.root_type;
-    this->iterator_data = other.iterator_data;
     this->buf = other.buf;
 }
 
 bool FirebaseJsonBase::setRaw(const char *raw)
 {
+    fb_js::arena_scope_t scope(mArena());
     mClear();
 
     if (raw)
@@ -140,6 +149,66 @@ void FirebaseJsonBase::searchElements(MB_VECTOR<MB_String> &keys, MB_JSON *paren
     }
 }
 
+bool FirebaseJsonBase::nextPathToken(const char *&path, struct fb_js::path_token_t &token)
+{
+    // the same node names as makeList, trimmed and without the empty ones
+    while (path && *path)
+    {
+        const char *end = strchr(path, '/');
+        if (end == NULL)
+            end = path + strlen(path);
+
+        token.str = path;
+        token.len = end - path;
+        path = *end ? end + 1 : end;
+
+        while (token.len > 0 && token.str[0] <= 32)
+        {
+            token.str++;
+            token.len--;
+        }
+        while (token.len > 0 && token.str[token.len - 1] <= 32)
+            token.len--;
+
+        if (token.len > 0)
+            return true;
+    }
+    return false;
+}
+
+MB_JSON *FirebaseJsonBase::findElement(MB_JSON *parent, const char *path, MB_JSON **owner)
+{
+    // walks the path without copying its node names, NULL unless all of them exist
+    struct fb_js::path_token_t token;
+    MB_JSON *e = NULL;
+
+    while (nextPathToken(path, token))
+    {
+        if (e != NULL)
+            parent = e;
+
+        bool isArrKey = token.str[0] == '[' && token.str[token.len - 1] == ']';
+
+        if (isArray(parent) && isArrKey)
+        {
+            int index = atoi(token.str + 1);
+            e = MB_JSON_GetArrayItem(parent, index < 0 ? 0 : index);
+        }
+        else if (isObject(parent) && !isArrKey)
+            e = MB_JSON_GetObjectItemCaseSensitiveWithLength(parent, token.str, token.len);
+        else
+            e = NULL;
+
+        if (e == NULL)
+            return NULL;
+    }
+
+    if (owner)
+        *owner = parent;
+
+    return e;
+}
+
 MB_JSON *FirebaseJsonBase::getElement(MB_JSON *parent, const char *key, struct search_result_t &r)
 {
     MB_JSON *e = NULL;
@@ -167,7 +236,7 @@ MB_JSON *FirebaseJsonBase::getElement(MB_JSON *parent, const char *key, struct s
     return e;
 }
 
-void FirebaseJsonBase::mAdd(MB_VECTOR<MB_String> keys, MB_JSON **parent, int beginIndex, MB_JSON *value)
+void FirebaseJsonBase::mAdd(MB_VECTOR<MB_String> &keys, MB_JSON **parent, int beginIndex, MB_JSON *value)
 {
     MB_JSON *m_parent = *parent;
 
@@ -345,16 +414,16 @@ void FirebaseJsonBase::replace(MB_VECTOR<MB_String> &keys, struct search_result_
 size_t FirebaseJsonBase::mIteratorBegin(MB_JSON *parent)
 {
     mIteratorEnd();
-    char *p = MB_JSON_PrintUnformatted(parent);
-    if (p == NULL)
-        return 0;
+    iterator_data.parent = parent;
 
-    buf = p;
-    MB_JSON_free(p);
-    iterator_data.buf_size = buf.length();
-    int index = -1;
-    mIterate(parent, index);
-    return iterator_data.result.size();
+    // count the values without keeping them, they are visited again by mIteratorGet
+    size_t count = 0;
+    int depth = -1;
+    mIteratorRestart();
+    while (mIteratorNext(depth))
+        count++;
+    mIteratorRestart();
+    return count;
 }
 
 size_t FirebaseJsonBase::mIteratorBegin(MB_JSON *parent, MB_VECTOR<MB_String> *keys)
@@ -364,162 +433,118 @@ size_t FirebaseJsonBase::mIteratorBegin(MB_JSON *parent, MB_VECTOR<MB_String> *k
     if (keys == NULL)
         return 0;
 
-    int index = -1;
-    mIterate(parent, index);
-
-    return iterator_data.result.size();
+    return mIteratorBegin(parent);
 }
 
 void FirebaseJsonBase::mIteratorEnd(bool clearBuf)
 {
     if (clearBuf)
+    {
         buf.clear();
-    iterator_data.path.clear();
-    iterator_data.buf_size = 0;
-    iterator_data.buf_offset = 0;
-    iterator_data.result.clear();
-    iterator_data.depth = -1;
-    iterator_data._depth = 0;
-    if (iterator_data.parentArr != NULL)
-        MB_JSON_Delete(iterator_data.parentArr);
-    iterator_data.parentArr = NULL;
+        shrinkS(buf);
+    }
+    iterator_data.parent = NULL;
+    mIteratorRestart();
 }
 
-void FirebaseJsonBase::mIterate(MB_JSON *parent, int &arrIndex)
+void FirebaseJsonBase::mIteratorRestart()
 {
-    if (!parent)
-        return;
-
-    bool isAr = isArray(parent);
-
-    if (isAr)
-        arrIndex = 0;
+    iterator_data.stack.clear();
+    iterator_data.depth = -1;
+    iterator_data.item = NULL;
+    iterator_data.index = 0;
+    iterator_data.itemDepth = -1;
 
-    MB_JSON *e = parent->child;
-    if (e)
+    // the data was changed or replaced since, walk the current one
+    if (iterator_data.parent != NULL)
     {
-        iterator_data.depth++;
-        while (e)
-        {
-
-            if (isArray(e) || isObject(e))
-                mCollectIterator(e, e->string ? JSON_OBJECT : JSON_ARRAY, arrIndex);
-
-            if (isArray(e))
-            {
-                MB_JSON *item = e->child;
-                int _arrIndex = 0;
-
-                if (e->child)
-                {
-                    iterator_data.depth++;
-                    while (item)
-                    {
-
-                        if (isArray(item) || isObject(item))
-                            mIterate(item, _arrIndex);
-                        else
-                            mCollectIterator(item, item->string ? JSON_OBJECT : JSON_ARRAY, _arrIndex);
-                        item = item->next;
-                        _arrIndex++;
-                    }
-                }
-            }
-            else if (isObject(e))
-                mIterate(e, arrIndex);
-            else
-                mCollectIterator(e, e->string ? JSON_OBJECT : JSON_ARRAY, arrIndex);
-
-            e = e->next;
-
-            if (isAr)
-                arrIndex++;
-        }
+        iterator_data.parent = root;
+        if (root != NULL)
+            mIteratorPush(root->child, false);
     }
 }
 
-void FirebaseJsonBase::mCollectIterator(MB_JSON *e, int type, int &arrIndex)
+void FirebaseJsonBase::mIteratorPush(MB_JSON *e, bool elements)
 {
-    struct iterator_result_t result;
+    if (e == NULL)
+        return;
 
-    if (e->string)
+    struct iterator_frame_t frame;
+    frame.next = e;
+    frame.elements = elements;
+    iterator_data.stack.push_back(frame);
+    iterator_data.depth++;
+}
+
+MB_JSON *FirebaseJsonBase::mIteratorNext(int &depth)
+{
+    // lists the members of the objects with the arrays and objects among them, and the other values in the arrays,
+    // the depth counts the arrays and objects entered so far
+    while (iterator_data.stack.size() > 0)
     {
-        size_t pos = buf.find((const char *)e->string, iterator_data.buf_offset);
-        if (pos != MB_String::npos)
+        struct iterator_frame_t &frame = iterator_data.stack[iterator_data.stack.size() - 1];
+        MB_JSON *e = frame.next;
+        bool elements = frame.elements;
+
+        if (e == NULL)
         {
-            result.ofs1 = pos;
-            result.len1 = strlen(e->string);
-            iterator_data.buf_offset = (e->type != MB_JSON_Object && e->type != MB_JSON_Array) ? pos + result.len1 : pos;
+            iterator_data.stack.pop_back();
+            continue;
         }
-    }
 
-    char *p = MB_JSON_PrintUnformatted(e);
-    if (p)
-    {
-        if (result.ofs1 == 0)
-            result.ofs1 = iterator_data.buf_offset;
+        frame.next = e->next;
+        depth = iterator_data.depth;
 
-        int i = iterator_data.buf_offset;
-        size_t pos = buf.find(p, i);
-        if (pos != MB_String::npos)
+        if (isArray(e) || isObject(e))
         {
-            result.ofs2 = pos - result.ofs1 - result.len1;
-            result.len2 = strlen(p);
-            MB_JSON_free(p);
-            iterator_data.buf_offset = (e->type != MB_JSON_Object && e->type != MB_JSON_Array) ? pos + result.len2 : pos;
+            mIteratorPush(e->child, !elements && isArray(e));
+            if (elements)
+                continue;
         }
+
+        return e;
     }
-    result.type = type;
-    result.depth = iterator_data.depth;
-    iterator_data.result.push_back(result);
+
+    return NULL;
 }
 
 int FirebaseJsonBase::mIteratorGet(size_t index, int &type, String &key, String &value)
 {
     key.remove(0, key.length());
     value.remove(0, value.length());
-    int depth = -1;
 
-    if (buf.length() == iterator_data.buf_size)
+    if (iterator_data.parent == NULL)
+        return -1;
+
+    // the values are visited in order, going back starts over
+    if (iterator_data.item == NULL || index < iterator_data.index)
     {
-        if (index > iterator_data.result.size() - 1)
-            return depth;
+        mIteratorRestart();
+        iterator_data.item = mIteratorNext(iterator_data.itemDepth);
+    }
 
-        if (iterator_data.result[index].len1 > 0)
-        {
-            char *m_key = (char *)newP(iterator_data.result[index].len1 + 1);
-            if (m_key)
-            {
-                memset(m_key, 0, iterator_data.result[index].len1 + 1);
-                strncpy(m_key, &buf[iterator_data.result[index].ofs1], iterator_data.result[index].len1);
-                key = m_key;
-                delP(&m_key);
-            }
-        }
+    while (iterator_data.item != NULL && iterator_data.index < index)
+    {
+        iterator_data.item = mIteratorNext(iterator_data.itemDepth);
+        iterator_data.index++;
+    }
 
-        char *m_val = (char *)newP(iterator_data.result[index].len2 + 1);
-        if (m_val)
-        {
-            memset(m_val, 0, iterator_data.result[index].len2 + 1);
-            int ofs = iterator_data.result[index].ofs1 + iterator_data.result[index].len1 + iterator_data.result[index].ofs2;
-            int len = iterator_data.result[index].len2;
+    MB_JSON *e = iterator_data.item;
+    if (e == NULL)
+        return -1;
 
-            if (iterator_data.result[index].type == JSON_STRING)
-            {
-                if (buf[ofs] == '"')
-                    ofs++;
-                if (buf[ofs + len - 1] == '"')
-                    len--;
-            }
+    if (e->string)
+        key = e->string;
 
-            strncpy(m_val, &buf[ofs], len);
-            value = m_val;
-            delP(&m_val);
-        }
-        type = iterator_data.result[index].type;
-        depth = iterator_data.result[index].depth;
+    char *p = MB_JSON_PrintUnformatted(e);
+    if (p)
+    {
+        value = p;
+        MB_JSON_free(p);
     }
-    return depth;
+
+    type = e->string ? JSON_OBJECT : JSON_ARRAY;
+    return iterator_data.itemDepth;
 }
 
 struct FirebaseJsonBase::fb_js_iterator_value_t FirebaseJsonBase::mValueAt(size_t index)
@@ -533,40 +558,39 @@ struct FirebaseJsonBase::fb_js_iterator_value_t FirebaseJsonBase::mValueAt(size_
 void FirebaseJsonBase::toBuf(fb_json_serialize_mode mode)
 {
     if (root != NULL)
-    {
-        char *out = mode == fb_json_serialize_mode_pretty ? MB_JSON_Print(root) : MB_JSON_PrintUnformatted(root);
-        if (out)
-        {
-            buf = out;
-            MB_JSON_free(out);
-        }
-    }
+        toStringHandler(buf, mode == fb_json_serialize_mode_pretty);
 }
 
 bool FirebaseJsonBase::mReadClient(Client *client)
 {
-    // blocking read
-    buf.clear();
-    if (readClient(client, buf))
+    // blocking read, the payload is parsed while it is received
+    MB_JSON_Stream *parser = MB_JSON_StreamCreate();
+    if (!parser)
+        return false;
+
+    bool ret = false;
+    if (readClient(client, parser))
     {
-        if (root != NULL)
-            MB_JSON_Delete(root);
-        root = parse(buf.c_str());
-        buf.clear();
-        return root != NULL;
+        if (MB_JSON_StreamEnd(parser) == MB_JSON_StreamDone)
+        {
+            mSetRoot(MB_JSON_StreamDetach(parser));
+            errorPos = -1;
+            ret = root != NULL;
+        }
+        else
+            errorPos = (int)MB_JSON_StreamPosition(parser);
     }
-    return false;
+    MB_JSON_StreamDelete(parser);
+    return ret;
 }
 
 bool FirebaseJsonBase::mReadStream(Stream *s, int timeoutMS)
 {
     // non-blocking read
-    if (readStream(s, serData, buf, true, timeoutMS))
+    if (readStream(s, serData, root_type != Root_Type_JSONArray, timeoutMS))
     {
-        if (root != NULL)
-            MB_JSON_Delete(root);
-        root = parse(buf.c_str());
-        buf.clear();
+        mSetRoot(MB_JSON_StreamDetach(serData.parser));
+        clearSerialData(serData);
         return root != NULL;
     }
     return false;
@@ -576,18 +600,194 @@ bool FirebaseJsonBase::mReadStream(Stream *s, int timeoutMS)
 bool FirebaseJsonBase::mReadSdFat(SD_FAT_FILE &file, int timeoutMS)
 {
     // non-blocking read
-    if (readSdFatFile(file, serData, buf, true, timeoutMS))
+    if (readSdFatFile(file, serData, root_type != Root_Type_JSONArray, timeoutMS))
     {
-        if (root != NULL)
-            MB_JSON_Delete(root);
-        root = parse(buf.c_str());
-        buf.clear();
+        mSetRoot(MB_JSON_StreamDetach(serData.parser));
+        clearSerialData(serData);
         return root != NULL;
     }
     return false;
 }
 #endif
 
+void FirebaseJsonBase::mSetRoot(MB_JSON *e)
+{
+    if (root != NULL)
+        MB_JSON_Delete(root);
+    root = e;
+    mIteratorRestart();
+
+    // parsed on the heap while the previous data was still in use, move it to the now empty arena
+    if (arena != NULL && e != NULL)
+    {
+        fb_js::arena_scope_t scope(arena);
+        MB_JSON *copy = MB_JSON_Duplicate(e, true);
+        if (copy != NULL)
+        {
+            MB_JSON_Delete(e);
+            root = copy;
+        }
+    }
+}
+
+bool FirebaseJsonBase::mEqual(const MB_JSON *a, const MB_JSON *b)
+{
+    int ta = a->type & 0xFF;
+    int tb = b->type & 0xFF;
+
+    // numbers set here are raw text, parsed ones are doubles
+    if ((ta == MB_JSON_Raw && tb == MB_JSON_Number) || (ta == MB_JSON_Number && tb == MB_JSON_Raw))
+    {
+        const char *raw = ta == MB_JSON_Raw ? a->valuestring : b->valuestring;
+        size_t len = raw ? strlen(raw) : 0;
+        double d = 0;
+        return len > 0 && MB_JSON_ParseNumber(raw, len, &d) == len && d == (ta == MB_JSON_Number ? a : b)->valuedouble;
+    }
+
+    if (ta != tb)
+        return false;
+
+    switch (ta)
+    {
+    case MB_JSON_Number:
+        return a->valuedouble == b->valuedouble;
+
+    case MB_JSON_String:
+    case MB_JSON_Raw:
+        return strcmp(a->valuestring ? a->valuestring : "", b->valuestring ? b->valuestring : "") == 0;
+
+    case MB_JSON_Array:
+        for (a = a->child, b = b->child; a && b; a = a->next, b = b->next)
+        {
+            if (!mEqual(a, b))
+                return false;
+        }
+        return a == b;
+
+    case MB_JSON_Object:
+    {
+        if (MB_JSON_GetArraySize(a) != MB_JSON_GetArraySize(b))
+            return false;
+        for (const MB_JSON *e = a->child; e; e = e->next)
+        {
+            const MB_JSON *other = MB_JSON_GetObjectItemCaseSensitive(b, e->string);
+            if (!other || !mEqual(e, other))
+                return false;
+        }
+        return true;
+    }
+
+    default:
+        return true;
+    }
+}
+
+size_t FirebaseJsonBase::mDiff(MB_JSON *from, MB_JSON *to, MB_String &path, MB_JSON *update)
+{
+    size_t count = 0;
+    size_t len = path.length();
+
+    for (MB_JSON *e = to->child; e; e = e->next)
+    {
+        MB_JSON *old = from ? MB_JSON_GetObjectItemCaseSensitive(from, e->string) : NULL;
+        if (len > 0)
+            path += '/';
+        path += e->string;
+
+        // a changed object is updated by its changed keys only, PATCH replaces every value given as a whole
+        if (old && MB_JSON_IsObject(old) && MB_JSON_IsObject(e))
+            count += mDiff(old, e, path, update);
+        else if (!old || !mEqual(old, e))
+        {
+            MB_JSON_AddItemToObject(update, path.c_str(), MB_JSON_Duplicate(e, true));
+            count++;
+        }
+        path.erase(len);
+    }
+
+    for (MB_JSON *e = from ? from->child : NULL; e; e = e->next)
+    {
+        if (MB_JSON_GetObjectItemCaseSensitive(to, e->string))
+            continue;
+        if (len > 0)
+            path += '/';
+        path += e->string;
+        MB_JSON_AddNullToObject(update, path.c_str());
+        count++;
+        path.erase(len);
+    }
+
+    return count;
+}
+
+size_t FirebaseJsonBase::mGetUpdate(FirebaseJsonBase &from, FirebaseJsonBase &update)
+{
+    MB_JSON *e = MB_JSON_CreateObject();
+    if (!e)
+        return 0;
+
+    size_t count = 0;
+    if (MB_JSON_IsObject(root))
+    {
+        MB_String path;
+        count = mDiff(MB_JSON_IsObject(from.root) ? from.root : NULL, root, path, e);
+    }
+
+    update.root_type = Root_Type_JSON;
+    update.mSetRoot(e);
+    return count;
+}
+
+MB_JSON_Arena *FirebaseJsonBase::mArena()
+{
+    // mostly taken by replaced or removed items, compact by copying the data out and back
+    if (arena != NULL && root != NULL && MB_JSON_ArenaUsed(arena) > arenaSize / 4 * 3 && MB_JSON_ArenaLive(arena) < MB_JSON_ArenaUsed(arena) / 2)
+    {
+        MB_JSON *e = NULL;
+        {
+            fb_js::arena_scope_t scope(NULL);
+            e = MB_JSON_Duplicate(root, true);
+        }
+        if (e != NULL)
+            mSetRoot(e);
+    }
+    return arena;
+}
+
+bool FirebaseJsonBase::mSetArenaSize(size_t size)
+{
+    MB_JSON_Arena *a = NULL;
+    if (size > 0)
+    {
+        a = MB_JSON_ArenaCreate(size);
+        if (a == NULL)
+            return false;
+    }
+
+    // move the current data to the new arena
+    if (root != NULL)
+    {
+        MB_JSON *e = NULL;
+        {
+            fb_js::arena_scope_t scope(a);
+            e = MB_JSON_Duplicate(root, true);
+        }
+        if (e == NULL)
+        {
+            MB_JSON_ArenaDelete(a);
+            return false;
+        }
+        MB_JSON_Delete(root);
+        root = e;
+        mIteratorRestart();
+    }
+
+    MB_JSON_ArenaDelete(arena);
+    arena = a;
+    arenaSize = size;
+    return true;
+}
+
 const char *FirebaseJsonBase::mRaw()
 {
     toBuf(fb_json_serialize_mode_plain);
@@ -598,6 +798,7 @@ bool FirebaseJsonBase::mRemove(const char *path)
 {
     bool ret = false;
     prepareRoot();
+    mIteratorRestart();
     MB_VECTOR<MB_String> keys = MB_VECTOR<MB_String>();
     makeList(path, keys, '/');
 
@@ -637,7 +838,7 @@ bool FirebaseJsonBase::mRemove(const char *path)
     return ret;
 }
 
-void FirebaseJsonBase::mGetPath(MB_String &path, MB_VECTOR<MB_String> paths, int begin, int end)
+void FirebaseJsonBase::mGetPath(MB_String &path, MB_VECTOR<MB_String> &paths, int begin, int end)
 {
     if (end < 0 || end >= (int)paths.size())
         end = paths.size() - 1;
@@ -659,6 +860,33 @@ size_t FirebaseJsonBase::mGetSerializedBufferLength(bool prettify)
     return MB_JSON_SerializedBufferLength(root, prettify);
 }
 
+size_t FirebaseJsonBase::mGetCBORLength()
+{
+    if (!root)
+        return 0;
+    return MB_JSON_CBORLength(root);
+}
+
+size_t FirebaseJsonBase::mToCBOR(uint8_t *out, size_t size)
+{
+    if (!root || !out)
+        return 0;
+    return MB_JSON_PrintCBORPreallocated(root, out, size);
+}
+
+bool FirebaseJsonBase::mFromCBOR(MB_JSON *e, bool isArray)
+{
+    // only an object for FirebaseJson and an array for FirebaseJsonArray
+    if (!e || !(e->type & (isArray ? MB_JSON_Array : MB_JSON_Object)))
+    {
+        MB_JSON_Delete(e);
+        return false;
+    }
+    root_type = isArray ? Root_Type_JSONArray : Root_Type_JSON;
+    mSetRoot(e);
+    return true;
+}
+
 void FirebaseJsonBase::mSetFloatDigits(uint8_t digits)
 {
     floatDigits = digits;
@@ -676,51 +904,24 @@ int FirebaseJsonBase::mResponseCode()
 
 bool FirebaseJsonBase::mGet(MB_JSON *parent, FirebaseJsonData *result, const char *path, bool prettify)
 {
-    bool ret = false;
     prepareRoot();
-    MB_VECTOR<MB_String> keys = MB_VECTOR<MB_String>();
-    makeList(path, keys, '/');
+    MB_JSON *data = findElement(parent, path, NULL);
 
-    if (keys.size() > 0)
-    {
-        if (isArrayKey(keys[0].c_str()) && root_type == Root_Type_JSON)
-        {
-            clearList(keys);
-            return false;
-        }
-    }
-
-    MB_JSON *_parent = parent;
-    struct search_result_t r;
-    searchElements(keys, parent, r);
-    _parent = r.parent;
+    if (data == NULL)
+        return false;
 
-    if (r.status == key_status_existed)
+    if (result != NULL)
     {
-        MB_JSON *data = NULL;
-        if (isArray(_parent))
-            data = MB_JSON_GetArrayItem(_parent, getArrIndex(keys[r.stopIndex].c_str()));
-        else
-            data = MB_JSON_GetObjectItemCaseSensitive(_parent, keys[r.stopIndex].c_str());
-
-        if (data != NULL)
-        {
-            if (result != NULL)
-            {
-                result->clear();
-                char *p = prettify ? MB_JSON_Print(data) : MB_JSON_PrintUnformatted(data);
-                result->stringValue = p;
-                MB_JSON_free(p);
-                result->type_num = data->type;
-                result->success = true;
-                mSetElementType(result);
-            }
-            ret = true;
-        }
+        result->clear();
+        char *p = prettify ? MB_JSON_Print(data) : MB_JSON_PrintUnformatted(data);
+        result->stringValue = p;
+        MB_JSON_free(p);
+        result->type_num = data->type;
+        result->success = true;
+        mSetElementType(result);
     }
 
-    clearList(keys);
-    return ret;
+    return true;
 }
 
 void FirebaseJsonBase::mSetResInt(FirebaseJsonData *data, const char *value)
@@ -743,10 +944,15 @@ void FirebaseJsonBase::mSetResInt(FirebaseJsonData *data, const char *value)
 
 void FirebaseJsonBase::mSetResFloat(FirebaseJsonData *data, const char *value)
 {
-    if (strlen(value) > 0)
+    size_t len = strlen(value);
+    if (len > 0)
     {
+        // strings that are not plain JSON numbers keep the strtod conversion
+        double number = 0;
         char *pEnd;
-        data->fVal.setd(strtod(value, &pEnd));
+        if (MB_JSON_ParseNumber(value, len, &number) != len)
+            number = strtod(value, &pEnd);
+        data->fVal.setd(number);
     }
     else
         data->fVal.setd(0);
@@ -757,7 +963,7 @@ void FirebaseJsonBase::mSetResFloat(FirebaseJsonData *data, const char *value)
 
 void FirebaseJsonBase::mSetElementType(FirebaseJsonData *result)
 {
-    char *buf = (char *)newP(32);
+    char buf[32] = {0};
     if (result->type_num == MB_JSON_Invalid)
     {
         strcpy(buf, (const char *)MBSTRING_FLASH_MCR("undefined"));
@@ -835,12 +1041,28 @@ void FirebaseJsonBase::mSetElementType(FirebaseJsonData *result)
     }
 
     result->type = buf;
-    delP(&buf);
 }
 
 void FirebaseJsonBase::mSet(const char *path, MB_JSON *value)
 {
     prepareRoot();
+    mIteratorRestart();
+
+    // replace an existing element without splitting the path
+    MB_JSON *parent = NULL;
+    MB_JSON *e = findElement(root, path, &parent);
+    if (e != NULL)
+    {
+        if (value == NULL)
+            value = MB_JSON_CreateNull();
+
+        if (isArray(parent))
+            MB_JSON_ReplaceItemViaPointer(parent, e, value);
+        else
+            MB_JSON_ReplaceItemInObjectCaseSensitive(parent, e->string, value);
+        return;
+    }
+
     MB_VECTOR<MB_String> keys = MB_VECTOR<MB_String>();
     makeList(path, keys, '/');
 
@@ -854,7 +1076,7 @@ void FirebaseJsonBase::mSet(const char *path, MB_JSON *value)
         }
     }
 
-    MB_JSON *parent = root;
+    parent = root;
     struct search_result_t r;
     searchElements(keys, parent, r);
     parent = r.parent;
@@ -907,6 +1129,7 @@ FirebaseJson::~FirebaseJson()
 FirebaseJson &FirebaseJson::nAdd(const char *key, MB_JSON *value)
 {
     prepareRoot();
+    mIteratorRestart();
     MB_VECTOR<MB_String> keys = MB_VECTOR<MB_String>();
     // makeList(key, keys, '/');
     MB_String ky = key;
@@ -958,6 +1181,7 @@ FirebaseJsonArray &FirebaseJsonArray::nAdd(MB_JSON *value)
     root_type = Root_Type_JSONArray;
 
     prepareRoot();
+    mIteratorRestart();
 
     if (value == NULL)
         value = MB_JSON_CreateNull();
@@ -999,6 +1223,7 @@ bool FirebaseJsonArray::mSetIdx(int index, MB_JSON *value)
     root_type = Root_Type_JSONArray;
 
     prepareRoot();
+    mIteratorRestart();
 
     int size = MB_JSON_GetArraySize(root);
     if (index < size)
@@ -1017,6 +1242,7 @@ bool FirebaseJsonArray::mSetIdx(int index, MB_JSON *value)
 
 bool FirebaseJsonArray::mRemoveIdx(int index)
 {
+    mIteratorRestart();
     int size = MB_JSON_GetArraySize(root);
     if (index < size)
     {
@@ -1034,6 +1260,7 @@ FirebaseJsonArray &FirebaseJsonArray::clear()
 
 FirebaseJsonArray &FirebaseJsonArray::add(FirebaseJson &value)
 {
+    fb_js::arena_scope_t scope(mArena());
     MB_JSON *e = MB_JSON_Duplicate(value.root, true);
     nAdd(e);
     return *this;
@@ -1041,6 +1268,7 @@ FirebaseJsonArray &FirebaseJsonArray::add(FirebaseJson &value)
 
 FirebaseJsonArray &FirebaseJsonArray::add(FirebaseJsonArray &value)
 {
+    fb_js::arena_scope_t scope(mArena());
     MB_JSON *e = MB_JSON_Duplicate(value.root, true);
     nAdd(e);
     return *this;
@@ -1065,6 +1293,8 @@ bool FirebaseJsonData::getArray(FirebaseJsonArray &jsonArray)
 bool FirebaseJsonData::mGetArray(const char *source, FirebaseJsonArray &jsonArray)
 {
 
+    fb_js::arena_scope_t scope(jsonArray.mArena());
+
     if (jsonArray.root != NULL)
         MB_JSON_Delete(jsonArray.root);
 
@@ -1082,6 +1312,8 @@ bool FirebaseJsonData::getJSON(FirebaseJson &json)
 
 bool FirebaseJsonData::mGetJSON(const char *source, FirebaseJson &json)
 {
+    fb_js::arena_scope_t scope(json.mArena());
+
     if (json.root != NULL)
         MB_JSON_Delete(json.root);
 
@@ -1159,4 +1391,251 @@ void FirebaseJsonData::clear()
     success = false;
 }
 
+int FirebaseJsonRecord::mAdd(MB_String &path)
+{
+    if (path.length() == 0)
+        return -1;
+
+    slot_t slot;
+    slot.path = path;
+    slot.value = (const char *)MBSTRING_FLASH_MCR("null");
+    slots.push_back(slot);
+    built = false;
+    return (int)slots.size() - 1;
+}
+
+MB_String *FirebaseJsonRecord::mValue(int slot, bool isString)
+{
+    if (slot < 0 || slot >= (int)slots.size())
+        return NULL;
+
+    // the capacity of the previous value is kept for this one
+    slots[slot].value.clear();
+    slots[slot].isString = isString;
+    return &slots[slot].value;
+}
+
+void FirebaseJsonRecord::mValueSet(int slot)
+{
+    slot_t &s = slots[slot];
+    if (!s.isString)
+    {
+        s.length = s.value.length();
+        return;
+    }
+
+    // the same escapes as putString
+    size_t length = 2;
+    for (const char *p = s.value.c_str(); *p; p++)
+    {
+        if (*p == '"' || *p == '\\' || *p == '\b' || *p == '\f' || *p == '\n' || *p == '\r' || *p == '\t')
+            length += 2;
+        else if ((unsigned char)*p < ' ')
+            length += 6;
+        else
+            length++;
+    }
+    s.length = length;
+}
+
+FirebaseJsonRecord &FirebaseJsonRecord::mSetFloat(int slot, double value, uint8_t digits)
+{
+    MB_String *v = mValue(slot, false);
+    if (v)
+    {
+        // NaN and Infinity have no JSON form
+        if (value != value || value - value != 0)
+            *v += (const char *)MBSTRING_FLASH_MCR("null");
+        else
+            v->appendNum(value, digits);
+        mValueSet(slot);
+    }
+    return *this;
+}
+
+bool FirebaseJsonRecord::mBuild()
+{
+    // the values are raw markers that print as is, while the same bytes in keys would be escaped
+    FirebaseJson json;
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+        MB_String marker;
+        marker += '\x01';
+        marker += i;
+        marker += '\x02';
+        json.mSet(slots[i].path.c_str(), MB_JSON_CreateRaw(marker.c_str()));
+    }
+
+    MB_String text;
+    if (!json.toString(text))
+        return false;
+
+    skeleton.clear();
+    parts.clear();
+    const char *s = text.c_str();
+    while (*s)
+    {
+        if (*s == '\x01')
+        {
+            part_t part;
+            part.offset = skeleton.length();
+            part.slot = (size_t)strtoul(s + 1, (char **)&s, 10);
+            parts.push_back(part);
+        }
+        else
+            skeleton += *s;
+        s++;
+    }
+
+    built = true;
+    return true;
+}
+
+void FirebaseJsonRecord::put(output_t &out, const char *data, size_t length)
+{
+    while (length > 0 && out.ok)
+    {
+        // one byte is kept for the '\0' the writers expect behind the data
+        if (out.len == out.size - 1)
+        {
+            out.buf[out.len] = '\0';
+            out.ok = out.write(out.buf, out.len, out.target);
+            out.len = 0;
+        }
+
+        size_t n = out.size - 1 - out.len;
+        if (n > length)
+            n = length;
+        memcpy(out.buf + out.len, data, n);
+        out.len += n;
+        data += n;
+        length -= n;
+    }
+}
+
+void FirebaseJsonRecord::putString(output_t &out, const char *str)
+{
+    static const char hex[] = "0123456789abcdef";
+    char esc[6] = {'\\', 'u', '0', '0', 0, 0};
+
+    put(out, "\"", 1);
+    while (*str)
+    {
+        // the run of characters that need no escape
+        const char *p = str;
+        while ((unsigned char)*p >= ' ' && *p != '"' && *p != '\\')
+            p++;
+        put(out, str, p - str);
+        if (!*p)
+            break;
+
+        switch (*p)
+        {
+        case '"':
+        case '\\':
+            esc[1] = *p;
+            put(out, esc, 2);
+            break;
+        case '\b':
+            put(out, "\\b", 2);
+            break;
+        case '\f':
+            put(out, "\\f", 2);
+            break;
+        case '\n':
+            put(out, "\\n", 2);
+            break;
+        case '\r':
+            put(out, "\\r", 2);
+            break;
+        case '\t':
+            put(out, "\\t", 2);
+            break;
+        default:
+            esc[1] = 'u';
+            esc[4] = hex[(unsigned char)*p >> 4];
+            esc[5] = hex[*p & 0xf];
+            put(out, esc, 6);
+            break;
+        }
+        str = p + 1;
+    }
+    put(out, "\"", 1);
+}
+
+bool FirebaseJsonRecord::printTo(MB_JSON_Writer writer, void *target)
+{
+    if (!built && !mBuild())
+        return false;
+
+    char chunk[FIREBASEJSON_PRINT_BUFFER_SIZE];
+    output_t out = {chunk, sizeof(chunk), 0, writer, target, true};
+    const char *s = skeleton.c_str();
+    size_t pos = 0;
+
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        put(out, s + pos, parts[i].offset - pos);
+        pos = parts[i].offset;
+
+        slot_t &slot = slots[parts[i].slot];
+        if (slot.isString)
+            putString(out, slot.value.c_str());
+        else
+            put(out, slot.value.c_str(), slot.value.length());
+    }
+    put(out, s + pos, skeleton.length() - pos);
+
+    if (out.ok && out.len > 0)
+    {
+        out.buf[out.len] = '\0';
+        out.ok = writer(out.buf, out.len, target);
+    }
+    return out.ok;
+}
+
+size_t FirebaseJsonRecord::serializedBufferLength()
+{
+    if (!built && !mBuild())
+        return 0;
+
+    // the lengths of the values are kept as they are set, so nothing is formatted here
+    size_t length = skeleton.length();
+    for (size_t i = 0; i < parts.size(); i++)
+        length += slots[parts[i].slot].length;
+    return length + 1;
+}
+
+struct fb_js_bounded_t
+{
+    char *p;
+    size_t left;
+};
+
+static MB_JSON_bool fb_js_bounded_writer(const char *data, size_t length, void *target)
+{
+    fb_js_bounded_t *b = reinterpret_cast<fb_js_bounded_t *>(target);
+    if (length >= b->left)
+        return false;
+    memcpy(b->p, data, length + 1);
+    b->p += length;
+    b->left -= length;
+    return true;
+}
+
+size_t FirebaseJsonRecord::toString(char *out, size_t size)
+{
+    if (!out || size == 0)
+        return 0;
+
+    *out = '\0';
+    fb_js_bounded_t b = {out, size};
+    if (!printTo(fb_js_bounded_writer, &b))
+    {
+        *out = '\0';
+        return 0;
+    }
+    return size - b.left;
+}
+
 #endif
\ No newline at end of file
@@ -132,6 +132,14 @@
 #define MB_STRING_USE_PSRAM
 #endif
 
+#if !defined(FIREBASEJSON_PRINT_BUFFER_SIZE)
+#define FIREBASEJSON_PRINT_BUFFER_SIZE 128
+#endif
+
+#if defined(FIREBASEJSON_STRING_INLINE_SIZE) && !defined(MB_STRING_INLINE_SIZE)
+#define MB_STRING_INLINE_SIZE FIREBASEJSON_STRING_INLINE_SIZE
+#endif
+
 #include "MB_String.h"
 
 using namespace mb_string;
@@ -203,6 +211,7 @@ static const char fb_json_str_9[] PROGMEM = "Location: ";
 class FirebaseJson;
 class FirebaseJsonArray;
 class FirebaseJsonData;
+class FirebaseJsonRecord;
 
 static size_t getReservedLen(size_t len)
 {
@@ -307,13 +316,27 @@ namespace fb_js
         MB_String transferEnc;
     };
 
+    // Allocates from the arena (or the heap when NULL) while in scope
+    struct arena_scope_t
+    {
+        MB_JSON_Arena *prev = NULL;
+        arena_scope_t(MB_JSON_Arena *arena) { prev = MB_JSON_ArenaSelect(arena); }
+        ~arena_scope_t() { MB_JSON_ArenaSelect(prev); }
+    };
+
     struct serial_data_t
     {
-        int pos = -1, start = -1, end = -1;
-        int scnt = 0, ecnt = 0;
-        MB_String buf;
+        int pos = -1, start = -1;
+        MB_JSON_Stream *parser = NULL;
         unsigned long dataTime = 0;
     };
+
+    // A node name of a path, pointing into the path string
+    struct path_token_t
+    {
+        const char *str = NULL;
+        size_t len = 0;
+    };
 };
 
 class FirebaseJsonData
@@ -557,6 +580,7 @@ class FirebaseJsonBase
     friend class FirebaseJson;
     friend class FirebaseJsonArray;
     friend class FirebaseJsonData;
+    friend class FirebaseJsonRecord;
 
 private:
     typedef enum
@@ -582,26 +606,23 @@ private:
         int stopIndex = 0;
     };
 
-    struct iterator_result_t
+    struct iterator_frame_t
     {
-        uint16_t ofs1 = 0;
-        uint8_t len1 = 0;
-        uint8_t ofs2 = 0;
-        uint16_t len2 = 0;
-        uint8_t type = 0;
-        int16_t depth = -1;
+        MB_JSON *next = NULL;
+        // the items of an array, where only the values that are not arrays or objects are listed
+        bool elements = false;
     };
 
     struct iterator_data_t
     {
-        MB_VECTOR<struct iterator_result_t> result;
-        int buf_offset = 0;
-        size_t buf_size = 0;
+        // the siblings left to visit at each level, innermost last
+        MB_VECTOR<struct iterator_frame_t> stack;
         int depth = -1;
-        int _depth = 0;
         MB_JSON *parent = NULL;
-        MB_JSON *parentArr = NULL;
-        MB_String path;
+        // the last listed value, its index and depth
+        MB_JSON *item = NULL;
+        size_t index = 0;
+        int itemDepth = -1;
     };
 
     struct fb_js_iterator_value_t
@@ -618,8 +639,10 @@ private:
     void prepareRoot();
     MB_JSON *parse(const char *raw);
     void searchElements(MB_VECTOR<MB_String> &keys, MB_JSON *parent, struct search_result_t &r);
+    bool nextPathToken(const char *&path, struct fb_js::path_token_t &token);
+    MB_JSON *findElement(MB_JSON *parent, const char *path, MB_JSON **owner);
     MB_JSON *getElement(MB_JSON *parent, const char *key, struct search_result_t &r);
-    void mAdd(MB_VECTOR<MB_String> keys, MB_JSON **parent, int beginIndex, MB_JSON *value);
+    void mAdd(MB_VECTOR<MB_String> &keys, MB_JSON **parent, int beginIndex, MB_JSON *value);
     void makeList(const MB_String &str, MB_VECTOR<MB_String> &keys, char delim);
     void pushLish(const MB_String &str, MB_VECTOR<MB_String> &keys);
     void clearList(MB_VECTOR<MB_String> &keys);
@@ -631,8 +654,9 @@ private:
     void replace(MB_VECTOR<MB_String> &keys, struct search_result_t &r, MB_JSON *parent, MB_JSON *item);
     size_t mIteratorBegin(MB_JSON *parent);
     size_t mIteratorBegin(MB_JSON *parent, MB_VECTOR<MB_String> *keys);
-    void mCollectIterator(MB_JSON *e, int type, int &arrIndex);
-    void mIterate(MB_JSON *parent, int &arrIndex);
+    void mIteratorRestart();
+    void mIteratorPush(MB_JSON *e, bool elements);
+    MB_JSON *mIteratorNext(int &depth);
     int mIteratorGet(size_t index, int &type, String &key, String &value);
     struct fb_js_iterator_value_t mValueAt(size_t index);
     void toBuf(fb_json_serialize_mode mode);
@@ -643,8 +667,11 @@ private:
 #endif
     const char *mRaw();
     bool mRemove(const char *path);
-    void mGetPath(MB_String &path, MB_VECTOR<MB_String> paths, int begin = 0, int end = -1);
+    void mGetPath(MB_String &path, MB_VECTOR<MB_String> &paths, int begin = 0, int end = -1);
     size_t mGetSerializedBufferLength(bool prettify);
+    size_t mGetCBORLength();
+    size_t mToCBOR(uint8_t *out, size_t size);
+    bool mFromCBOR(MB_JSON *e, bool isArray);
     void mSetFloatDigits(uint8_t digits);
     void mSetDoubleDigits(uint8_t digits);
     int mResponseCode();
@@ -654,6 +681,12 @@ private:
     void mSetElementType(FirebaseJsonData *result);
     void mSet(const char *path, MB_JSON *value);
     void mCopy(FirebaseJsonBase &other);
+    bool mEqual(const MB_JSON *a, const MB_JSON *b);
+    size_t mDiff(MB_JSON *from, MB_JSON *to, MB_String &path, MB_JSON *update);
+    size_t mGetUpdate(FirebaseJsonBase &from, FirebaseJsonBase &update);
+    void mSetRoot(MB_JSON *e);
+    MB_JSON_Arena *mArena();
+    bool mSetArenaSize(size_t size);
 #if defined(__AVR__)
     unsigned long long strtoull_alt(const char *s);
 #endif
@@ -701,6 +734,8 @@ protected:
     fb_json_root_type root_type = Root_Type_JSON;
     struct iterator_data_t iterator_data;
     MB_JSON *root = NULL;
+    MB_JSON_Arena *arena = NULL;
+    size_t arenaSize = 0;
     MB_JSON_Hooks *hooks = NULL;
     MB_String buf;
 
@@ -750,6 +785,66 @@ protected:
         return (const char *)out;
     }
 
+    // Serializes through a buffer on the stack, handing every full buffer to the writer
+    bool printTo(MB_JSON_Writer writer, void *target, bool prettify)
+    {
+        char chunk[FIREBASEJSON_PRINT_BUFFER_SIZE];
+        return MB_JSON_PrintToWriter(root, prettify, chunk, sizeof(chunk), writer, target);
+    }
+
+    bool cborTo(MB_JSON_Writer writer, void *target)
+    {
+        char chunk[FIREBASEJSON_PRINT_BUFFER_SIZE];
+        return root && MB_JSON_PrintCBORToWriter(root, chunk, sizeof(chunk), writer, target);
+    }
+
+    template <typename T>
+    static size_t streamReader(unsigned char *data, size_t length, void *source)
+    {
+        return reinterpret_cast<T *>(source)->readBytes(reinterpret_cast<char *>(data), length);
+    }
+
+#if defined(ESP32_SD_FAT_INCLUDED)
+    static size_t sdFatReader(unsigned char *data, size_t length, void *source)
+    {
+        int n = reinterpret_cast<SD_FAT_FILE *>(source)->read(data, length);
+        return n > 0 ? (size_t)n : 0;
+    }
+#endif
+
+    static MB_JSON_bool copyWriter(const char *data, size_t length, void *target)
+    {
+        char **p = reinterpret_cast<char **>(target);
+        memcpy(*p, data, length + 1);
+        *p += length;
+        return true;
+    }
+
+    template <typename T>
+    static auto appendChars(T &out, const char *data, size_t length) -> typename std::enable_if<is_std_string<T>::value || is_mb_string<T>::value, bool>::type
+    {
+        out.append(data, length);
+        return true;
+    }
+
+    template <typename T>
+    static auto appendChars(T &out, const char *data, size_t length) -> typename std::enable_if<is_arduino_string<T>::value || is_arduino_string_sum_helper<T>::value, bool>::type
+    {
+        return out.concat(data, length);
+    }
+
+    template <typename T>
+    static MB_JSON_bool appendWriter(const char *data, size_t length, void *target)
+    {
+        return appendChars(*reinterpret_cast<T *>(target), data, length);
+    }
+
+    template <typename T>
+    static MB_JSON_bool streamWriter(const char *data, size_t length, void *target)
+    {
+        return reinterpret_cast<T *>(target)->write((const uint8_t *)data, length) == length;
+    }
+
     template <typename T>
     bool toStringPtrHandler(T *ptr, bool prettify)
     {
@@ -758,13 +853,9 @@ protected:
 
         if (std::is_same<T, char>::value)
         {
-            char *p = prettify ? MB_JSON_Print(root) : MB_JSON_PrintUnformatted(root);
-            if (p)
-            {
-                strcpy(ptr, p);
-                MB_JSON_free(p);
-                return true;
-            }
+            char *p = (char *)ptr;
+            *p = '\0';
+            return printTo(copyWriter, &p, prettify);
         }
         return false;
     }
@@ -775,27 +866,16 @@ protected:
         if (!root)
             return false;
 
-        char *p = prettify ? MB_JSON_Print(root) : MB_JSON_PrintUnformatted(root);
-        if (p)
-        {
-            out = p;
-            MB_JSON_free(p);
-            return true;
-        }
-        return false;
+        // sized once, so appending the pieces never grows the string
+        out = "";
+        out.reserve(MB_JSON_SerializedBufferLength(root, prettify));
+        return printTo(appendWriter<T>, &out, prettify);
     }
 
     template <typename T>
     auto toStringHandler(T &out, bool prettify) -> typename std::enable_if<std::is_same<T, MB_SERIAL_CLASS>::value, bool>::type
     {
-        char *p = prettify ? MB_JSON_Print(root) : MB_JSON_PrintUnformatted(root);
-        if (p)
-        {
-            out.print(p);
-            MB_JSON_free(p);
-            return true;
-        }
-        return false;
+        return writeStream(out, prettify);
     }
 
     template <typename T>
@@ -823,20 +903,10 @@ protected:
     template <typename T>
     bool writeStream(T &out, bool prettify)
     {
-        bool ret = false;
-
         if (!root)
             return false;
 
-        char *p = prettify ? MB_JSON_Print(root) : MB_JSON_PrintUnformatted(root);
-        if (p)
-        {
-            ret = out.write((const uint8_t *)p, strlen(p)) == strlen(p);
-            MB_JSON_free(p);
-            return ret;
-        }
-
-        return ret;
+        return printTo(streamWriter<T>, &out, prettify);
     }
 
     void idle()
@@ -1138,7 +1208,7 @@ protected:
         int idx = 0;
         if (!stream)
             return idx;
-        while (stream->available() && idx <= bufLen)
+        while (stream->available() && idx < bufLen)
         {
             if (!stream)
                 break;
@@ -1146,8 +1216,7 @@ protected:
             if (res > -1)
             {
                 c = (char)res;
-                strcat_c(buf, c);
-                idx++;
+                buf[idx++] = c;
                 if (c == '\n')
                     return idx;
             }
@@ -1332,7 +1401,7 @@ protected:
         return olen;
     }
 
-    int readClient(Client *client, MB_String &buf)
+    int readClient(Client *client, MB_JSON_Stream *parser)
     {
         int ret = -1;
 
@@ -1352,6 +1421,7 @@ protected:
         int chunkedDataSize = 0;
         int chunkedDataLen = 0;
         int payloadRead = 0;
+        int parseState = MB_JSON_StreamMore;
 
         int defaultChunkSize = 2048;
         unsigned long dataTime = millis();
@@ -1426,7 +1496,7 @@ protected:
 
                                 if (headerEnded)
                                 {
-                                    buf.clear();
+                                    MB_JSON_StreamReset(parser);
                                     // parse header string to get the header field
                                     isHeader = false;
                                     parseRespHeader(header, response);
@@ -1468,12 +1538,14 @@ protected:
                                     if (availablePayload > 0)
                                     {
                                         payloadRead += availablePayload;
-                                        buf += pChunk;
+                                        // parse as it arrives, the payload is never held as a whole
+                                        if (parseState == MB_JSON_StreamMore)
+                                            parseState = MB_JSON_StreamFeed(parser, pChunk, strlen(pChunk), NULL);
                                     }
 
                                     delP(&pChunk);
 
-                                    if (availablePayload < 0 || (payloadRead >= response.contentLen && !response.isChunkedEnc))
+                                    if (availablePayload < 0 || parseState == MB_JSON_StreamError || (payloadRead >= response.contentLen && !response.isChunkedEnc))
                                     {
                                         while (client->available() > 0)
                                             client->read();
@@ -1515,73 +1587,49 @@ protected:
 
     void clearSerialData(struct fb_js::serial_data_t &data)
     {
-        data.buf.clear();
+        // keep the parser and its buffers for the next value
+        MB_JSON_StreamReset(data.parser);
         data.start = -1;
-        data.end = -1;
         data.pos = -1;
-        data.scnt = 0;
-        data.ecnt = 0;
         data.dataTime = millis();
     }
 
-    bool readStreamChar(int r, struct fb_js::serial_data_t &data, MB_String &buf, bool isJson)
+    bool readStreamChar(int r, struct fb_js::serial_data_t &data, bool isJson)
     {
-        bool ret = false;
         if (r > -1)
         {
             data.pos++;
 
-            if (isJson)
-            {
-                if ((char)r == '{')
-                {
-                    data.scnt++;
-                    data.start = data.pos;
-                }
-                else if ((char)r == '}')
-                {
-                    data.ecnt++;
-                    data.end = data.pos;
-                }
-            }
-            else
+            char c = (char)r;
+
+            // skip anything before the opening brace or bracket
+            if (data.start == -1)
             {
-                if ((char)r == '[')
-                {
-                    data.scnt++;
-                    data.start = data.pos;
-                }
-                else if ((char)r == ']')
-                {
-                    data.ecnt++;
-                    data.end = data.pos;
-                }
-            }
+                if (c != (isJson ? '{' : '['))
+                    return false;
 
-            if (data.scnt > 0)
-                data.buf += (char)r;
+                if (!data.parser)
+                    data.parser = MB_JSON_StreamCreate();
 
-            if (data.scnt == data.ecnt && data.scnt > 0)
-            {
-                bool ret = false;
-                if (data.end > data.start)
-                {
-                    buf = data.buf.c_str();
-                    ret = true;
-                }
+                if (!data.parser)
+                    return false;
 
-                clearSerialData(data);
-                return ret;
+                data.start = data.pos;
             }
 
-            if (data.ecnt > data.scnt)
+            int state = MB_JSON_StreamFeed(data.parser, &c, 1, NULL);
+
+            // resync on the next value
+            if (state == MB_JSON_StreamError)
                 clearSerialData(data);
+
+            return state == MB_JSON_StreamDone;
         }
 
-        return ret;
+        return false;
     }
 
-    bool readStream(Stream *s, struct fb_js::serial_data_t &data, MB_String &buf, bool isJson, int timeoutMS)
+    bool readStream(Stream *s, struct fb_js::serial_data_t &data, bool isJson, int timeoutMS)
     {
 
         bool ret = false;
@@ -1598,13 +1646,9 @@ protected:
         {
             idle();
             int r = s->read();
-            ret = readStreamChar(r, data, buf, isJson);
+            ret = readStreamChar(r, data, isJson);
             if (ret)
-            {
-                if (timeoutMS == -1)
-                    clearSerialData(data);
                 return true;
-            }
         }
 
         return ret;
@@ -1612,7 +1656,7 @@ protected:
 
 #if defined(ESP32_SD_FAT_INCLUDED)
 
-    bool readSdFatFile(SD_FAT_FILE &file, struct fb_js::serial_data_t &data, MB_String &buf, bool isJson, int timeoutMS)
+    bool readSdFatFile(SD_FAT_FILE &file, struct fb_js::serial_data_t &data, bool isJson, int timeoutMS)
     {
 
         bool ret = false;
@@ -1629,13 +1673,9 @@ protected:
         {
             idle();
             int r = file.read();
-            ret = readStreamChar(r, data, buf, isJson);
+            ret = readStreamChar(r, data, isJson);
             if (ret)
-            {
-                if (timeoutMS == -1)
-                    clearSerialData(data);
                 return true;
-            }
         }
 
         return ret;
@@ -1760,7 +1800,11 @@ public:
      *
      * @return instance of an object.
      */
-    FirebaseJsonArray &add() { return nAdd(MB_JSON_CreateNull()); }
+    FirebaseJsonArray &add()
+    {
+        fb_js::arena_scope_t scope(mArena());
+        return nAdd(MB_JSON_CreateNull());
+    }
 
     /**
      * Add value to FirebaseJsonArray object.
@@ -1773,7 +1817,11 @@ public:
      * boolean, FirebaseJson object and array.
      */
     template <typename T>
-    FirebaseJsonArray &add(T value) { return dataAddHandler(value); }
+    FirebaseJsonArray &add(T value)
+    {
+        fb_js::arena_scope_t scope(mArena());
+        return dataAddHandler(value);
+    }
 
     FirebaseJsonArray &add(FirebaseJson &value);
 
@@ -1790,7 +1838,10 @@ public:
     template <typename First, typename... Next>
     FirebaseJsonArray &add(First v, Next... n)
     {
-        dataAddHandler(v);
+        {
+            fb_js::arena_scope_t scope(mArena());
+            dataAddHandler(v);
+        }
         return add(n...);
     }
 
@@ -1865,7 +1916,7 @@ public:
     }
 
     /**
-     * Parse and collect all node/array elements in FirebaseJsonArray object.
+     * Count all node/array elements in FirebaseJsonArray object, iteratorGet walks to them on demand.
      * @return number of child/array elements in FirebaseJson object.
      */
     size_t iteratorBegin(const char *data = NULL) { return mIteratorBegin(root); }
@@ -1942,6 +1993,66 @@ public:
      */
     size_t serializedBufferLength(bool prettify = false) { return mGetSerializedBufferLength(prettify); }
 
+    /**
+     * Serialize the FirebaseJsonArray object as CBOR (RFC 8949), the compact binary form of the same data.
+     *
+     * @param out The Stream, File or Client that takes the bytes.
+     * @return boolean status of the operation.
+     */
+    bool toCBOR(Stream &out) { return cborTo(streamWriter<Stream>, &out); }
+
+    /**
+     * Serialize the FirebaseJsonArray object as CBOR into a buffer.
+     *
+     * @param out The buffer to write to.
+     * @param size The size of the buffer.
+     * @return the number of bytes written, 0 when the buffer is too small (see cborLength).
+     */
+    size_t toCBOR(uint8_t *out, size_t size) { return mToCBOR(out, size); }
+
+    /**
+     * Get the size of the CBOR serialized array
+     * @return size in byte of the CBOR data
+     */
+    size_t cborLength() { return mGetCBORLength(); }
+
+    /**
+     * Set or deserialize the FirebaseJsonArray object from CBOR data, which holds a JSON array.
+     *
+     * @param data The CBOR data.
+     * @param length The length of the data.
+     * @return boolean status of the operation, the current data is kept on failure.
+     *
+     * @note Byte strings and map keys other than text have no JSON form and fail the operation.
+     */
+    bool fromCBOR(const uint8_t *data, size_t length) { return mFromCBOR(MB_JSON_ParseCBOR(data, length, NULL), true); }
+
+    /**
+     * Set or deserialize the FirebaseJsonArray object from CBOR data read from Stream, File or Client.
+     *
+     * @param in The Stream, File or Client to read from, the read ends with its timeout.
+     * @return boolean status of the operation, the current data is kept on failure.
+     */
+    bool fromCBOR(Stream &in) { return mFromCBOR(MB_JSON_ParseCBORFromReader(streamReader<Stream>, &in), true); }
+
+#if defined(ESP32_SD_FAT_INCLUDED)
+    /**
+     * Serialize the FirebaseJsonArray object as CBOR to SdFat's SdFile object.
+     *
+     * @param sdFatFile The SdFat file object.
+     * @return boolean status of the operation.
+     */
+    bool toCBOR(SD_FAT_FILE &sdFatFile) { return cborTo(streamWriter<SD_FAT_FILE>, &sdFatFile); }
+
+    /**
+     * Set or deserialize the FirebaseJsonArray object from CBOR data in SdFat's SdFile object.
+     *
+     * @param sdFatFile The SdFat file object.
+     * @return boolean status of the operation, the current data is kept on failure.
+     */
+    bool fromCBOR(SD_FAT_FILE &sdFatFile) { return mFromCBOR(MB_JSON_ParseCBORFromReader(sdFatReader, &sdFatFile), true); }
+#endif
+
     /**
      * Clear all array in FirebaseJsonArray object.
      *
@@ -1955,7 +2066,11 @@ public:
      * @param index_or_path The array index or path that null to be set.
      */
     template <typename T>
-    void set(T index_or_path) { dataSetHandler(index_or_path, nullptr); }
+    void set(T index_or_path)
+    {
+        fb_js::arena_scope_t scope(mArena());
+        dataSetHandler(index_or_path, nullptr);
+    }
 
     /**
      * Set value to FirebaseJsonArray object at the specified index.
@@ -1964,13 +2079,25 @@ public:
      * @param value The value to set.
      */
     template <typename T1, typename T2>
-    void set(T1 index_or_path, T2 value) { dataSetHandler(index_or_path, value); }
+    void set(T1 index_or_path, T2 value)
+    {
+        fb_js::arena_scope_t scope(mArena());
+        dataSetHandler(index_or_path, value);
+    }
 
     template <typename T>
-    void set(T index_or_path, FirebaseJson &value) { return dataSetHandler(index_or_path, value); }
+    void set(T index_or_path, FirebaseJson &value)
+    {
+        fb_js::arena_scope_t scope(mArena());
+        dataSetHandler(index_or_path, value);
+    }
 
     template <typename T>
-    void set(T index_or_path, FirebaseJsonArray &value) { return dataSetHandler(index_or_path, value); }
+    void set(T index_or_path, FirebaseJsonArray &value)
+    {
+        fb_js::arena_scope_t scope(mArena());
+        dataSetHandler(index_or_path, value);
+    }
 
     /**
      * Remove the array value at the specified index or path from the FirebaseJsonArray object.
@@ -2007,6 +2134,17 @@ public:
      */
     int responseCode() { return mResponseCode(); }
 
+    /**
+     * Allocate the JSON array data from a single block of memory instead of the heap.
+     * @param size The size of the block in bytes, 0 to allocate from the heap again.
+     * @return boolean status of the operation.
+     *
+     * @note The block is taken from PSRAM when available (FIREBASEJSON_USE_PSRAM).
+     * Clearing or replacing the data frees the block at once, which avoids fragmenting the heap when
+     * the same object is rebuilt over and over. Once the block is full, the data goes to the heap.
+     */
+    bool setArenaSize(size_t size) { return mSetArenaSize(size); }
+
 private:
     FirebaseJsonArray &nAdd(MB_JSON *value);
     bool mSetIdx(int index, MB_JSON *value);
@@ -2370,6 +2508,7 @@ public:
     template <typename T>
     FirebaseJson &add(T key)
     {
+        fb_js::arena_scope_t scope(mArena());
         uint32_t addr = 0;
         nAdd(getStr(key, addr), NULL);
         delAddr(addr);
@@ -2386,6 +2525,7 @@ public:
     template <typename T1, typename T2>
     FirebaseJson &add(T1 key, T2 value)
     {
+        fb_js::arena_scope_t scope(mArena());
         uint32_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_add);
         delAddr(addr);
@@ -2395,6 +2535,7 @@ public:
     template <typename T>
     FirebaseJson &add(T key, FirebaseJson &value)
     {
+        fb_js::arena_scope_t scope(mArena());
         uint32_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_add);
         delAddr(addr);
@@ -2404,6 +2545,7 @@ public:
     template <typename T>
     FirebaseJson &add(T key, FirebaseJsonArray &value)
     {
+        fb_js::arena_scope_t scope(mArena());
         uint32_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_add);
         delAddr(addr);
@@ -2487,7 +2629,7 @@ public:
     }
 
     /**
-     * Parse and collect all node/array elements in FirebaseJson object.
+     * Count all node/array elements in FirebaseJson object, iteratorGet walks to them on demand.
      *
      * @return number of child/array elements in FirebaseJson object.
      */
@@ -2535,6 +2677,7 @@ public:
     template <typename T>
     void set(T key)
     {
+        fb_js::arena_scope_t scope(mArena());
         uint32_t addr = 0;
         mSet(getStr(key, addr), NULL);
         delAddr(addr);
@@ -2556,6 +2699,7 @@ public:
     template <typename T1, typename T2>
     FirebaseJson &set(T1 key, T2 value)
     {
+        fb_js::arena_scope_t scope(mArena());
         uint32_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_set);
         delAddr(addr);
@@ -2565,6 +2709,7 @@ public:
     template <typename T>
     FirebaseJson &set(T key, FirebaseJson &value)
     {
+        fb_js::arena_scope_t scope(mArena());
         uint32_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_set);
         delAddr(addr);
@@ -2574,12 +2719,25 @@ public:
     template <typename T>
     FirebaseJson &set(T key, FirebaseJsonArray &value)
     {
+        fb_js::arena_scope_t scope(mArena());
         uint32_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_set);
         delAddr(addr);
         return *this;
     }
 
+    /**
+     * Get the update (PATCH) data that changes a database node from the data of another FirebaseJson object to this one.
+     *
+     * @param from The FirebaseJson object with the data the node has now, e.g. a copy of the last data sent.
+     * @param update The FirebaseJson object that keeps the update, the changed values at their paths e.g.
+     * {"sensor/temp":23.5} and null for the removed ones.
+     * @return the number of the changed paths, 0 when there is nothing to update.
+     *
+     * @note Objects are compared by key, arrays and the other values are sent as a whole when they changed.
+     */
+    size_t diff(FirebaseJson &from, FirebaseJson &update) { return mGetUpdate(from, update); }
+
     /**
      * Remove the specified node and its content.
      *
@@ -2615,6 +2773,66 @@ public:
      */
     size_t serializedBufferLength(bool prettify = false) { return mGetSerializedBufferLength(prettify); }
 
+    /**
+     * Serialize the FirebaseJson object as CBOR (RFC 8949), the compact binary form of the same data.
+     *
+     * @param out The Stream, File or Client that takes the bytes.
+     * @return boolean status of the operation.
+     */
+    bool toCBOR(Stream &out) { return cborTo(streamWriter<Stream>, &out); }
+
+    /**
+     * Serialize the FirebaseJson object as CBOR into a buffer.
+     *
+     * @param out The buffer to write to.
+     * @param size The size of the buffer.
+     * @return the number of bytes written, 0 when the buffer is too small (see cborLength).
+     */
+    size_t toCBOR(uint8_t *out, size_t size) { return mToCBOR(out, size); }
+
+    /**
+     * Get the size of the CBOR serialized object
+     * @return size in byte of the CBOR data
+     */
+    size_t cborLength() { return mGetCBORLength(); }
+
+    /**
+     * Set or deserialize the FirebaseJson object from CBOR data, which holds a JSON object.
+     *
+     * @param data The CBOR data.
+     * @param length The length of the data.
+     * @return boolean status of the operation, the current data is kept on failure.
+     *
+     * @note Byte strings and map keys other than text have no JSON form and fail the operation.
+     */
+    bool fromCBOR(const uint8_t *data, size_t length) { return mFromCBOR(MB_JSON_ParseCBOR(data, length, NULL), false); }
+
+    /**
+     * Set or deserialize the FirebaseJson object from CBOR data read from Stream, File or Client.
+     *
+     * @param in The Stream, File or Client to read from, the read ends with its timeout.
+     * @return boolean status of the operation, the current data is kept on failure.
+     */
+    bool fromCBOR(Stream &in) { return mFromCBOR(MB_JSON_ParseCBORFromReader(streamReader<Stream>, &in), false); }
+
+#if defined(ESP32_SD_FAT_INCLUDED)
+    /**
+     * Serialize the FirebaseJson object as CBOR to SdFat's SdFile object.
+     *
+     * @param sdFatFile The SdFat file object.
+     * @return boolean status of the operation.
+     */
+    bool toCBOR(SD_FAT_FILE &sdFatFile) { return cborTo(streamWriter<SD_FAT_FILE>, &sdFatFile); }
+
+    /**
+     * Set or deserialize the FirebaseJson object from CBOR data in SdFat's SdFile object.
+     *
+     * @param sdFatFile The SdFat file object.
+     * @return boolean status of the operation, the current data is kept on failure.
+     */
+    bool fromCBOR(SD_FAT_FILE &sdFatFile) { return mFromCBOR(MB_JSON_ParseCBORFromReader(sdFatReader, &sdFatFile), false); }
+#endif
+
     /**
      * Set the precision for float to JSON object
      * @param digits The number of decimal places.
@@ -2632,6 +2850,17 @@ public:
      */
     int responseCode() { return mResponseCode(); }
 
+    /**
+     * Allocate the JSON object data from a single block of memory instead of the heap.
+     * @param size The size of the block in bytes, 0 to allocate from the heap again.
+     * @return boolean status of the operation.
+     *
+     * @note The block is taken from PSRAM when available (FIREBASEJSON_USE_PSRAM).
+     * Clearing or replacing the data frees the block at once, which avoids fragmenting the heap when
+     * the same object is rebuilt over and over. Once the block is full, the data goes to the heap.
+     */
+    bool setArenaSize(size_t size) { return mSetArenaSize(size); }
+
 private:
     FirebaseJson &nAdd(const char *key, MB_JSON *value);
 
@@ -2769,4 +2998,180 @@ private:
     }
 };
 
+// A fixed layout of values, declared once and printed many times. The JSON text around the values is made once from
+// the paths, printing only formats the values into it, without building a tree.
+class FirebaseJsonRecord
+{
+public:
+    FirebaseJsonRecord(){};
+    ~FirebaseJsonRecord(){};
+
+    /**
+     * Declare a value at the specified node path of the record.
+     *
+     * @param path The relative path as in FirebaseJson.set, e.g. "sensor/temp" or "values/[0]".
+     * @return the slot of the value for set, -1 on failure.
+     *
+     * @note A later path inside or in place of the node of an earlier one replaces it, as FirebaseJson.set does.
+     */
+    template <typename T>
+    auto add(T path) -> typename std::enable_if<is_string<T>::value, int>::type
+    {
+        MB_String p;
+        p += path;
+        return mAdd(p);
+    }
+
+    /**
+     * Set the value of a slot, it stays until set again. The values not set are null.
+     *
+     * @param slot The slot returned by add.
+     * @param value The integer, boolean, floating point number or string value, strings are copied.
+     * @return instance of an object.
+     */
+    template <typename T>
+    auto set(int slot, T value) -> typename std::enable_if<is_num_int<T>::value || is_bool<T>::value, FirebaseJsonRecord &>::type
+    {
+        MB_String *v = mValue(slot, false);
+        if (v)
+        {
+            v->appendNum(value);
+            mValueSet(slot);
+        }
+        return *this;
+    }
+
+    FirebaseJsonRecord &set(int slot, float value) { return mSetFloat(slot, value, floatDigits); }
+
+    FirebaseJsonRecord &set(int slot, double value) { return mSetFloat(slot, value, doubleDigits); }
+
+    template <typename T>
+    auto set(int slot, T value) -> typename std::enable_if<is_string<T>::value, FirebaseJsonRecord &>::type
+    {
+        MB_String *v = mValue(slot, true);
+        if (v)
+        {
+            *v += value;
+            mValueSet(slot);
+        }
+        return *this;
+    }
+
+    /**
+     * Set null to a slot.
+     *
+     * @param slot The slot returned by add.
+     * @return instance of an object.
+     */
+    FirebaseJsonRecord &setNull(int slot)
+    {
+        MB_String *v = mValue(slot, false);
+        if (v)
+        {
+            *v += (const char *)MBSTRING_FLASH_MCR("null");
+            mValueSet(slot);
+        }
+        return *this;
+    }
+
+    /**
+     * Set the precision for float values of the record.
+     * @param digits The number of decimal places.
+     */
+    void setFloatDigits(uint8_t digits) { floatDigits = digits; }
+
+    /**
+     * Set the precision for double values of the record.
+     * @param digits The number of decimal places.
+     */
+    void setDoubleDigits(uint8_t digits) { doubleDigits = digits; }
+
+    /**
+     * Get the record serialized string.
+     *
+     * @param out The object e.g. Serial, String, std::string, Stream, File, Client, that accepts the returning string.
+     * @return boolean status of the operation.
+     */
+    bool toString(Stream &out) { return printTo(FirebaseJsonBase::streamWriter<Stream>, &out); }
+
+    bool toString(String &out) { return toStringHandler(out); }
+
+    bool toString(MB_String &out) { return toStringHandler(out); }
+
+#if !defined(__AVR__)
+    bool toString(std::string &out)
+    {
+        return toStringHandler(out);
+    }
+#endif
+
+    /**
+     * Get the record serialized string into a char array.
+     *
+     * @param out The char array.
+     * @param size The size of the array.
+     * @return the length of the string, 0 when the array is too small (see serializedBufferLength).
+     */
+    size_t toString(char *out, size_t size);
+
+    /**
+     * Get the size of serialized record buffer
+     * @return size in byte of buffer
+     */
+    size_t serializedBufferLength();
+
+private:
+    struct slot_t
+    {
+        MB_String path;
+        // the JSON text of the value, or the string to escape when isString
+        MB_String value;
+        // the length of the value as printed
+        size_t length = 4;
+        bool isString = false;
+    };
+
+    struct part_t
+    {
+        // where the value goes in the skeleton
+        size_t offset = 0;
+        size_t slot = 0;
+    };
+
+    struct output_t
+    {
+        char *buf;
+        size_t size;
+        size_t len;
+        MB_JSON_Writer write;
+        void *target;
+        bool ok;
+    };
+
+    MB_VECTOR<slot_t> slots;
+    MB_VECTOR<part_t> parts;
+    MB_String skeleton;
+    bool built = false;
+    uint8_t floatDigits = 5;
+    uint8_t doubleDigits = 9;
+
+    int mAdd(MB_String &path);
+    MB_String *mValue(int slot, bool isString);
+    void mValueSet(int slot);
+    FirebaseJsonRecord &mSetFloat(int slot, double value, uint8_t digits);
+    bool mBuild();
+    bool printTo(MB_JSON_Writer writer, void *target);
+    void put(output_t &out, const char *data, size_t length);
+    void putString(output_t &out, const char *str);
+
+    template <typename T>
+    bool toStringHandler(T &out)
+    {
+        // sized once, so appending the pieces never grows the string
+        out = "";
+        out.reserve(serializedBufferLength());
+        return printTo(FirebaseJsonBase::appendWriter<T>, &out);
+    }
+};
+
 #endif
\ No newline at end of file
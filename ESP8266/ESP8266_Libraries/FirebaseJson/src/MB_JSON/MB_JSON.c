@@ -55,6 +55,7 @@
 #include <limits.h>
 #include <ctype.h>
 #include <float.h>
+#include <stdint.h>
 
 #ifdef ENABLE_LOCALES
 #include <locale.h>
@@ -223,1187 +224,3923 @@ static unsigned char *MB_JSON_strdup(const unsigned char *string, const MB_JSON_
     return copy;
 }
 
+/* The hooks set with MB_JSON_InitHooks, MB_JSON_global_hooks wraps them while arenas exist */
+static MB_JSON_internal_hooks MB_JSON_heap_hooks = {MB_JSON_internal_malloc, MB_JSON_internal_free, MB_JSON_internal_realloc};
+
+static void MB_JSON_update_hooks(void);
+
 MB_JSON_PUBLIC(void)
 MB_JSON_InitHooks(MB_JSON_Hooks *hooks)
 {
     if (hooks == NULL)
     {
         /* Reset hooks */
-        MB_JSON_global_hooks.allocate = malloc;
-        MB_JSON_global_hooks.deallocate = free;
-        MB_JSON_global_hooks.reallocate = realloc;
+        MB_JSON_heap_hooks.allocate = malloc;
+        MB_JSON_heap_hooks.deallocate = free;
+        MB_JSON_heap_hooks.reallocate = realloc;
+        MB_JSON_update_hooks();
         return;
     }
 
-    MB_JSON_global_hooks.allocate = malloc;
+    MB_JSON_heap_hooks.allocate = malloc;
     if (hooks->malloc_fn != NULL)
     {
-        MB_JSON_global_hooks.allocate = hooks->malloc_fn;
+        MB_JSON_heap_hooks.allocate = hooks->malloc_fn;
     }
 
-    MB_JSON_global_hooks.deallocate = free;
+    MB_JSON_heap_hooks.deallocate = free;
     if (hooks->free_fn != NULL)
     {
-        MB_JSON_global_hooks.deallocate = hooks->free_fn;
+        MB_JSON_heap_hooks.deallocate = hooks->free_fn;
     }
 
     /* use realloc only if both free and malloc are used */
-    MB_JSON_global_hooks.reallocate = hooks->realloc_fn;
-    if ((MB_JSON_global_hooks.allocate == malloc) && (MB_JSON_global_hooks.deallocate == free))
+    MB_JSON_heap_hooks.reallocate = hooks->realloc_fn;
+    if ((MB_JSON_heap_hooks.allocate == malloc) && (MB_JSON_heap_hooks.deallocate == free))
     {
-        MB_JSON_global_hooks.reallocate = realloc;
+        MB_JSON_heap_hooks.reallocate = realloc;
     }
+
+    MB_JSON_update_hooks();
 }
 
-/* Internal constructor. */
-static MB_JSON *MB_JSON_New_Item(const MB_JSON_internal_hooks *const hooks)
+/* Arena allocator
+ *
+ * An arena is a single block that allocations are carved from in order. Freeing only gives the space back when it
+ * is the last allocation, or when nothing in the arena is in use anymore, the rest waits for MB_JSON_ArenaReset.
+ * Allocations go to the selected arena, to the heap when none is selected or when it is full. Pointers of every
+ * arena are recognised when freed, whatever the selected one. */
+
+/* in front of every allocation, also sets the alignment */
+typedef union MB_JSON_arena_header
 {
-    MB_JSON *node = (MB_JSON *)hooks->allocate(sizeof(MB_JSON));
-    if (node)
-    {
-        memset(node, '\0', sizeof(MB_JSON));
-    }
+    size_t size;
+    double align_double;
+    void *align_pointer;
+} MB_JSON_arena_header;
 
-    return node;
-}
+struct MB_JSON_Arena
+{
+    unsigned char *block;
+    size_t size;
+    /* end of the last allocation */
+    size_t used;
+    /* size of the allocations not freed yet */
+    size_t live;
+    MB_JSON_Arena *next;
+};
 
-/* Delete a MB_JSON structure. */
-MB_JSON_PUBLIC(void)
-MB_JSON_Delete(MB_JSON *item)
+static MB_JSON_Arena *MB_JSON_arenas = NULL;
+static MB_JSON_Arena *MB_JSON_selected_arena = NULL;
+
+static MB_JSON_Arena *MB_JSON_arena_of(const void *pointer)
 {
-    MB_JSON *next = NULL;
-    while (item != NULL)
+    MB_JSON_Arena *arena = MB_JSON_arenas;
+    while (arena != NULL)
     {
-        next = item->next;
-        if (!(item->type & MB_JSON_IsReference) && (item->child != NULL))
+        if (((const unsigned char *)pointer >= arena->block) && ((const unsigned char *)pointer < arena->block + arena->size))
         {
-            MB_JSON_Delete(item->child);
-        }
-        if (!(item->type & MB_JSON_IsReference) && (item->valuestring != NULL))
-        {
-            MB_JSON_global_hooks.deallocate(item->valuestring);
+            return arena;
         }
-        if (!(item->type & MB_JSON_StringIsConst) && (item->string != NULL))
-        {
-            MB_JSON_global_hooks.deallocate(item->string);
-        }
-        MB_JSON_global_hooks.deallocate(item);
-        item = next;
+        arena = arena->next;
     }
+    return NULL;
 }
 
-/* get the decimal point character of the current locale */
-static unsigned char MB_JSON_get_decimal_point(void)
+static void *MB_JSON_CDECL MB_JSON_arena_allocate(size_t size)
 {
-#ifdef ENABLE_LOCALES
-    struct lconv *lconv = localeconv();
-    return (unsigned char)lconv->decimal_point[0];
-#else
-    return '.';
-#endif
-}
+    MB_JSON_Arena *arena = MB_JSON_selected_arena;
+    MB_JSON_arena_header *header = NULL;
+    /* header and size rounded up to the alignment */
+    size_t length = (size + 2 * sizeof(MB_JSON_arena_header) - 1) / sizeof(MB_JSON_arena_header) * sizeof(MB_JSON_arena_header);
 
-typedef struct
-{
-    const unsigned char *content;
-    size_t length;
-    size_t offset;
-    size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
-    MB_JSON_internal_hooks hooks;
-} MB_JSON_parse_buffer;
+    if ((arena == NULL) || (length < size) || (length > arena->size - arena->used))
+    {
+        return MB_JSON_heap_hooks.allocate(size);
+    }
 
-/* check if the given size is left to read in a given parse buffer (starting with 1) */
-#define MB_JSON_can_read(buffer, size) ((buffer != NULL) && (((buffer)->offset + size) <= (buffer)->length))
-/* check if the buffer can be accessed at the given index (starting with 0) */
-#define MB_JSON_can_access_at_index(buffer, index) ((buffer != NULL) && (((buffer)->offset + index) < (buffer)->length))
-#define MB_JSON_cannot_access_at_index(buffer, index) (!MB_JSON_can_access_at_index(buffer, index))
-/* get a pointer to the buffer at the position */
-#define MB_JSON_buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
+    header = (MB_JSON_arena_header *)(void *)(arena->block + arena->used);
+    header->size = length;
+    arena->used += length;
+    arena->live += length;
 
-/* Parse the input text to generate a number, and populate the result into item. */
-static MB_JSON_bool MB_JSON_parse_number(MB_JSON *const item, MB_JSON_parse_buffer *const input_buffer)
+    return header + 1;
+}
+
+static void MB_JSON_CDECL MB_JSON_arena_deallocate(void *pointer)
 {
-    double number = 0;
-    unsigned char *after_end = NULL;
-    unsigned char number_c_string[64];
-    unsigned char decimal_point = MB_JSON_get_decimal_point();
-    size_t i = 0;
+    MB_JSON_Arena *arena = NULL;
+    MB_JSON_arena_header *header = NULL;
 
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    if (pointer == NULL)
     {
-        return false;
+        return;
     }
 
-    /* copy the number into a temporary buffer and replace '.' with the decimal point
-     * of the current locale (for strtod)
-     * This also takes care of '\0' not necessarily being available for marking the end of the input */
-    for (i = 0; (i < (sizeof(number_c_string) - 1)) && MB_JSON_can_access_at_index(input_buffer, i); i++)
+    arena = MB_JSON_arena_of(pointer);
+    if (arena == NULL)
     {
-        switch (MB_JSON_buffer_at_offset(input_buffer)[i])
-        {
-        case '0':
-        case '1':
-        case '2':
-        case '3':
-        case '4':
-        case '5':
-        case '6':
-        case '7':
-        case '8':
-        case '9':
-        case '+':
-        case '-':
-        case 'e':
-        case 'E':
-            number_c_string[i] = MB_JSON_buffer_at_offset(input_buffer)[i];
-            break;
-
-        case '.':
-            number_c_string[i] = decimal_point;
-            break;
-
-        default:
-            goto loop_end;
-        }
+        MB_JSON_heap_hooks.deallocate(pointer);
+        return;
     }
-loop_end:
-    number_c_string[i] = '\0';
 
-    number = strtod((const char *)number_c_string, (char **)&after_end);
-    if (number_c_string == after_end)
+    header = (MB_JSON_arena_header *)pointer - 1;
+    arena->live -= header->size;
+    if (arena->live == 0)
     {
-        return false; /* parse_error */
+        arena->used = 0;
     }
+    else if ((unsigned char *)header + header->size == arena->block + arena->used)
+    {
+        arena->used -= header->size;
+    }
+}
 
-    item->valuedouble = number;
+static void *MB_JSON_CDECL MB_JSON_arena_reallocate(void *pointer, size_t size)
+{
+    MB_JSON_Arena *arena = NULL;
+    MB_JSON_arena_header *header = NULL;
+    size_t length = 0;
+    void *copy = NULL;
 
-    /* use saturation in case of overflow */
-    if (number >= INT_MAX)
+    if (pointer == NULL)
     {
-        item->valueint = INT_MAX;
+        return MB_JSON_arena_allocate(size);
     }
-    else if (number <= (double)INT_MIN)
+
+    arena = MB_JSON_arena_of(pointer);
+    if (arena == NULL)
     {
-        item->valueint = INT_MIN;
+        return MB_JSON_heap_hooks.reallocate(pointer, size);
     }
-    else
+
+    header = (MB_JSON_arena_header *)pointer - 1;
+    length = (size + 2 * sizeof(MB_JSON_arena_header) - 1) / sizeof(MB_JSON_arena_header) * sizeof(MB_JSON_arena_header);
+
+    /* the last allocation grows or shrinks in place */
+    if ((length >= size) && ((unsigned char *)header + header->size == arena->block + arena->used) && (length <= arena->size - arena->used + header->size))
     {
-        item->valueint = (int)number;
+        arena->used = arena->used - header->size + length;
+        arena->live = arena->live - header->size + length;
+        header->size = length;
+        return pointer;
     }
 
-    item->type = MB_JSON_Number;
+    copy = MB_JSON_arena_allocate(size);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    memcpy(copy, pointer, (header->size - sizeof(MB_JSON_arena_header) < size) ? header->size - sizeof(MB_JSON_arena_header) : size);
+    MB_JSON_arena_deallocate(pointer);
 
-    input_buffer->offset += (size_t)(after_end - number_c_string);
-    return true;
+    return copy;
 }
 
-/* don't ask me, but the original MB_JSON_SetNumberValue returns an integer or double */
-MB_JSON_PUBLIC(double)
-MB_JSON_SetNumberHelper(MB_JSON *object, double number)
+static void MB_JSON_update_hooks(void)
 {
-    if (number >= INT_MAX)
+    MB_JSON_global_hooks = MB_JSON_heap_hooks;
+    if (MB_JSON_arenas != NULL)
     {
-        object->valueint = INT_MAX;
+        MB_JSON_global_hooks.allocate = MB_JSON_arena_allocate;
+        MB_JSON_global_hooks.deallocate = MB_JSON_arena_deallocate;
+        /* without realloc, the callers copy themselves */
+        if (MB_JSON_heap_hooks.reallocate != NULL)
+        {
+            MB_JSON_global_hooks.reallocate = MB_JSON_arena_reallocate;
+        }
     }
-    else if (number <= (double)INT_MIN)
+}
+
+MB_JSON_PUBLIC(MB_JSON_Arena *)
+MB_JSON_ArenaCreate(size_t size)
+{
+    MB_JSON_Arena *arena = (MB_JSON_Arena *)MB_JSON_heap_hooks.allocate(sizeof(MB_JSON_Arena));
+    if (arena == NULL)
     {
-        object->valueint = INT_MIN;
+        return NULL;
     }
-    else
+
+    arena->block = (unsigned char *)MB_JSON_heap_hooks.allocate(size);
+    if (arena->block == NULL)
     {
-        object->valueint = (int)number;
+        MB_JSON_heap_hooks.deallocate(arena);
+        return NULL;
     }
+    arena->size = size;
+    arena->used = 0;
+    arena->live = 0;
+
+    arena->next = MB_JSON_arenas;
+    MB_JSON_arenas = arena;
+    MB_JSON_update_hooks();
 
-    return object->valuedouble = number;
+    return arena;
 }
 
-MB_JSON_PUBLIC(char *)
-MB_JSON_SetValuestring(MB_JSON *object, const char *valuestring)
+MB_JSON_PUBLIC(MB_JSON_Arena *)
+MB_JSON_ArenaSelect(MB_JSON_Arena *arena)
 {
-    char *copy = NULL;
-    /* if object's type is not MB_JSON_String or is MB_JSON_IsReference, it should not set valuestring */
-    if (!(object->type & MB_JSON_String) || (object->type & MB_JSON_IsReference))
+    MB_JSON_Arena *previous = MB_JSON_selected_arena;
+    MB_JSON_selected_arena = arena;
+    return previous;
+}
+
+MB_JSON_PUBLIC(size_t)
+MB_JSON_ArenaUsed(const MB_JSON_Arena *arena)
+{
+    return (arena != NULL) ? arena->used : 0;
+}
+
+MB_JSON_PUBLIC(size_t)
+MB_JSON_ArenaLive(const MB_JSON_Arena *arena)
+{
+    return (arena != NULL) ? arena->live : 0;
+}
+
+static void MB_JSON_index_drop_range(const unsigned char *start, size_t size);
+
+MB_JSON_PUBLIC(void)
+MB_JSON_ArenaReset(MB_JSON_Arena *arena)
+{
+    if (arena != NULL)
     {
-        return NULL;
+        MB_JSON_index_drop_range(arena->block, arena->size);
+        arena->used = 0;
+        arena->live = 0;
     }
-    if (strlen(valuestring) <= strlen(object->valuestring))
+}
+
+MB_JSON_PUBLIC(void)
+MB_JSON_ArenaDelete(MB_JSON_Arena *arena)
+{
+    MB_JSON_Arena **link = &MB_JSON_arenas;
+
+    if (arena == NULL)
     {
-        strcpy(object->valuestring, valuestring);
-        return object->valuestring;
+        return;
     }
-    copy = (char *)MB_JSON_strdup((const unsigned char *)valuestring, &MB_JSON_global_hooks);
-    if (copy == NULL)
+
+    while ((*link != NULL) && (*link != arena))
     {
-        return NULL;
+        link = &(*link)->next;
     }
-    if (object->valuestring != NULL)
+    if (*link != NULL)
     {
-        MB_JSON_free(object->valuestring);
+        *link = arena->next;
     }
-    object->valuestring = copy;
+    if (MB_JSON_selected_arena == arena)
+    {
+        MB_JSON_selected_arena = NULL;
+    }
+    MB_JSON_update_hooks();
 
-    return copy;
+    MB_JSON_index_drop_range(arena->block, arena->size);
+    MB_JSON_heap_hooks.deallocate(arena->block);
+    MB_JSON_heap_hooks.deallocate(arena);
 }
 
-typedef struct
+#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+#pragma GCC diagnostic push
+#endif
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#endif
+/* helper function to cast away const */
+static void *cast_away_const(const void *string)
 {
-    unsigned char *buffer;
-    size_t length;
-    size_t offset;
-    size_t depth; /* current nesting depth (for formatted printing) */
-    MB_JSON_bool noalloc;
-    MB_JSON_bool format; /* is this print a formatted print */
-    MB_JSON_internal_hooks hooks;
-} MB_JSON_printbuffer;
+    return (void *)string;
+}
+#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+#pragma GCC diagnostic pop
+#endif
 
-typedef struct
+/* Interned keys
+ *
+ * A hash table of reference counted key copies. A key is known as shared by finding its pointer in the table, so
+ * items with and without shared keys can be mixed and interning can be switched at any time. */
+
+typedef struct MB_JSON_key
 {
-    size_t size;
-    size_t depth;
-    MB_JSON_bool format;
-} MB_JSON_buffer_len_data_t;
+    struct MB_JSON_key *next;
+    size_t references;
+    /* followed by the characters */
+} MB_JSON_key;
 
-/* realloc MB_JSON_printbuffer if necessary to have at least "needed" bytes more */
-static unsigned char *MB_JSON_ensure(MB_JSON_printbuffer *const p, size_t needed)
+static MB_JSON_bool MB_JSON_intern_keys = false;
+static MB_JSON_key **MB_JSON_key_table = NULL;
+static size_t MB_JSON_key_buckets = 0;
+static size_t MB_JSON_key_count = 0;
+
+MB_JSON_PUBLIC(void)
+MB_JSON_InternKeys(MB_JSON_bool enable)
 {
-    unsigned char *newbuffer = NULL;
-    size_t newsize = 0;
+    MB_JSON_intern_keys = enable;
+}
 
-    if ((p == NULL) || (p->buffer == NULL))
+static size_t MB_JSON_key_hash(const unsigned char *key, size_t length)
+{
+    /* FNV-1a */
+    unsigned long hash = 2166136261UL;
+    size_t i = 0;
+    for (i = 0; i < length; i++)
     {
-        return NULL;
+        hash = ((hash ^ key[i]) * 16777619UL) & 0xFFFFFFFFUL;
     }
+    return (size_t)hash;
+}
 
-    if ((p->length > 0) && (p->offset >= p->length))
+/* grow the table to keep the chains short, keeps the old one when out of memory */
+static void MB_JSON_key_rehash(void)
+{
+    size_t buckets = (MB_JSON_key_buckets == 0) ? 16 : MB_JSON_key_buckets * 2;
+    MB_JSON_key **table = (MB_JSON_key **)MB_JSON_heap_hooks.allocate(buckets * sizeof(MB_JSON_key *));
+    size_t i = 0;
+
+    if (table == NULL)
     {
-        /* make sure that offset is valid */
-        return NULL;
+        return;
     }
+    memset(table, 0, buckets * sizeof(MB_JSON_key *));
 
-    if (needed > INT_MAX)
+    for (i = 0; i < MB_JSON_key_buckets; i++)
     {
-        /* sizes bigger than INT_MAX are currently not supported */
-        return NULL;
+        MB_JSON_key *key = MB_JSON_key_table[i];
+        while (key != NULL)
+        {
+            MB_JSON_key *next = key->next;
+            const char *string = (const char *)(key + 1);
+            size_t bucket = MB_JSON_key_hash((const unsigned char *)string, strlen(string)) & (buckets - 1);
+            key->next = table[bucket];
+            table[bucket] = key;
+            key = next;
+        }
     }
 
-    needed += p->offset + 1;
-    if (needed <= p->length)
+    if (MB_JSON_key_table != NULL)
     {
-        return p->buffer + p->offset;
+        MB_JSON_heap_hooks.deallocate(MB_JSON_key_table);
     }
+    MB_JSON_key_table = table;
+    MB_JSON_key_buckets = buckets;
+}
 
-    if (p->noalloc)
+/* the shared entry of a key, NULL if it isn't one */
+static MB_JSON_key *MB_JSON_key_of(const char *string)
+{
+    MB_JSON_key *key = NULL;
+
+    if ((string == NULL) || (MB_JSON_key_count == 0))
     {
         return NULL;
     }
 
-    /* calculate new buffer size */
-    if (needed > (INT_MAX / 2))
-    {
-        /* overflow of int, use INT_MAX if possible */
-        if (needed <= INT_MAX)
-        {
-            newsize = INT_MAX;
-        }
-        else
-        {
-            return NULL;
-        }
-    }
-    else
+    key = MB_JSON_key_table[MB_JSON_key_hash((const unsigned char *)string, strlen(string)) & (MB_JSON_key_buckets - 1)];
+    while ((key != NULL) && ((const char *)(key + 1) != string))
     {
-        newsize = needed * 2;
+        key = key->next;
     }
+    return key;
+}
+
+/* Copy of a key of the given length for a new item, shared when interning.
+ * The key ends at its first NUL, as MB_JSON_key_of and MB_JSON_key_free see it. */
+static char *MB_JSON_key_new(const char *string, size_t length, const MB_JSON_internal_hooks *const hooks)
+{
+    MB_JSON_key *key = NULL;
+    size_t hash = 0;
+    char *copy = NULL;
+    const char *end = NULL;
 
-    if (p->hooks.reallocate != NULL)
+    /* An empty key may come without a buffer */
+    if ((string == NULL) || (length == 0))
     {
-        /* reallocate with realloc if available */
-        newbuffer = (unsigned char *)p->hooks.reallocate(p->buffer, newsize);
-        if (newbuffer == NULL)
-        {
-            p->hooks.deallocate(p->buffer);
-            p->length = 0;
-            p->buffer = NULL;
+        string = "";
+        length = 0;
+    }
 
-            return NULL;
+    end = (const char *)memchr(string, '\0', length);
+    if (end != NULL)
+    {
+        length = (size_t)(end - string);
+    }
+
+    if (!MB_JSON_intern_keys)
+    {
+        copy = (char *)hooks->allocate(length + sizeof(""));
+        if (copy != NULL)
+        {
+            memcpy(copy, string, length);
+            copy[length] = '\0';
         }
+        return copy;
     }
-    else
+
+    hash = MB_JSON_key_hash((const unsigned char *)string, length);
+    if (MB_JSON_key_buckets > 0)
     {
-        /* otherwise reallocate manually */
-        newbuffer = (unsigned char *)p->hooks.allocate(newsize);
-        if (!newbuffer)
+        key = MB_JSON_key_table[hash & (MB_JSON_key_buckets - 1)];
+        while (key != NULL)
         {
-            p->hooks.deallocate(p->buffer);
-            p->length = 0;
-            p->buffer = NULL;
+            copy = (char *)(key + 1);
+            if ((strncmp(copy, string, length) == 0) && (copy[length] == '\0'))
+            {
+                key->references++;
+                return copy;
+            }
+            key = key->next;
+        }
+    }
 
+    if (MB_JSON_key_count >= MB_JSON_key_buckets * 2)
+    {
+        MB_JSON_key_rehash();
+        if (MB_JSON_key_buckets == 0)
+        {
             return NULL;
         }
+    }
 
-        memcpy(newbuffer, p->buffer, p->offset + 1);
-        p->hooks.deallocate(p->buffer);
+    key = (MB_JSON_key *)MB_JSON_heap_hooks.allocate(sizeof(MB_JSON_key) + length + sizeof(""));
+    if (key == NULL)
+    {
+        return NULL;
     }
-    p->length = newsize;
-    p->buffer = newbuffer;
+    copy = (char *)(key + 1);
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    key->references = 1;
+    key->next = MB_JSON_key_table[hash & (MB_JSON_key_buckets - 1)];
+    MB_JSON_key_table[hash & (MB_JSON_key_buckets - 1)] = key;
+    MB_JSON_key_count++;
 
-    return newbuffer + p->offset;
+    return copy;
 }
 
-/* calculate the new length of the string in a MB_JSON_printbuffer and update the offset */
-static void MB_JSON_update_offset(MB_JSON_printbuffer *const buffer)
+/* Copy of the key of an existing item */
+static char *MB_JSON_key_copy(const char *string, const MB_JSON_internal_hooks *const hooks)
 {
-    const unsigned char *buffer_pointer = NULL;
-    if ((buffer == NULL) || (buffer->buffer == NULL))
+    MB_JSON_key *key = MB_JSON_key_of(string);
+    if (key != NULL)
+    {
+        key->references++;
+        return (char *)cast_away_const(string);
+    }
+    return MB_JSON_key_new(string, strlen(string), hooks);
+}
+
+static void MB_JSON_key_free(char *string, const MB_JSON_internal_hooks *const hooks)
+{
+    MB_JSON_key *key = MB_JSON_key_of(string);
+    MB_JSON_key **link = NULL;
+
+    if (key == NULL)
     {
+        if (string != NULL)
+        {
+            hooks->deallocate(string);
+        }
         return;
     }
-    buffer_pointer = buffer->buffer + buffer->offset;
 
-    buffer->offset += strlen((const char *)buffer_pointer);
+    if (--key->references > 0)
+    {
+        return;
+    }
+
+    link = &MB_JSON_key_table[MB_JSON_key_hash((const unsigned char *)string, strlen(string)) & (MB_JSON_key_buckets - 1)];
+    while (*link != key)
+    {
+        link = &(*link)->next;
+    }
+    *link = key->next;
+    MB_JSON_key_count--;
+    MB_JSON_heap_hooks.deallocate(key);
 }
 
-/* securely comparison of floating-point variables */
-static MB_JSON_bool MB_JSON_compare_double(double a, double b)
+/* Member indexes
+ *
+ * An open addressing hash table of the members of an object, built when a lookup by name walks past
+ * MB_JSON_INDEX_MIN_ITEMS members and dropped when the members change. Only MB_JSON_INDEX_LIMIT objects are indexed
+ * at a time, a new index takes the place of the oldest one. */
+
+typedef struct MB_JSON_index
 {
-    double maxVal = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
-    return (fabs(a - b) <= maxVal * DBL_EPSILON);
+    const MB_JSON *object;
+    /* a power of 2 */
+    size_t size;
+    /* followed by the slots */
+} MB_JSON_index;
+
+static MB_JSON_bool MB_JSON_index_objects = false;
+static MB_JSON_index *MB_JSON_indexes[MB_JSON_INDEX_LIMIT];
+static size_t MB_JSON_index_count = 0;
+static size_t MB_JSON_index_oldest = 0;
+
+static void MB_JSON_index_drop_at(size_t position)
+{
+    MB_JSON_heap_hooks.deallocate(MB_JSON_indexes[position]);
+    MB_JSON_indexes[position] = NULL;
+    MB_JSON_index_count--;
 }
 
-/* Render the number nicely from the given item into a string. */
-static MB_JSON_bool MB_JSON_print_number(const MB_JSON *const item, MB_JSON_printbuffer *const output_buffer)
+static void MB_JSON_index_drop(const MB_JSON *object)
 {
-    unsigned char *output_pointer = NULL;
-    double d = item->valuedouble;
-    int length = 0;
     size_t i = 0;
-    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
-    unsigned char decimal_point = MB_JSON_get_decimal_point();
-    double test = 0.0;
 
-    if (output_buffer == NULL)
+    if (MB_JSON_index_count == 0)
     {
-        return false;
+        return;
     }
 
-    /* This checks for NaN and Infinity */
-    if (isnan(d) || isinf(d))
-    {
-        length = sprintf((char *)number_buffer, "null");
-    }
-    else
+    for (i = 0; i < MB_JSON_INDEX_LIMIT; i++)
     {
-        /* Try 15 decimal places of precision to avoid nonsignificant nonzero digits */
-        length = sprintf((char *)number_buffer, "%1.15g", d);
-
-        /* Check whether the original double can be recovered */
-        if ((sscanf((char *)number_buffer, "%lg", &test) != 1) || !MB_JSON_compare_double((double)test, d))
+        if ((MB_JSON_indexes[i] != NULL) && (MB_JSON_indexes[i]->object == object))
         {
-            /* If not, print with 17 decimal places of precision */
-            length = sprintf((char *)number_buffer, "%1.17g", d);
+            MB_JSON_index_drop_at(i);
+            return;
         }
     }
+}
 
-    /* sprintf failed or buffer overrun occurred */
-    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1)))
-    {
-        return false;
-    }
-
-    /* reserve appropriate space in the output */
-    output_pointer = MB_JSON_ensure(output_buffer, (size_t)length + sizeof(""));
-    if (output_pointer == NULL)
-    {
-        return false;
-    }
+/* drop the indexes of the objects in a block which is about to be reused */
+static void MB_JSON_index_drop_range(const unsigned char *start, size_t size)
+{
+    size_t i = 0;
 
-    /* copy the printed number to the output and replace locale
-     * dependent decimal point with '.' */
-    for (i = 0; i < ((size_t)length); i++)
+    for (i = 0; (i < MB_JSON_INDEX_LIMIT) && (MB_JSON_index_count > 0); i++)
     {
-        if (number_buffer[i] == decimal_point)
+        if ((MB_JSON_indexes[i] != NULL) && ((const unsigned char *)MB_JSON_indexes[i]->object >= start) && ((const unsigned char *)MB_JSON_indexes[i]->object < start + size))
         {
-            output_pointer[i] = '.';
-            continue;
+            MB_JSON_index_drop_at(i);
         }
-
-        output_pointer[i] = number_buffer[i];
     }
-    output_pointer[i] = '\0';
-
-    output_buffer->offset += (size_t)length;
-
-    return true;
 }
 
-/* parse 4 digit hexadecimal number */
-static unsigned MB_JSON_parse_hex4(const unsigned char *const input)
+MB_JSON_PUBLIC(void)
+MB_JSON_IndexObjects(MB_JSON_bool enable)
 {
-    unsigned int h = 0;
     size_t i = 0;
 
-    for (i = 0; i < 4; i++)
+    MB_JSON_index_objects = enable;
+    for (i = 0; (i < MB_JSON_INDEX_LIMIT) && !enable && (MB_JSON_index_count > 0); i++)
     {
-        /* parse digit */
-        if ((input[i] >= '0') && (input[i] <= '9'))
+        if (MB_JSON_indexes[i] != NULL)
         {
-            h += (unsigned int)input[i] - '0';
-        }
-        else if ((input[i] >= 'A') && (input[i] <= 'F'))
-        {
-            h += (unsigned int)10 + input[i] - 'A';
-        }
-        else if ((input[i] >= 'a') && (input[i] <= 'f'))
-        {
-            h += (unsigned int)10 + input[i] - 'a';
-        }
-        else /* invalid */
-        {
-            return 0;
+            MB_JSON_index_drop_at(i);
         }
+    }
+}
 
-        if (i < 3)
+static MB_JSON_index *MB_JSON_index_of(const MB_JSON *object)
+{
+    size_t i = 0;
+
+    for (i = 0; (i < MB_JSON_INDEX_LIMIT) && (MB_JSON_index_count > 0); i++)
+    {
+        if ((MB_JSON_indexes[i] != NULL) && (MB_JSON_indexes[i]->object == object))
         {
-            /* shift left to make place for the next nibble */
-            h = h << 4;
+            return MB_JSON_indexes[i];
         }
     }
-
-    return h;
+    return NULL;
 }
 
-/* converts a UTF-16 literal to UTF-8
- * A literal can be one or two sequences of the form \uXXXX */
-static unsigned char MB_JSON_utf16_literal_to_utf8(const unsigned char *const input_pointer, const unsigned char *const input_end, unsigned char **output_pointer)
+static void MB_JSON_index_build(const MB_JSON *object)
 {
-    long unsigned int codepoint = 0;
-    unsigned int first_code = 0;
-    const unsigned char *first_sequence = input_pointer;
-    unsigned char utf8_length = 0;
-    unsigned char utf8_position = 0;
-    unsigned char sequence_length = 0;
-    unsigned char first_byte_mark = 0;
+    MB_JSON_index *index = NULL;
+    MB_JSON **slots = NULL;
+    const MB_JSON *current = NULL;
+    size_t count = 0;
+    size_t size = 1;
 
-    if ((input_end - first_sequence) < 6)
+    for (current = object->child; current != NULL; current = current->next)
     {
-        /* input ends unexpectedly */
-        goto fail;
+        count++;
     }
-
-    /* get the first utf16 sequence */
-    first_code = MB_JSON_parse_hex4(first_sequence + 2);
-
-    /* check that the code is valid */
-    if (((first_code >= 0xDC00) && (first_code <= 0xDFFF)))
+    /* at most two thirds full */
+    while (size < count + count / 2 + 1)
     {
-        goto fail;
+        size *= 2;
     }
 
-    /* UTF16 surrogate pair */
-    if ((first_code >= 0xD800) && (first_code <= 0xDBFF))
+    index = (MB_JSON_index *)MB_JSON_heap_hooks.allocate(sizeof(MB_JSON_index) + size * sizeof(MB_JSON *));
+    if (index == NULL)
     {
-        const unsigned char *second_sequence = first_sequence + 6;
-        unsigned int second_code = 0;
-        sequence_length = 12; /* \uXXXX\uXXXX */
+        return;
+    }
+    index->object = object;
+    index->size = size;
+    slots = (MB_JSON **)(index + 1);
+    memset(slots, 0, size * sizeof(MB_JSON *));
 
-        if ((input_end - second_sequence) < 6)
+    for (current = object->child; current != NULL; current = current->next)
+    {
+        size_t slot = 0;
+        if (current->string == NULL)
         {
-            /* input ends unexpectedly */
-            goto fail;
+            continue;
         }
-
-        if ((second_sequence[0] != '\\') || (second_sequence[1] != 'u'))
+        slot = MB_JSON_key_hash((const unsigned char *)current->string, strlen(current->string)) & (size - 1);
+        /* the first of equal names is the one found */
+        while ((slots[slot] != NULL) && (strcmp(slots[slot]->string, current->string) != 0))
         {
-            /* missing second half of the surrogate pair */
-            goto fail;
+            slot = (slot + 1) & (size - 1);
         }
-
-        /* get the second utf16 sequence */
-        second_code = MB_JSON_parse_hex4(second_sequence + 2);
-        /* check that the code is valid */
-        if ((second_code < 0xDC00) || (second_code > 0xDFFF))
+        if (slots[slot] == NULL)
         {
-            /* invalid second half of the surrogate pair */
-            goto fail;
+            slots[slot] = (MB_JSON *)cast_away_const(current);
         }
-
-        /* calculate the unicode codepoint from the surrogate pair */
-        codepoint = 0x10000 + (((first_code & 0x3FF) << 10) | (second_code & 0x3FF));
-    }
-    else
-    {
-        sequence_length = 6; /* \uXXXX */
-        codepoint = first_code;
     }
 
-    /* encode as UTF-8
-     * takes at maximum 4 bytes to encode:
-     * 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx */
-    if (codepoint < 0x80)
+    if (MB_JSON_indexes[MB_JSON_index_oldest] != NULL)
     {
-        /* normal ascii, encoding 0xxxxxxx */
-        utf8_length = 1;
-    }
-    else if (codepoint < 0x800)
-    {
-        /* two bytes, encoding 110xxxxx 10xxxxxx */
-        utf8_length = 2;
-        first_byte_mark = 0xC0; /* 11000000 */
+        MB_JSON_index_drop_at(MB_JSON_index_oldest);
     }
-    else if (codepoint < 0x10000)
-    {
-        /* three bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx */
-        utf8_length = 3;
-        first_byte_mark = 0xE0; /* 11100000 */
-    }
-    else if (codepoint <= 0x10FFFF)
+    MB_JSON_indexes[MB_JSON_index_oldest] = index;
+    MB_JSON_index_oldest = (MB_JSON_index_oldest + 1) % MB_JSON_INDEX_LIMIT;
+    MB_JSON_index_count++;
+}
+
+/* case sensitive lookup of the member named by the first length characters of name, which holds no '\0' */
+static MB_JSON *MB_JSON_get_object_item_length(const MB_JSON *const object, const char *const name, size_t length)
+{
+    MB_JSON_index *index = NULL;
+    MB_JSON *current_element = NULL;
+    size_t walked = 0;
+
+    if ((object == NULL) || (name == NULL))
     {
-        /* four bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx 10xxxxxx */
-        utf8_length = 4;
-        first_byte_mark = 0xF0; /* 11110000 */
+        return NULL;
     }
-    else
+
+    index = MB_JSON_index_of(object);
+    if (index != NULL)
     {
-        /* invalid unicode codepoint */
-        goto fail;
+        MB_JSON **slots = (MB_JSON **)(index + 1);
+        size_t slot = MB_JSON_key_hash((const unsigned char *)name, length) & (index->size - 1);
+        while (slots[slot] != NULL)
+        {
+            if ((strncmp(slots[slot]->string, name, length) == 0) && (slots[slot]->string[length] == '\0'))
+            {
+                return slots[slot];
+            }
+            slot = (slot + 1) & (index->size - 1);
+        }
+        return NULL;
     }
 
-    /* encode as utf8 */
-    for (utf8_position = (unsigned char)(utf8_length - 1); utf8_position > 0; utf8_position--)
+    current_element = object->child;
+    while ((current_element != NULL) && (current_element->string != NULL) && !((strncmp(current_element->string, name, length) == 0) && (current_element->string[length] == '\0')))
     {
-        /* 10xxxxxx */
-        (*output_pointer)[utf8_position] = (unsigned char)((codepoint | 0x80) & 0xBF);
-        codepoint >>= 6;
+        current_element = current_element->next;
+        walked++;
     }
-    /* encode first byte */
-    if (utf8_length > 1)
+
+    if (MB_JSON_index_objects && (walked >= MB_JSON_INDEX_MIN_ITEMS) && MB_JSON_IsObject(object) && !(object->type & MB_JSON_IsReference))
     {
-        (*output_pointer)[0] = (unsigned char)((codepoint | first_byte_mark) & 0xFF);
+        MB_JSON_index_build(object);
     }
-    else
+
+    if ((current_element == NULL) || (current_element->string == NULL))
     {
-        (*output_pointer)[0] = (unsigned char)(codepoint & 0x7F);
+        return NULL;
     }
 
-    *output_pointer += utf8_length;
-
-    return sequence_length;
-
-fail:
-    return 0;
+    return current_element;
 }
 
-/* Parse the input text into an unescaped cinput, and populate item. */
-static MB_JSON_bool MB_JSON_parse_string(MB_JSON *const item, MB_JSON_parse_buffer *const input_buffer)
+/* Internal constructor. */
+static MB_JSON *MB_JSON_New_Item(const MB_JSON_internal_hooks *const hooks)
 {
-    const unsigned char *input_pointer = MB_JSON_buffer_at_offset(input_buffer) + 1;
-    const unsigned char *input_end = MB_JSON_buffer_at_offset(input_buffer) + 1;
-    unsigned char *output_pointer = NULL;
+    MB_JSON *node = (MB_JSON *)hooks->allocate(sizeof(MB_JSON));
+    if (node)
+    {
+        memset(node, '\0', sizeof(MB_JSON));
+    }
+
+    return node;
+}
+
+/* Utility for array list handling. */
+static void MB_JSON_suffix_object(MB_JSON *prev, MB_JSON *item)
+{
+    prev->next = item;
+#if !defined(MB_JSON_COMPACT_ITEMS)
+    item->prev = prev;
+#endif
+}
+
+/* Keep the last child of a list for O(1) appends: the first child's prev points to it, or with compact items the
+ * parent keeps it in place of a value. Called whenever the last child changes. */
+static void MB_JSON_set_last_item(MB_JSON *parent, MB_JSON *last)
+{
+#if defined(MB_JSON_COMPACT_ITEMS)
+    if (parent->type & (MB_JSON_Array | MB_JSON_Object))
+    {
+        parent->last = last;
+    }
+#else
+    if (parent->child != NULL)
+    {
+        parent->child->prev = last;
+    }
+#endif
+}
+
+/* the last child, NULL for an empty list */
+static MB_JSON *MB_JSON_last_item(const MB_JSON *parent)
+{
+    MB_JSON *last = parent->child;
+
+    if (last == NULL)
+    {
+        return NULL;
+    }
+#if defined(MB_JSON_COMPACT_ITEMS)
+    /* references share the list but not the parent, so theirs may be out of date */
+    if ((parent->type & (MB_JSON_Array | MB_JSON_Object)) && !(parent->type & MB_JSON_IsReference) && (parent->last != NULL))
+    {
+        last = parent->last;
+    }
+#else
+    if (last->prev != NULL)
+    {
+        last = last->prev;
+    }
+#endif
+    while (last->next != NULL)
+    {
+        last = last->next;
+    }
+    return last;
+}
+
+/* the item before the given one, NULL for the first one */
+static MB_JSON *MB_JSON_previous_item(const MB_JSON *parent, const MB_JSON *item)
+{
+#if defined(MB_JSON_COMPACT_ITEMS)
+    MB_JSON *previous = parent->child;
+    if (previous == item)
+    {
+        return NULL;
+    }
+    while ((previous != NULL) && (previous->next != item))
+    {
+        previous = previous->next;
+    }
+    return previous;
+#else
+    return (item == parent->child) ? NULL : item->prev;
+#endif
+}
+
+/* Set the number of an item, and valueint with saturation in case of overflow */
+static void MB_JSON_set_number(MB_JSON *item, double number)
+{
+    item->valuedouble = number;
+#if !defined(MB_JSON_COMPACT_ITEMS)
+    if (number >= INT_MAX)
+    {
+        item->valueint = INT_MAX;
+    }
+    else if (number <= (double)INT_MIN)
+    {
+        item->valueint = INT_MIN;
+    }
+    else if (number == number)
+    {
+        item->valueint = (int)number;
+    }
+    else
+    {
+        item->valueint = 0; /* NaN */
+    }
+#endif
+}
+
+/* Delete a MB_JSON structure. */
+MB_JSON_PUBLIC(void)
+MB_JSON_Delete(MB_JSON *item)
+{
+    MB_JSON *next = NULL;
+    while (item != NULL)
+    {
+        next = item->next;
+        if (!(item->type & MB_JSON_IsReference) && (item->child != NULL))
+        {
+            MB_JSON_index_drop(item);
+            MB_JSON_Delete(item->child);
+        }
+        if (!(item->type & MB_JSON_IsReference) && (item->type & (MB_JSON_String | MB_JSON_Raw)) && (item->valuestring != NULL))
+        {
+            MB_JSON_global_hooks.deallocate(item->valuestring);
+        }
+        if (!(item->type & MB_JSON_StringIsConst) && (item->string != NULL))
+        {
+            MB_JSON_key_free(item->string, &MB_JSON_global_hooks);
+        }
+        MB_JSON_global_hooks.deallocate(item);
+        item = next;
+    }
+}
+
+/* get the decimal point character of the current locale */
+static unsigned char MB_JSON_get_decimal_point(void)
+{
+#ifdef ENABLE_LOCALES
+    struct lconv *lconv = localeconv();
+    return (unsigned char)lconv->decimal_point[0];
+#else
+    return '.';
+#endif
+}
+
+typedef struct
+{
+    const unsigned char *content;
+    size_t length;
+    size_t offset;
+    size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
+    MB_JSON_internal_hooks hooks;
+} MB_JSON_parse_buffer;
+
+/* check if the given size is left to read in a given parse buffer (starting with 1) */
+#define MB_JSON_can_read(buffer, size) ((buffer != NULL) && (((buffer)->offset + size) <= (buffer)->length))
+/* check if the buffer can be accessed at the given index (starting with 0) */
+#define MB_JSON_can_access_at_index(buffer, index) ((buffer != NULL) && (((buffer)->offset + index) < (buffer)->length))
+#define MB_JSON_cannot_access_at_index(buffer, index) (!MB_JSON_can_access_at_index(buffer, index))
+/* get a pointer to the buffer at the position */
+#define MB_JSON_buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
+
+/* Powers of ten that are exactly representable as doubles */
+static const double MB_JSON_exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/* Read a plain decimal number whose significand fits in 53 bits and whose decimal
+ * exponent is within 22, so that one exact multiplication or division gives the
+ * correctly rounded result (Clinger's fast path). Returns the number of characters
+ * read, or 0 if the text has to go through strtod. */
+static size_t MB_JSON_parse_number_fast(const unsigned char *const text, const size_t length, double *const number)
+{
+    uint64_t significand = 0;
+    int digits = 0;
+    int exponent = 0;
+    int exponent_value = 0;
+    MB_JSON_bool negative = false;
+    MB_JSON_bool negative_exponent = false;
+    size_t i = 0;
+    double value = 0;
+
+    if ((i < length) && (text[i] == '-'))
+    {
+        negative = true;
+        i++;
+    }
+    if ((i >= length) || (text[i] < '0') || (text[i] > '9'))
+    {
+        return 0;
+    }
+
+    /* integer part */
+    for (; (i < length) && (text[i] >= '0') && (text[i] <= '9'); i++)
+    {
+        if (digits == 19)
+        {
+            return 0;
+        }
+        significand = significand * 10 + (uint64_t)(text[i] - '0');
+        if (significand != 0)
+        {
+            digits++;
+        }
+    }
+
+    /* fraction part */
+    if ((i < length) && (text[i] == '.'))
+    {
+        i++;
+        if ((i >= length) || (text[i] < '0') || (text[i] > '9'))
+        {
+            return 0;
+        }
+        for (; (i < length) && (text[i] >= '0') && (text[i] <= '9'); i++)
+        {
+            if (digits == 19)
+            {
+                return 0;
+            }
+            significand = significand * 10 + (uint64_t)(text[i] - '0');
+            if (significand != 0)
+            {
+                digits++;
+            }
+            exponent--;
+        }
+    }
+
+    /* exponent part */
+    if ((i < length) && ((text[i] == 'e') || (text[i] == 'E')))
+    {
+        i++;
+        if ((i < length) && ((text[i] == '+') || (text[i] == '-')))
+        {
+            negative_exponent = (text[i] == '-');
+            i++;
+        }
+        if ((i >= length) || (text[i] < '0') || (text[i] > '9'))
+        {
+            return 0;
+        }
+        for (; (i < length) && (text[i] >= '0') && (text[i] <= '9'); i++)
+        {
+            if (exponent_value < 10000)
+            {
+                exponent_value = exponent_value * 10 + (text[i] - '0');
+            }
+        }
+        exponent += negative_exponent ? -exponent_value : exponent_value;
+    }
+
+    if (significand != 0)
+    {
+        if ((significand > (UINT64_C(1) << 53)) || (exponent < -22) || (exponent > 22))
+        {
+            return 0;
+        }
+        value = (double)significand;
+        if (exponent < 0)
+        {
+            value /= MB_JSON_exact_powers_of_ten[-exponent];
+        }
+        else
+        {
+            value *= MB_JSON_exact_powers_of_ten[exponent];
+        }
+    }
+
+    *number = negative ? -value : value;
+    return i;
+}
+
+/* Parse the input text to generate a number, and populate the result into item. */
+static MB_JSON_bool MB_JSON_parse_number(MB_JSON *const item, MB_JSON_parse_buffer *const input_buffer)
+{
+    double number = 0;
+    unsigned char *after_end = NULL;
+    unsigned char number_c_string[64];
+    unsigned char decimal_point = MB_JSON_get_decimal_point();
+    size_t i = 0;
+
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false;
+    }
+
+    i = MB_JSON_parse_number_fast(MB_JSON_buffer_at_offset(input_buffer), input_buffer->length - input_buffer->offset, &number);
+    if (i > 0)
+    {
+        MB_JSON_set_number(item, number);
+        item->type = MB_JSON_Number;
+        input_buffer->offset += i;
+        return true;
+    }
+
+    /* copy the number into a temporary buffer and replace '.' with the decimal point
+     * of the current locale (for strtod)
+     * This also takes care of '\0' not necessarily being available for marking the end of the input */
+    for (i = 0; (i < (sizeof(number_c_string) - 1)) && MB_JSON_can_access_at_index(input_buffer, i); i++)
+    {
+        switch (MB_JSON_buffer_at_offset(input_buffer)[i])
+        {
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+        case '+':
+        case '-':
+        case 'e':
+        case 'E':
+            number_c_string[i] = MB_JSON_buffer_at_offset(input_buffer)[i];
+            break;
+
+        case '.':
+            number_c_string[i] = decimal_point;
+            break;
+
+        default:
+            goto loop_end;
+        }
+    }
+loop_end:
+    number_c_string[i] = '\0';
+
+    number = strtod((const char *)number_c_string, (char **)&after_end);
+    if (number_c_string == after_end)
+    {
+        return false; /* parse_error */
+    }
+
+    MB_JSON_set_number(item, number);
+    item->type = MB_JSON_Number;
+
+    input_buffer->offset += (size_t)(after_end - number_c_string);
+    return true;
+}
+
+MB_JSON_PUBLIC(size_t)
+MB_JSON_ParseNumber(const char *value, size_t length, double *number)
+{
+    MB_JSON item;
+    MB_JSON_parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}};
+
+    if ((value == NULL) || (number == NULL))
+    {
+        return 0;
+    }
+
+    memset(&item, 0, sizeof(item));
+    buffer.content = (const unsigned char *)value;
+    buffer.length = length;
+    buffer.hooks = MB_JSON_global_hooks;
+    if (!MB_JSON_parse_number(&item, &buffer))
+    {
+        return 0;
+    }
+
+    *number = item.valuedouble;
+    return buffer.offset;
+}
+
+/* don't ask me, but the original MB_JSON_SetNumberValue returns an integer or double */
+MB_JSON_PUBLIC(double)
+MB_JSON_SetNumberHelper(MB_JSON *object, double number)
+{
+    MB_JSON_set_number(object, number);
+    return object->valuedouble;
+}
+
+MB_JSON_PUBLIC(char *)
+MB_JSON_SetValuestring(MB_JSON *object, const char *valuestring)
+{
+    char *copy = NULL;
+    /* if object's type is not MB_JSON_String or is MB_JSON_IsReference, it should not set valuestring */
+    if (!(object->type & MB_JSON_String) || (object->type & MB_JSON_IsReference))
+    {
+        return NULL;
+    }
+    if (strlen(valuestring) <= strlen(object->valuestring))
+    {
+        strcpy(object->valuestring, valuestring);
+        return object->valuestring;
+    }
+    copy = (char *)MB_JSON_strdup((const unsigned char *)valuestring, &MB_JSON_global_hooks);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    if (object->valuestring != NULL)
+    {
+        MB_JSON_free(object->valuestring);
+    }
+    object->valuestring = copy;
+
+    return copy;
+}
+
+typedef struct
+{
+    unsigned char *buffer;
+    size_t length;
+    size_t offset;
+    size_t depth; /* current nesting depth (for formatted printing) */
+    MB_JSON_bool noalloc;
+    MB_JSON_bool format; /* is this print a formatted print */
+    MB_JSON_internal_hooks hooks;
+    /* takes the printed text whenever the buffer is full, instead of growing it */
+    MB_JSON_Writer write;
+    void *user;
+    /* the buffer belongs to the caller, so it is never passed to the hooks */
+    MB_JSON_bool borrowed;
+} MB_JSON_printbuffer;
+
+typedef struct
+{
+    size_t size;
+    size_t depth;
+    MB_JSON_bool format;
+} MB_JSON_buffer_len_data_t;
+
+/* realloc MB_JSON_printbuffer if necessary to have at least "needed" bytes more */
+static unsigned char *MB_JSON_ensure(MB_JSON_printbuffer *const p, size_t needed)
+{
+    unsigned char *newbuffer = NULL;
+    size_t newsize = 0;
+
+    if ((p == NULL) || (p->buffer == NULL))
+    {
+        return NULL;
+    }
+
+    if ((p->length > 0) && (p->offset >= p->length))
+    {
+        /* make sure that offset is valid */
+        return NULL;
+    }
+
+    if (needed > INT_MAX)
+    {
+        /* sizes bigger than INT_MAX are currently not supported */
+        return NULL;
+    }
+
+    needed += p->offset + 1;
+    if (needed <= p->length)
+    {
+        return p->buffer + p->offset;
+    }
+
+    if ((p->write != NULL) && (p->offset > 0))
+    {
+        /* hand over the text printed so far and start again at the front */
+        p->buffer[p->offset] = '\0';
+        if (!p->write((const char *)p->buffer, p->offset, p->user))
+        {
+            return NULL;
+        }
+        needed -= p->offset;
+        p->offset = 0;
+        if (needed <= p->length)
+        {
+            return p->buffer;
+        }
+    }
+
+    if (p->noalloc)
+    {
+        return NULL;
+    }
+
+    /* calculate new buffer size */
+    if (needed > (INT_MAX / 2))
+    {
+        /* overflow of int, use INT_MAX if possible */
+        if (needed <= INT_MAX)
+        {
+            newsize = INT_MAX;
+        }
+        else
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        newsize = needed * 2;
+    }
+
+    if ((p->hooks.reallocate != NULL) && !p->borrowed)
+    {
+        /* reallocate with realloc if available */
+        newbuffer = (unsigned char *)p->hooks.reallocate(p->buffer, newsize);
+        if (newbuffer == NULL)
+        {
+            p->hooks.deallocate(p->buffer);
+            p->length = 0;
+            p->buffer = NULL;
+
+            return NULL;
+        }
+    }
+    else
+    {
+        /* otherwise reallocate manually */
+        newbuffer = (unsigned char *)p->hooks.allocate(newsize);
+        if (!newbuffer)
+        {
+            if (!p->borrowed)
+            {
+                p->hooks.deallocate(p->buffer);
+            }
+            p->length = 0;
+            p->buffer = NULL;
+
+            return NULL;
+        }
+
+        memcpy(newbuffer, p->buffer, p->offset + 1);
+        if (!p->borrowed)
+        {
+            p->hooks.deallocate(p->buffer);
+        }
+        p->borrowed = false;
+    }
+    p->length = newsize;
+    p->buffer = newbuffer;
+
+    return newbuffer + p->offset;
+}
+
+/* calculate the new length of the string in a MB_JSON_printbuffer and update the offset */
+static void MB_JSON_update_offset(MB_JSON_printbuffer *const buffer)
+{
+    const unsigned char *buffer_pointer = NULL;
+    if ((buffer == NULL) || (buffer->buffer == NULL))
+    {
+        return;
+    }
+    buffer_pointer = buffer->buffer + buffer->offset;
+
+    buffer->offset += strlen((const char *)buffer_pointer);
+}
+
+/* securely comparison of floating-point variables */
+static MB_JSON_bool MB_JSON_compare_double(double a, double b)
+{
+    double maxVal = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
+    return (fabs(a - b) <= maxVal * DBL_EPSILON);
+}
+
+/* Shortest round-trip number printing, after Florian Loitsch's Grisu2 ("Printing
+ * Floating-Point Numbers Quickly and Accurately with Integers", 2010). The digits
+ * are generated with 64-bit integers only, which is much cheaper than the
+ * sprintf/sscanf round trip on targets without a floating point unit. */
+typedef struct
+{
+    uint64_t f;
+    int e;
+} MB_JSON_diy_fp;
+
+/* normalized 64-bit significands and binary exponents of 10^-348, 10^-340, ..., 10^340 */
+static const uint64_t MB_JSON_cached_powers_f[] = {
+    UINT64_C(0xfa8fd5a0081c0288), UINT64_C(0xbaaee17fa23ebf76), UINT64_C(0x8b16fb203055ac76),
+    UINT64_C(0xcf42894a5dce35ea), UINT64_C(0x9a6bb0aa55653b2d), UINT64_C(0xe61acf033d1a45df),
+    UINT64_C(0xab70fe17c79ac6ca), UINT64_C(0xff77b1fcbebcdc4f), UINT64_C(0xbe5691ef416bd60c),
+    UINT64_C(0x8dd01fad907ffc3c), UINT64_C(0xd3515c2831559a83), UINT64_C(0x9d71ac8fada6c9b5),
+    UINT64_C(0xea9c227723ee8bcb), UINT64_C(0xaecc49914078536d), UINT64_C(0x823c12795db6ce57),
+    UINT64_C(0xc21094364dfb5637), UINT64_C(0x9096ea6f3848984f), UINT64_C(0xd77485cb25823ac7),
+    UINT64_C(0xa086cfcd97bf97f4), UINT64_C(0xef340a98172aace5), UINT64_C(0xb23867fb2a35b28e),
+    UINT64_C(0x84c8d4dfd2c63f3b), UINT64_C(0xc5dd44271ad3cdba), UINT64_C(0x936b9fcebb25c996),
+    UINT64_C(0xdbac6c247d62a584), UINT64_C(0xa3ab66580d5fdaf6), UINT64_C(0xf3e2f893dec3f126),
+    UINT64_C(0xb5b5ada8aaff80b8), UINT64_C(0x87625f056c7c4a8b), UINT64_C(0xc9bcff6034c13053),
+    UINT64_C(0x964e858c91ba2655), UINT64_C(0xdff9772470297ebd), UINT64_C(0xa6dfbd9fb8e5b88f),
+    UINT64_C(0xf8a95fcf88747d94), UINT64_C(0xb94470938fa89bcf), UINT64_C(0x8a08f0f8bf0f156b),
+    UINT64_C(0xcdb02555653131b6), UINT64_C(0x993fe2c6d07b7fac), UINT64_C(0xe45c10c42a2b3b06),
+    UINT64_C(0xaa242499697392d3), UINT64_C(0xfd87b5f28300ca0e), UINT64_C(0xbce5086492111aeb),
+    UINT64_C(0x8cbccc096f5088cc), UINT64_C(0xd1b71758e219652c), UINT64_C(0x9c40000000000000),
+    UINT64_C(0xe8d4a51000000000), UINT64_C(0xad78ebc5ac620000), UINT64_C(0x813f3978f8940984),
+    UINT64_C(0xc097ce7bc90715b3), UINT64_C(0x8f7e32ce7bea5c70), UINT64_C(0xd5d238a4abe98068),
+    UINT64_C(0x9f4f2726179a2245), UINT64_C(0xed63a231d4c4fb27), UINT64_C(0xb0de65388cc8ada8),
+    UINT64_C(0x83c7088e1aab65db), UINT64_C(0xc45d1df942711d9a), UINT64_C(0x924d692ca61be758),
+    UINT64_C(0xda01ee641a708dea), UINT64_C(0xa26da3999aef774a), UINT64_C(0xf209787bb47d6b85),
+    UINT64_C(0xb454e4a179dd1877), UINT64_C(0x865b86925b9bc5c2), UINT64_C(0xc83553c5c8965d3d),
+    UINT64_C(0x952ab45cfa97a0b3), UINT64_C(0xde469fbd99a05fe3), UINT64_C(0xa59bc234db398c25),
+    UINT64_C(0xf6c69a72a3989f5c), UINT64_C(0xb7dcbf5354e9bece), UINT64_C(0x88fcf317f22241e2),
+    UINT64_C(0xcc20ce9bd35c78a5), UINT64_C(0x98165af37b2153df), UINT64_C(0xe2a0b5dc971f303a),
+    UINT64_C(0xa8d9d1535ce3b396), UINT64_C(0xfb9b7cd9a4a7443c), UINT64_C(0xbb764c4ca7a44410),
+    UINT64_C(0x8bab8eefb6409c1a), UINT64_C(0xd01fef10a657842c), UINT64_C(0x9b10a4e5e9913129),
+    UINT64_C(0xe7109bfba19c0c9d), UINT64_C(0xac2820d9623bf429), UINT64_C(0x80444b5e7aa7cf85),
+    UINT64_C(0xbf21e44003acdd2d), UINT64_C(0x8e679c2f5e44ff8f), UINT64_C(0xd433179d9c8cb841),
+    UINT64_C(0x9e19db92b4e31ba9), UINT64_C(0xeb96bf6ebadf77d9), UINT64_C(0xaf87023b9bf0ee6b)
+};
+
+static const int16_t MB_JSON_cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066
+};
+
+static const uint64_t MB_JSON_powers_of_ten[] = {
+    UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000), UINT64_C(10000),
+    UINT64_C(100000), UINT64_C(1000000), UINT64_C(10000000), UINT64_C(100000000),
+    UINT64_C(1000000000), UINT64_C(10000000000), UINT64_C(100000000000),
+    UINT64_C(1000000000000), UINT64_C(10000000000000), UINT64_C(100000000000000),
+    UINT64_C(1000000000000000), UINT64_C(10000000000000000), UINT64_C(100000000000000000),
+    UINT64_C(1000000000000000000), UINT64_C(10000000000000000000)};
+
+static MB_JSON_diy_fp MB_JSON_diy_fp_multiply(MB_JSON_diy_fp x, MB_JSON_diy_fp y)
+{
+    const uint64_t mask = UINT64_C(0xFFFFFFFF);
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & mask;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & mask;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & mask) + (bc & mask);
+    MB_JSON_diy_fp r;
+
+    tmp += UINT64_C(1) << 31; /* round */
+    r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+    r.e = x.e + y.e + 64;
+    return r;
+}
+
+static MB_JSON_diy_fp MB_JSON_diy_fp_normalize(MB_JSON_diy_fp x)
+{
+    while (!(x.f & (UINT64_C(1) << 63)))
+    {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
+
+/* the cached power c ~ 10^-k that brings the exponent e into [-59, -32] */
+static MB_JSON_diy_fp MB_JSON_cached_power(int e, int *k)
+{
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int ik = (int)dk;
+    unsigned index = 0;
+    MB_JSON_diy_fp c;
+
+    if (dk - ik > 0.0)
+    {
+        ik++;
+    }
+    index = (unsigned)((ik >> 3) + 1);
+    *k = -(-348 + (int)(index << 3));
+    c.f = MB_JSON_cached_powers_f[index];
+    c.e = MB_JSON_cached_powers_e[index];
+    return c;
+}
+
+static void MB_JSON_grisu_round(char *digits, int length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+    while ((rest < wp_w) && (delta - rest >= ten_kappa) &&
+           ((rest + ten_kappa < wp_w) || (wp_w - rest > rest + ten_kappa - wp_w)))
+    {
+        digits[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static int MB_JSON_count_digits(uint32_t n)
+{
+    int count = 1;
+    while (n >= 10)
+    {
+        n /= 10;
+        count++;
+    }
+    return count;
+}
+
+static void MB_JSON_grisu_digits(MB_JSON_diy_fp w, MB_JSON_diy_fp mp, uint64_t delta, char *digits, int *length, int *k)
+{
+    MB_JSON_diy_fp one;
+    uint64_t wp_w = mp.f - w.f;
+    uint32_t p1 = 0;
+    uint64_t p2 = 0;
+    int kappa = 0;
+
+    one.e = mp.e;
+    one.f = UINT64_C(1) << -one.e;
+    p1 = (uint32_t)(mp.f >> -one.e);
+    p2 = mp.f & (one.f - 1);
+    kappa = MB_JSON_count_digits(p1);
+    *length = 0;
+
+    while (kappa > 0)
+    {
+        uint32_t d = p1 / (uint32_t)MB_JSON_powers_of_ten[kappa - 1];
+        uint64_t rest = 0;
+
+        p1 %= (uint32_t)MB_JSON_powers_of_ten[kappa - 1];
+        if (d || *length)
+        {
+            digits[(*length)++] = (char)('0' + d);
+        }
+        kappa--;
+        rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta)
+        {
+            *k += kappa;
+            MB_JSON_grisu_round(digits, *length, delta, rest, MB_JSON_powers_of_ten[kappa] << -one.e, wp_w);
+            return;
+        }
+    }
+
+    for (;;)
+    {
+        char d = 0;
+
+        p2 *= 10;
+        delta *= 10;
+        d = (char)(p2 >> -one.e);
+        if (d || *length)
+        {
+            digits[(*length)++] = (char)('0' + d);
+        }
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *k += kappa;
+            MB_JSON_grisu_round(digits, *length, delta, p2, one.f, (-kappa < 20) ? wp_w * MB_JSON_powers_of_ten[-kappa] : 0);
+            return;
+        }
+    }
+}
+
+/* Generate the shortest digits of a positive finite d, so that d = digits * 10^k */
+static void MB_JSON_grisu2(double d, char *digits, int *length, int *k)
+{
+    MB_JSON_diy_fp v;
+    MB_JSON_diy_fp plus;
+    MB_JSON_diy_fp minus;
+    MB_JSON_diy_fp c;
+    uint64_t bits = 0;
+    int biased_e = 0;
+
+    memcpy(&bits, &d, sizeof(bits));
+    biased_e = (int)((bits >> 52) & 0x7FF);
+    v.f = bits & ((UINT64_C(1) << 52) - 1);
+    if (biased_e != 0)
+    {
+        v.f += UINT64_C(1) << 52;
+        v.e = biased_e - 1075;
+    }
+    else
+    {
+        v.e = -1074;
+    }
+
+    /* boundaries halfway to the neighbouring doubles */
+    plus.f = (v.f << 1) + 1;
+    plus.e = v.e - 1;
+    while (!(plus.f & (UINT64_C(1) << 53)))
+    {
+        plus.f <<= 1;
+        plus.e--;
+    }
+    plus.f <<= 10;
+    plus.e -= 10;
+    if (v.f == (UINT64_C(1) << 52))
+    {
+        minus.f = (v.f << 2) - 1;
+        minus.e = v.e - 2;
+    }
+    else
+    {
+        minus.f = (v.f << 1) - 1;
+        minus.e = v.e - 1;
+    }
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    c = MB_JSON_cached_power(plus.e, k);
+    v = MB_JSON_diy_fp_multiply(MB_JSON_diy_fp_normalize(v), c);
+    plus = MB_JSON_diy_fp_multiply(plus, c);
+    minus = MB_JSON_diy_fp_multiply(minus, c);
+    minus.f++;
+    plus.f--;
+    MB_JSON_grisu_digits(v, plus, plus.f - minus.f, digits, length, k);
+}
+
+/* Print the number nicely into a buffer of 26 bytes, returns the length or -1.
+ * The shortest digits that read back as the same double are laid out the way
+ * "%1.15g" would (or "%1.17g" for 16 and 17 digits). */
+static int MB_JSON_format_number(double d, unsigned char *const number_buffer)
+{
+    char digits[20];
+    uint64_t bits = 0;
+    int count = 0;
+    int k = 0;
+    int exponent = 0;
+    int length = 0;
+    int i = 0;
+
+    /* This checks for NaN and Infinity */
+    if (isnan(d) || isinf(d))
+    {
+        memcpy(number_buffer, "null", sizeof("null"));
+        return 4;
+    }
+
+    memcpy(&bits, &d, sizeof(bits));
+    if (bits >> 63)
+    {
+        number_buffer[length++] = '-';
+        d = -d;
+    }
+
+    if (d == 0)
+    {
+        number_buffer[length++] = '0';
+        number_buffer[length] = '\0';
+        return length;
+    }
+
+    MB_JSON_grisu2(d, digits, &count, &k);
+
+    /* decimal exponent of the first digit */
+    exponent = count + k - 1;
+
+    if ((exponent < -4) || (exponent >= ((count > 15) ? 17 : 15)))
+    {
+        number_buffer[length++] = (unsigned char)digits[0];
+        if (count > 1)
+        {
+            number_buffer[length++] = '.';
+            memcpy(number_buffer + length, digits + 1, (size_t)(count - 1));
+            length += count - 1;
+        }
+        number_buffer[length++] = 'e';
+        number_buffer[length++] = (exponent < 0) ? '-' : '+';
+        if (exponent < 0)
+        {
+            exponent = -exponent;
+        }
+        if (exponent >= 100)
+        {
+            number_buffer[length++] = (unsigned char)('0' + exponent / 100);
+            exponent %= 100;
+        }
+        number_buffer[length++] = (unsigned char)('0' + exponent / 10);
+        number_buffer[length++] = (unsigned char)('0' + exponent % 10);
+    }
+    else if (k >= 0)
+    {
+        memcpy(number_buffer + length, digits, (size_t)count);
+        length += count;
+        for (i = 0; i < k; i++)
+        {
+            number_buffer[length++] = '0';
+        }
+    }
+    else if (exponent >= 0)
+    {
+        memcpy(number_buffer + length, digits, (size_t)(exponent + 1));
+        length += exponent + 1;
+        number_buffer[length++] = '.';
+        memcpy(number_buffer + length, digits + exponent + 1, (size_t)(count - exponent - 1));
+        length += count - exponent - 1;
+    }
+    else
+    {
+        number_buffer[length++] = '0';
+        number_buffer[length++] = '.';
+        for (i = exponent + 1; i < 0; i++)
+        {
+            number_buffer[length++] = '0';
+        }
+        memcpy(number_buffer + length, digits, (size_t)count);
+        length += count;
+    }
+
+    number_buffer[length] = '\0';
+    return length;
+}
+
+MB_JSON_PUBLIC(int)
+MB_JSON_FormatNumber(double number, char *buffer)
+{
+    if (buffer == NULL)
+    {
+        return -1;
+    }
+
+    return MB_JSON_format_number(number, (unsigned char *)buffer);
+}
+
+static MB_JSON_bool MB_JSON_get_number_buffer_length(const MB_JSON *const item, MB_JSON_buffer_len_data_t *const buf_len)
+{
+    unsigned char number_buffer[26] = {0};
+    int length = MB_JSON_format_number(item->valuedouble, number_buffer);
+
+    if (length < 0)
+    {
+        return false;
+    }
+
+    buf_len->size += (size_t)length;
+    return true;
+}
+
+/* Render the number nicely from the given item into a string. */
+static MB_JSON_bool MB_JSON_print_number(const MB_JSON *const item, MB_JSON_printbuffer *const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    int length = 0;
+    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    length = MB_JSON_format_number(item->valuedouble, number_buffer);
+    if (length < 0)
+    {
+        return false;
+    }
+
+    /* reserve appropriate space in the output */
+    output_pointer = MB_JSON_ensure(output_buffer, (size_t)length + sizeof(""));
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+
+    /* the number is formatted without the locale, so it always uses '.' */
+    memcpy(output_pointer, number_buffer, (size_t)length + sizeof(""));
+
+    output_buffer->offset += (size_t)length;
+
+    return true;
+}
+
+/* parse 4 digit hexadecimal number */
+static unsigned MB_JSON_parse_hex4(const unsigned char *const input)
+{
+    unsigned int h = 0;
+    size_t i = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        /* parse digit */
+        if ((input[i] >= '0') && (input[i] <= '9'))
+        {
+            h += (unsigned int)input[i] - '0';
+        }
+        else if ((input[i] >= 'A') && (input[i] <= 'F'))
+        {
+            h += (unsigned int)10 + input[i] - 'A';
+        }
+        else if ((input[i] >= 'a') && (input[i] <= 'f'))
+        {
+            h += (unsigned int)10 + input[i] - 'a';
+        }
+        else /* invalid */
+        {
+            return 0;
+        }
+
+        if (i < 3)
+        {
+            /* shift left to make place for the next nibble */
+            h = h << 4;
+        }
+    }
+
+    return h;
+}
+
+/* converts a UTF-16 literal to UTF-8
+ * A literal can be one or two sequences of the form \uXXXX */
+static unsigned char MB_JSON_utf16_literal_to_utf8(const unsigned char *const input_pointer, const unsigned char *const input_end, unsigned char **output_pointer)
+{
+    long unsigned int codepoint = 0;
+    unsigned int first_code = 0;
+    const unsigned char *first_sequence = input_pointer;
+    unsigned char utf8_length = 0;
+    unsigned char utf8_position = 0;
+    unsigned char sequence_length = 0;
+    unsigned char first_byte_mark = 0;
+
+    if ((input_end - first_sequence) < 6)
+    {
+        /* input ends unexpectedly */
+        goto fail;
+    }
+
+    /* get the first utf16 sequence */
+    first_code = MB_JSON_parse_hex4(first_sequence + 2);
+
+    /* check that the code is valid */
+    if (((first_code >= 0xDC00) && (first_code <= 0xDFFF)))
+    {
+        goto fail;
+    }
+
+    /* UTF16 surrogate pair */
+    if ((first_code >= 0xD800) && (first_code <= 0xDBFF))
+    {
+        const unsigned char *second_sequence = first_sequence + 6;
+        unsigned int second_code = 0;
+        sequence_length = 12; /* \uXXXX\uXXXX */
+
+        if ((input_end - second_sequence) < 6)
+        {
+            /* input ends unexpectedly */
+            goto fail;
+        }
+
+        if ((second_sequence[0] != '\\') || (second_sequence[1] != 'u'))
+        {
+            /* missing second half of the surrogate pair */
+            goto fail;
+        }
+
+        /* get the second utf16 sequence */
+        second_code = MB_JSON_parse_hex4(second_sequence + 2);
+        /* check that the code is valid */
+        if ((second_code < 0xDC00) || (second_code > 0xDFFF))
+        {
+            /* invalid second half of the surrogate pair */
+            goto fail;
+        }
+
+        /* calculate the unicode codepoint from the surrogate pair */
+        codepoint = 0x10000 + (((first_code & 0x3FF) << 10) | (second_code & 0x3FF));
+    }
+    else
+    {
+        sequence_length = 6; /* \uXXXX */
+        codepoint = first_code;
+    }
+
+    /* encode as UTF-8
+     * takes at maximum 4 bytes to encode:
+     * 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx */
+    if (codepoint < 0x80)
+    {
+        /* normal ascii, encoding 0xxxxxxx */
+        utf8_length = 1;
+    }
+    else if (codepoint < 0x800)
+    {
+        /* two bytes, encoding 110xxxxx 10xxxxxx */
+        utf8_length = 2;
+        first_byte_mark = 0xC0; /* 11000000 */
+    }
+    else if (codepoint < 0x10000)
+    {
+        /* three bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx */
+        utf8_length = 3;
+        first_byte_mark = 0xE0; /* 11100000 */
+    }
+    else if (codepoint <= 0x10FFFF)
+    {
+        /* four bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx 10xxxxxx */
+        utf8_length = 4;
+        first_byte_mark = 0xF0; /* 11110000 */
+    }
+    else
+    {
+        /* invalid unicode codepoint */
+        goto fail;
+    }
+
+    /* encode as utf8 */
+    for (utf8_position = (unsigned char)(utf8_length - 1); utf8_position > 0; utf8_position--)
+    {
+        /* 10xxxxxx */
+        (*output_pointer)[utf8_position] = (unsigned char)((codepoint | 0x80) & 0xBF);
+        codepoint >>= 6;
+    }
+    /* encode first byte */
+    if (utf8_length > 1)
+    {
+        (*output_pointer)[0] = (unsigned char)((codepoint | first_byte_mark) & 0xFF);
+    }
+    else
+    {
+        (*output_pointer)[0] = (unsigned char)(codepoint & 0x7F);
+    }
+
+    *output_pointer += utf8_length;
+
+    return sequence_length;
+
+fail:
+    return 0;
+}
+
+/* Parse the input text into an unescaped cinput, and populate item. */
+static MB_JSON_bool MB_JSON_parse_string(MB_JSON *const item, MB_JSON_parse_buffer *const input_buffer)
+{
+    const unsigned char *input_pointer = MB_JSON_buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = MB_JSON_buffer_at_offset(input_buffer) + 1;
+    unsigned char *output_pointer = NULL;
+    unsigned char *output = NULL;
+
+    /* not a string */
+    if (MB_JSON_buffer_at_offset(input_buffer)[0] != '\"')
+    {
+        goto fail;
+    }
+
+    {
+        /* calculate approximate size of the output (overestimate) */
+        size_t allocation_length = 0;
+        size_t skipped_bytes = 0;
+        while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
+        {
+            /* is escape sequence */
+            if (input_end[0] == '\\')
+            {
+                if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
+                {
+                    /* prevent buffer overflow when last input character is a backslash */
+                    goto fail;
+                }
+                skipped_bytes++;
+                input_end++;
+            }
+            input_end++;
+        }
+        if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+        {
+            goto fail; /* string ended unexpectedly */
+        }
+
+        /* This is at most how much we need for the output */
+        allocation_length = (size_t)(input_end - MB_JSON_buffer_at_offset(input_buffer)) - skipped_bytes;
+        output = (unsigned char *)input_buffer->hooks.allocate(allocation_length + sizeof(""));
+        if (output == NULL)
+        {
+            goto fail; /* allocation failure */
+        }
+    }
+
+    output_pointer = output;
+    /* loop through the string literal */
+    while (input_pointer < input_end)
+    {
+        if (*input_pointer != '\\')
+        {
+            *output_pointer++ = *input_pointer++;
+        }
+        /* escape sequence */
+        else
+        {
+            unsigned char sequence_length = 2;
+            if ((input_end - input_pointer) < 1)
+            {
+                goto fail;
+            }
+
+            switch (input_pointer[1])
+            {
+            case 'b':
+                *output_pointer++ = '\b';
+                break;
+            case 'f':
+                *output_pointer++ = '\f';
+                break;
+            case 'n':
+                *output_pointer++ = '\n';
+                break;
+            case 'r':
+                *output_pointer++ = '\r';
+                break;
+            case 't':
+                *output_pointer++ = '\t';
+                break;
+            case '\"':
+            case '\\':
+            case '/':
+                *output_pointer++ = input_pointer[1];
+                break;
+
+            /* UTF-16 literal */
+            case 'u':
+                sequence_length = MB_JSON_utf16_literal_to_utf8(input_pointer, input_end, &output_pointer);
+                if (sequence_length == 0)
+                {
+                    /* failed to convert UTF16-literal to UTF-8 */
+                    goto fail;
+                }
+                break;
+
+            default:
+                goto fail;
+            }
+            input_pointer += sequence_length;
+        }
+    }
+
+    /* zero terminate the output */
+    *output_pointer = '\0';
+
+    item->type = MB_JSON_String;
+    item->valuestring = (char *)output;
+
+    input_buffer->offset = (size_t)(input_end - input_buffer->content);
+    input_buffer->offset++;
+
+    return true;
+
+fail:
+    if (output != NULL)
+    {
+        input_buffer->hooks.deallocate(output);
+    }
+
+    if (input_pointer != NULL)
+    {
+        input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+    }
+
+    return false;
+}
+
+static MB_JSON_bool MB_JSON_get_string_buffer_length_ptr(const unsigned char *const input, MB_JSON_buffer_len_data_t *const buf_len)
+{
+    const unsigned char *input_pointer = NULL;
+    size_t output_length = 0;
+    /* numbers of additional characters needed for escaping */
+    size_t escape_characters = 0;
+
+    if (input == NULL)
+    {
+        buf_len->size += 2;
+
+        return true;
+    }
+
+    /* set "flag" to 1 if something needs to be escaped */
+    for (input_pointer = input; *input_pointer; input_pointer++)
+    {
+        switch (*input_pointer)
+        {
+        case '\"':
+        case '\\':
+        case '\b':
+        case '\f':
+        case '\n':
+        case '\r':
+        case '\t':
+            /* one character escape sequence */
+            escape_characters++;
+            break;
+        default:
+            if (*input_pointer < 32)
+            {
+                /* UTF-16 escape sequence uXXXX */
+                escape_characters += 5;
+            }
+            break;
+        }
+    }
+    output_length = (size_t)(input_pointer - input) + escape_characters + 2;
+
+    buf_len->size += output_length;
+
+    return true;
+}
+
+/* Render the cstring provided to an escaped version that can be printed. */
+static MB_JSON_bool MB_JSON_print_string_ptr(const unsigned char *const input, MB_JSON_printbuffer *const output_buffer)
+{
+    const unsigned char *input_pointer = NULL;
     unsigned char *output = NULL;
+    unsigned char *output_pointer = NULL;
+    size_t output_length = 0;
+    /* numbers of additional characters needed for escaping */
+    size_t escape_characters = 0;
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    /* empty string */
+    if (input == NULL)
+    {
+        output = MB_JSON_ensure(output_buffer, sizeof("\"\""));
+        if (output == NULL)
+        {
+            return false;
+        }
+        strcpy((char *)output, "\"\"");
+
+        return true;
+    }
+
+    /* set "flag" to 1 if something needs to be escaped */
+    for (input_pointer = input; *input_pointer; input_pointer++)
+    {
+        switch (*input_pointer)
+        {
+        case '\"':
+        case '\\':
+        case '\b':
+        case '\f':
+        case '\n':
+        case '\r':
+        case '\t':
+            /* one character escape sequence */
+            escape_characters++;
+            break;
+        default:
+            if (*input_pointer < 32)
+            {
+                /* UTF-16 escape sequence uXXXX */
+                escape_characters += 5;
+            }
+            break;
+        }
+    }
+    output_length = (size_t)(input_pointer - input) + escape_characters;
+
+    output = MB_JSON_ensure(output_buffer, output_length + sizeof("\"\""));
+    if (output == NULL)
+    {
+        return false;
+    }
+
+    /* no characters have to be escaped */
+    if (escape_characters == 0)
+    {
+        output[0] = '\"';
+        memcpy(output + 1, input, output_length);
+        output[output_length + 1] = '\"';
+        output[output_length + 2] = '\0';
+
+        return true;
+    }
+
+    output[0] = '\"';
+    output_pointer = output + 1;
+    /* copy the string */
+    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+    {
+        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
+        {
+            /* normal character, copy */
+            *output_pointer = *input_pointer;
+        }
+        else
+        {
+            /* character needs to be escaped */
+            *output_pointer++ = '\\';
+            switch (*input_pointer)
+            {
+            case '\\':
+                *output_pointer = '\\';
+                break;
+            case '\"':
+                *output_pointer = '\"';
+                break;
+            case '\b':
+                *output_pointer = 'b';
+                break;
+            case '\f':
+                *output_pointer = 'f';
+                break;
+            case '\n':
+                *output_pointer = 'n';
+                break;
+            case '\r':
+                *output_pointer = 'r';
+                break;
+            case '\t':
+                *output_pointer = 't';
+                break;
+            default:
+                /* escape and print as unicode codepoint */
+                sprintf((char *)output_pointer, "u%04x", *input_pointer);
+                output_pointer += 4;
+                break;
+            }
+        }
+    }
+    output[output_length + 1] = '\"';
+    output[output_length + 2] = '\0';
+
+    return true;
+}
+
+static MB_JSON_bool MB_JSON_get_string_buffer_length(const MB_JSON *const item, MB_JSON_buffer_len_data_t *const buf_len)
+{
+    return MB_JSON_get_string_buffer_length_ptr((unsigned char *)item->valuestring, buf_len);
+}
+
+/* Invoke print_string_ptr (which is useful) on an item. */
+static MB_JSON_bool MB_JSON_print_string(const MB_JSON *const item, MB_JSON_printbuffer *const p)
+{
+    return MB_JSON_print_string_ptr((unsigned char *)item->valuestring, p);
+}
+
+/* Predeclare these prototypes. */
+static MB_JSON_bool MB_JSON_parse_value(MB_JSON *const item, MB_JSON_parse_buffer *const input_buffer);
+static MB_JSON_bool MB_JSON_print_value(const MB_JSON *const item, MB_JSON_printbuffer *const output_buffer);
+static MB_JSON_bool MB_JSON_parse_array(MB_JSON *const item, MB_JSON_parse_buffer *const input_buffer);
+static MB_JSON_bool MB_JSON_print_array(const MB_JSON *const item, MB_JSON_printbuffer *const output_buffer);
+static MB_JSON_bool MB_JSON_parse_object(MB_JSON *const item, MB_JSON_parse_buffer *const input_buffer);
+static MB_JSON_bool MB_JSON_print_object(const MB_JSON *const item, MB_JSON_printbuffer *const output_buffer);
+
+static MB_JSON_bool MB_JSON_get_object_buffer_length(const MB_JSON *const item, MB_JSON_buffer_len_data_t *const buf_len);
+static MB_JSON_bool MB_JSON_get_array_buffer_length(const MB_JSON *const item, MB_JSON_buffer_len_data_t *const buf_len);
+static MB_JSON_bool MB_JSON_get_value_buffer_length(const MB_JSON *const item, MB_JSON_buffer_len_data_t *const buf_len);
+static MB_JSON_bool MB_JSON_add_item_to_array(MB_JSON *array, MB_JSON *item);
+
+/* Utility to jump whitespace and cr/lf */
+static MB_JSON_parse_buffer *MB_JSON_buffer_skip_whitespace(MB_JSON_parse_buffer *const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL))
+    {
+        return NULL;
+    }
+
+    if (MB_JSON_cannot_access_at_index(buffer, 0))
+    {
+        return buffer;
+    }
+
+    while (MB_JSON_can_access_at_index(buffer, 0) && (MB_JSON_buffer_at_offset(buffer)[0] <= 32))
+    {
+        buffer->offset++;
+    }
+
+    if (buffer->offset == buffer->length)
+    {
+        buffer->offset--;
+    }
+
+    return buffer;
+}
+
+/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
+static MB_JSON_parse_buffer *MB_JSON_skip_utf8_bom(MB_JSON_parse_buffer *const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    {
+        return NULL;
+    }
+
+    if (MB_JSON_can_access_at_index(buffer, 4) && (strncmp((const char *)MB_JSON_buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+    {
+        buffer->offset += 3;
+    }
+
+    return buffer;
+}
+
+MB_JSON_PUBLIC(MB_JSON *)
+MB_JSON_ParseWithOpts(const char *value, const char **return_parse_end, MB_JSON_bool require_null_terminated)
+{
+    size_t buffer_length;
+
+    if (NULL == value)
+    {
+        return NULL;
+    }
+
+    /* Adding null character size due to require_null_terminated. */
+    buffer_length = strlen(value) + sizeof("");
+
+    return MB_JSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+}
+
+/* Parse an object - create a new root, and populate. */
+MB_JSON_PUBLIC(MB_JSON *)
+MB_JSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, MB_JSON_bool require_null_terminated)
+{
+    MB_JSON_parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}};
+    MB_JSON *item = NULL;
+
+    /* reset error position */
+    MB_JSON_global_error.json = NULL;
+    MB_JSON_global_error.position = 0;
+
+    if (value == NULL || 0 == buffer_length)
+    {
+        goto fail;
+    }
+
+    buffer.content = (const unsigned char *)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = MB_JSON_global_hooks;
+
+    item = MB_JSON_New_Item(&MB_JSON_global_hooks);
+    if (item == NULL) /* memory fail */
+    {
+        goto fail;
+    }
+
+    if (!MB_JSON_parse_value(item, MB_JSON_buffer_skip_whitespace(MB_JSON_skip_utf8_bom(&buffer))))
+    {
+        /* parse failure. ep is set. */
+        goto fail;
+    }
+
+    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
+    if (require_null_terminated)
+    {
+        MB_JSON_buffer_skip_whitespace(&buffer);
+        if ((buffer.offset >= buffer.length) || MB_JSON_buffer_at_offset(&buffer)[0] != '\0')
+        {
+            goto fail;
+        }
+    }
+    if (return_parse_end)
+    {
+        *return_parse_end = (const char *)MB_JSON_buffer_at_offset(&buffer);
+    }
+
+    return item;
+
+fail:
+    if (item != NULL)
+    {
+        MB_JSON_Delete(item);
+    }
+
+    if (value != NULL)
+    {
+        MB_JSON_error local_error;
+        local_error.json = (const unsigned char *)value;
+        local_error.position = 0;
+
+        if (buffer.offset < buffer.length)
+        {
+            local_error.position = buffer.offset;
+        }
+        else if (buffer.length > 0)
+        {
+            local_error.position = buffer.length - 1;
+        }
+
+        if (return_parse_end != NULL)
+        {
+            *return_parse_end = (const char *)local_error.json + local_error.position;
+        }
+
+        MB_JSON_global_error = local_error;
+    }
+
+    return NULL;
+}
+
+/* Default options for MB_JSON_Parse */
+MB_JSON_PUBLIC(MB_JSON *)
+MB_JSON_Parse(const char *value)
+{
+    return MB_JSON_ParseWithOpts(value, 0, 0);
+}
+
+MB_JSON_PUBLIC(MB_JSON *)
+MB_JSON_ParseWithLength(const char *value, size_t buffer_length)
+{
+    return MB_JSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+}
+
+/* Incremental parser */
+
+typedef enum
+{
+    MB_JSON_stream_value,
+    MB_JSON_stream_value_or_end,
+    MB_JSON_stream_key,
+    MB_JSON_stream_key_or_end,
+    MB_JSON_stream_colon,
+    MB_JSON_stream_after_value,
+    MB_JSON_stream_string,
+    MB_JSON_stream_escape,
+    MB_JSON_stream_unicode,
+    MB_JSON_stream_surrogate_backslash,
+    MB_JSON_stream_surrogate_u,
+    MB_JSON_stream_number,
+    MB_JSON_stream_literal,
+    MB_JSON_stream_done,
+    MB_JSON_stream_error
+} MB_JSON_stream_state;
+
+struct MB_JSON_Stream
+{
+    MB_JSON *root;
+    /* open arrays and objects, innermost last */
+    MB_JSON **stack;
+    size_t depth;
+    size_t stack_size;
+    /* name of the next member of the innermost object */
+    char *key;
+    /* the string or number being read, strings are unescaped */
+    unsigned char *token;
+    size_t token_length;
+    size_t token_size;
+    size_t position;
+    unsigned int codepoint;
+    unsigned int high_surrogate;
+    unsigned char hex_digits;
+    MB_JSON_bool string_is_key;
+    /* the rest of true, false or null to match */
+    const char *literal;
+    int literal_type;
+    MB_JSON_stream_state state;
+    MB_JSON_internal_hooks hooks;
+};
+
+static MB_JSON_bool MB_JSON_stream_push_token(MB_JSON_Stream *const stream, unsigned char c)
+{
+    if (stream->token_length + 1 >= stream->token_size)
+    {
+        size_t new_size = (stream->token_size == 0) ? 32 : stream->token_size * 2;
+        unsigned char *new_token = NULL;
+        if (stream->hooks.reallocate != NULL)
+        {
+            new_token = (unsigned char *)stream->hooks.reallocate(stream->token, new_size);
+        }
+        else
+        {
+            new_token = (unsigned char *)stream->hooks.allocate(new_size);
+            if ((new_token != NULL) && (stream->token != NULL))
+            {
+                memcpy(new_token, stream->token, stream->token_length);
+                stream->hooks.deallocate(stream->token);
+            }
+        }
+        if (new_token == NULL)
+        {
+            return false;
+        }
+        stream->token = new_token;
+        stream->token_size = new_size;
+    }
+    stream->token[stream->token_length++] = c;
+    return true;
+}
+
+/* append a code point as UTF-8 */
+static MB_JSON_bool MB_JSON_stream_push_utf8(MB_JSON_Stream *const stream, unsigned long codepoint)
+{
+    unsigned char utf8[4];
+    unsigned char utf8_length = 0;
+    unsigned char i = 0;
+
+    if (codepoint < 0x80)
+    {
+        return MB_JSON_stream_push_token(stream, (unsigned char)codepoint);
+    }
+    else if (codepoint < 0x800)
+    {
+        utf8_length = 2;
+        utf8[0] = (unsigned char)(0xC0 | (codepoint >> 6));
+    }
+    else if (codepoint < 0x10000)
+    {
+        utf8_length = 3;
+        utf8[0] = (unsigned char)(0xE0 | (codepoint >> 12));
+    }
+    else
+    {
+        utf8_length = 4;
+        utf8[0] = (unsigned char)(0xF0 | (codepoint >> 18));
+    }
+    for (i = 1; i < utf8_length; i++)
+    {
+        utf8[i] = (unsigned char)(0x80 | ((codepoint >> (6 * (utf8_length - 1 - i))) & 0x3F));
+    }
+    for (i = 0; i < utf8_length; i++)
+    {
+        if (!MB_JSON_stream_push_token(stream, utf8[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* copy of the token with its exact size */
+static char *MB_JSON_stream_take_token(MB_JSON_Stream *const stream)
+{
+    char *copy = (char *)stream->hooks.allocate(stream->token_length + sizeof(""));
+    if (copy != NULL)
+    {
+        if (stream->token_length > 0)
+        {
+            memcpy(copy, stream->token, stream->token_length);
+        }
+        copy[stream->token_length] = '\0';
+    }
+    stream->token_length = 0;
+    return copy;
+}
+
+/* link a new value to the innermost array or object, or make it the root */
+static MB_JSON_bool MB_JSON_stream_add(MB_JSON_Stream *const stream, MB_JSON *const item)
+{
+    if (stream->depth == 0)
+    {
+        stream->root = item;
+        stream->state = MB_JSON_stream_done;
+        return true;
+    }
+
+    if (stream->stack[stream->depth - 1]->type == MB_JSON_Object)
+    {
+        item->string = stream->key;
+        stream->key = NULL;
+    }
+    MB_JSON_add_item_to_array(stream->stack[stream->depth - 1], item);
+    stream->state = MB_JSON_stream_after_value;
+    return true;
+}
+
+static MB_JSON_bool MB_JSON_stream_open(MB_JSON_Stream *const stream, int type)
+{
+    MB_JSON *item = NULL;
+
+    if (stream->depth >= MB_JSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+
+    if (stream->depth == stream->stack_size)
+    {
+        size_t new_size = (stream->stack_size == 0) ? 8 : stream->stack_size * 2;
+        MB_JSON **new_stack = (MB_JSON **)stream->hooks.allocate(new_size * sizeof(MB_JSON *));
+        if (new_stack == NULL)
+        {
+            return false;
+        }
+        if (stream->stack != NULL)
+        {
+            memcpy(new_stack, stream->stack, stream->depth * sizeof(MB_JSON *));
+            stream->hooks.deallocate(stream->stack);
+        }
+        stream->stack = new_stack;
+        stream->stack_size = new_size;
+    }
+
+    item = MB_JSON_New_Item(&stream->hooks);
+    if (item == NULL)
+    {
+        return false;
+    }
+    item->type = type;
+    MB_JSON_stream_add(stream, item);
+    stream->stack[stream->depth++] = item;
+    stream->state = (type == MB_JSON_Object) ? MB_JSON_stream_key_or_end : MB_JSON_stream_value_or_end;
+    return true;
+}
+
+static MB_JSON_bool MB_JSON_stream_close(MB_JSON_Stream *const stream, unsigned char c)
+{
+    if ((stream->depth == 0) || (stream->stack[stream->depth - 1]->type != ((c == '}') ? MB_JSON_Object : MB_JSON_Array)))
+    {
+        return false;
+    }
+    stream->depth--;
+    stream->state = (stream->depth == 0) ? MB_JSON_stream_done : MB_JSON_stream_after_value;
+    return true;
+}
+
+static MB_JSON_bool MB_JSON_stream_end_string(MB_JSON_Stream *const stream)
+{
+    char *string = NULL;
+    MB_JSON *item = NULL;
+
+    if (stream->string_is_key)
+    {
+        /* The token buffer is only allocated once a character is stored */
+        stream->key = MB_JSON_key_new((stream->token != NULL) ? (const char *)stream->token : "", stream->token_length, &stream->hooks);
+        stream->token_length = 0;
+        stream->state = MB_JSON_stream_colon;
+        return (stream->key != NULL);
+    }
+
+    string = MB_JSON_stream_take_token(stream);
+    if (string == NULL)
+    {
+        return false;
+    }
+
+    item = MB_JSON_New_Item(&stream->hooks);
+    if (item == NULL)
+    {
+        stream->hooks.deallocate(string);
+        return false;
+    }
+    item->type = MB_JSON_String;
+    item->valuestring = string;
+    return MB_JSON_stream_add(stream, item);
+}
+
+static MB_JSON_bool MB_JSON_stream_end_number(MB_JSON_Stream *const stream)
+{
+    MB_JSON_parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}};
+    MB_JSON *item = MB_JSON_New_Item(&stream->hooks);
+
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    buffer.content = stream->token;
+    buffer.length = stream->token_length;
+    if (!MB_JSON_parse_number(item, &buffer) || (buffer.offset != stream->token_length))
+    {
+        stream->hooks.deallocate(item);
+        return false;
+    }
+    stream->token_length = 0;
+    return MB_JSON_stream_add(stream, item);
+}
+
+/* Start of a value, false if c can't start one */
+static MB_JSON_bool MB_JSON_stream_begin_value(MB_JSON_Stream *const stream, unsigned char c)
+{
+    switch (c)
+    {
+    case '{':
+        return MB_JSON_stream_open(stream, MB_JSON_Object);
+    case '[':
+        return MB_JSON_stream_open(stream, MB_JSON_Array);
+    case '\"':
+        stream->string_is_key = false;
+        stream->state = MB_JSON_stream_string;
+        return true;
+    case 't':
+        stream->literal = "rue";
+        stream->literal_type = MB_JSON_True;
+        stream->state = MB_JSON_stream_literal;
+        return true;
+    case 'f':
+        stream->literal = "alse";
+        stream->literal_type = MB_JSON_False;
+        stream->state = MB_JSON_stream_literal;
+        return true;
+    case 'n':
+        stream->literal = "ull";
+        stream->literal_type = MB_JSON_NULL;
+        stream->state = MB_JSON_stream_literal;
+        return true;
+    default:
+        if ((c == '-') || ((c >= '0') && (c <= '9')))
+        {
+            stream->state = MB_JSON_stream_number;
+            return MB_JSON_stream_push_token(stream, c);
+        }
+        return false;
+    }
+}
+
+/* Feed one character, false on a syntax or allocation error */
+static MB_JSON_bool MB_JSON_stream_feed_char(MB_JSON_Stream *const stream, unsigned char c)
+{
+    switch (stream->state)
+    {
+    case MB_JSON_stream_value:
+        return (c <= 32) || MB_JSON_stream_begin_value(stream, c);
+
+    case MB_JSON_stream_value_or_end:
+        if (c <= 32)
+        {
+            return true;
+        }
+        if (c == ']')
+        {
+            return MB_JSON_stream_close(stream, c);
+        }
+        return MB_JSON_stream_begin_value(stream, c);
+
+    case MB_JSON_stream_key_or_end:
+        if (c == '}')
+        {
+            return MB_JSON_stream_close(stream, c);
+        }
+        /* fall through */
+    case MB_JSON_stream_key:
+        if (c <= 32)
+        {
+            return true;
+        }
+        if (c != '\"')
+        {
+            return false;
+        }
+        stream->string_is_key = true;
+        stream->state = MB_JSON_stream_string;
+        return true;
+
+    case MB_JSON_stream_colon:
+        if (c <= 32)
+        {
+            return true;
+        }
+        stream->state = MB_JSON_stream_value;
+        return c == ':';
+
+    case MB_JSON_stream_after_value:
+        if (c <= 32)
+        {
+            return true;
+        }
+        if (c == ',')
+        {
+            stream->state = (stream->stack[stream->depth - 1]->type == MB_JSON_Object) ? MB_JSON_stream_key : MB_JSON_stream_value;
+            return true;
+        }
+        return ((c == ']') || (c == '}')) && MB_JSON_stream_close(stream, c);
+
+    case MB_JSON_stream_string:
+        if (c == '\"')
+        {
+            return MB_JSON_stream_end_string(stream);
+        }
+        if (c == '\\')
+        {
+            stream->state = MB_JSON_stream_escape;
+            return true;
+        }
+        return MB_JSON_stream_push_token(stream, c);
+
+    case MB_JSON_stream_escape:
+        stream->state = MB_JSON_stream_string;
+        switch (c)
+        {
+        case 'b':
+            return MB_JSON_stream_push_token(stream, '\b');
+        case 'f':
+            return MB_JSON_stream_push_token(stream, '\f');
+        case 'n':
+            return MB_JSON_stream_push_token(stream, '\n');
+        case 'r':
+            return MB_JSON_stream_push_token(stream, '\r');
+        case 't':
+            return MB_JSON_stream_push_token(stream, '\t');
+        case '\"':
+        case '\\':
+        case '/':
+            return MB_JSON_stream_push_token(stream, c);
+        case 'u':
+            stream->codepoint = 0;
+            stream->hex_digits = 0;
+            stream->state = MB_JSON_stream_unicode;
+            return true;
+        default:
+            return false;
+        }
+
+    case MB_JSON_stream_unicode:
+        if ((c >= '0') && (c <= '9'))
+        {
+            stream->codepoint = (stream->codepoint << 4) | (unsigned int)(c - '0');
+        }
+        else if ((c >= 'A') && (c <= 'F'))
+        {
+            stream->codepoint = (stream->codepoint << 4) | (unsigned int)(c - 'A' + 10);
+        }
+        else if ((c >= 'a') && (c <= 'f'))
+        {
+            stream->codepoint = (stream->codepoint << 4) | (unsigned int)(c - 'a' + 10);
+        }
+        else
+        {
+            return false;
+        }
+        if (++stream->hex_digits < 4)
+        {
+            return true;
+        }
+        if (stream->high_surrogate != 0)
+        {
+            /* second half of a UTF16 surrogate pair */
+            unsigned long codepoint = 0;
+            if ((stream->codepoint < 0xDC00) || (stream->codepoint > 0xDFFF))
+            {
+                return false;
+            }
+            codepoint = 0x10000 + (((unsigned long)(stream->high_surrogate & 0x3FF) << 10) | (stream->codepoint & 0x3FF));
+            stream->high_surrogate = 0;
+            stream->state = MB_JSON_stream_string;
+            return MB_JSON_stream_push_utf8(stream, codepoint);
+        }
+        if ((stream->codepoint >= 0xDC00) && (stream->codepoint <= 0xDFFF))
+        {
+            return false;
+        }
+        if ((stream->codepoint >= 0xD800) && (stream->codepoint <= 0xDBFF))
+        {
+            stream->high_surrogate = stream->codepoint;
+            stream->state = MB_JSON_stream_surrogate_backslash;
+            return true;
+        }
+        stream->state = MB_JSON_stream_string;
+        return MB_JSON_stream_push_utf8(stream, stream->codepoint);
+
+    case MB_JSON_stream_surrogate_backslash:
+        stream->state = MB_JSON_stream_surrogate_u;
+        return c == '\\';
+
+    case MB_JSON_stream_surrogate_u:
+        stream->codepoint = 0;
+        stream->hex_digits = 0;
+        stream->state = MB_JSON_stream_unicode;
+        return c == 'u';
+
+    case MB_JSON_stream_number:
+        if (((c >= '0') && (c <= '9')) || (c == '+') || (c == '-') || (c == 'e') || (c == 'E') || (c == '.'))
+        {
+            /* as MB_JSON_parse_number, which reads up to 63 characters */
+            return (stream->token_length < 63) && MB_JSON_stream_push_token(stream, c);
+        }
+        /* the number ended, c belongs to what follows */
+        return MB_JSON_stream_end_number(stream) && ((stream->state == MB_JSON_stream_done) ? (c <= 32) : MB_JSON_stream_feed_char(stream, c));
+
+    case MB_JSON_stream_literal:
+        if (c != (unsigned char)*stream->literal)
+        {
+            return false;
+        }
+        if (*++stream->literal == '\0')
+        {
+            MB_JSON *item = MB_JSON_New_Item(&stream->hooks);
+            if (item == NULL)
+            {
+                return false;
+            }
+            item->type = stream->literal_type;
+#if !defined(MB_JSON_COMPACT_ITEMS)
+            item->valueint = (stream->literal_type == MB_JSON_True) ? 1 : 0;
+#endif
+            return MB_JSON_stream_add(stream, item);
+        }
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+MB_JSON_PUBLIC(MB_JSON_Stream *)
+MB_JSON_StreamCreate(void)
+{
+    MB_JSON_Stream *stream = (MB_JSON_Stream *)MB_JSON_global_hooks.allocate(sizeof(MB_JSON_Stream));
+    if (stream != NULL)
+    {
+        memset(stream, 0, sizeof(MB_JSON_Stream));
+        stream->hooks = MB_JSON_global_hooks;
+        stream->state = MB_JSON_stream_value;
+    }
+
+    return stream;
+}
+
+MB_JSON_PUBLIC(int)
+MB_JSON_StreamFeed(MB_JSON_Stream *stream, const char *data, size_t length, size_t *consumed)
+{
+    size_t i = 0;
+
+    if ((stream == NULL) || ((data == NULL) && (length > 0)))
+    {
+        return MB_JSON_StreamError;
+    }
+
+    for (; (i < length) && (stream->state < MB_JSON_stream_done); i++)
+    {
+        if (!MB_JSON_stream_feed_char(stream, (unsigned char)data[i]))
+        {
+            stream->state = MB_JSON_stream_error;
+            break;
+        }
+        stream->position++;
+    }
+
+    if (consumed != NULL)
+    {
+        *consumed = i;
+    }
+
+    if (stream->state == MB_JSON_stream_error)
+    {
+        return MB_JSON_StreamError;
+    }
+
+    return (stream->state == MB_JSON_stream_done) ? MB_JSON_StreamDone : MB_JSON_StreamMore;
+}
+
+MB_JSON_PUBLIC(int)
+MB_JSON_StreamEnd(MB_JSON_Stream *stream)
+{
+    if (stream == NULL)
+    {
+        return MB_JSON_StreamError;
+    }
+
+    /* a number at the root only ends with the input */
+    if ((stream->state == MB_JSON_stream_number) && (stream->depth == 0) && !MB_JSON_stream_end_number(stream))
+    {
+        stream->state = MB_JSON_stream_error;
+    }
+
+    if (stream->state == MB_JSON_stream_done)
+    {
+        return MB_JSON_StreamDone;
+    }
 
-    /* not a string */
-    if (MB_JSON_buffer_at_offset(input_buffer)[0] != '\"')
+    stream->state = MB_JSON_stream_error;
+    return MB_JSON_StreamError;
+}
+
+MB_JSON_PUBLIC(MB_JSON *)
+MB_JSON_StreamDetach(MB_JSON_Stream *stream)
+{
+    MB_JSON *root = NULL;
+
+    if ((stream == NULL) || (stream->state != MB_JSON_stream_done))
+    {
+        return NULL;
+    }
+
+    root = stream->root;
+    stream->root = NULL;
+    MB_JSON_StreamReset(stream);
+
+    return root;
+}
+
+MB_JSON_PUBLIC(size_t)
+MB_JSON_StreamPosition(const MB_JSON_Stream *stream)
+{
+    return (stream != NULL) ? stream->position : 0;
+}
+
+MB_JSON_PUBLIC(void)
+MB_JSON_StreamReset(MB_JSON_Stream *stream)
+{
+    if (stream == NULL)
+    {
+        return;
+    }
+
+    if (stream->root != NULL)
+    {
+        MB_JSON_Delete(stream->root);
+        stream->root = NULL;
+    }
+    if (stream->key != NULL)
+    {
+        MB_JSON_key_free(stream->key, &stream->hooks);
+        stream->key = NULL;
+    }
+    stream->depth = 0;
+    stream->token_length = 0;
+    stream->position = 0;
+    stream->high_surrogate = 0;
+    stream->state = MB_JSON_stream_value;
+}
+
+MB_JSON_PUBLIC(void)
+MB_JSON_StreamDelete(MB_JSON_Stream *stream)
+{
+    if (stream == NULL)
+    {
+        return;
+    }
+
+    MB_JSON_StreamReset(stream);
+    if (stream->stack != NULL)
+    {
+        stream->hooks.deallocate(stream->stack);
+    }
+    if (stream->token != NULL)
+    {
+        stream->hooks.deallocate(stream->token);
+    }
+    stream->hooks.deallocate(stream);
+}
+
+#define MB_JSON_min(a, b) (((a) < (b)) ? (a) : (b))
+
+size_t MB_JSON_SerializedBufferLength(const MB_JSON *const item, MB_JSON_bool format)
+{
+    MB_JSON_buffer_len_data_t buf_len[1];
+    buf_len->depth = 0;
+    buf_len->format = format > 0 ? true : false;
+    buf_len->size = 0;
+
+    MB_JSON_get_value_buffer_length(item, buf_len);
+    return buf_len->size;
+}
+
+static unsigned char *MB_JSON_print(const MB_JSON *const item, MB_JSON_bool format, const MB_JSON_internal_hooks *const hooks)
+{
+    static const size_t default_buffer_size = 256;
+    MB_JSON_printbuffer buffer[1];
+    unsigned char *printed = NULL;
+
+    memset(buffer, 0, sizeof(buffer));
+
+    /* create buffer */
+    buffer->buffer = (unsigned char *)hooks->allocate(default_buffer_size);
+    buffer->length = default_buffer_size;
+    buffer->format = format;
+    buffer->hooks = *hooks;
+    if (buffer->buffer == NULL)
     {
         goto fail;
     }
 
+    /* print the value */
+    if (!MB_JSON_print_value(item, buffer))
     {
-        /* calculate approximate size of the output (overestimate) */
-        size_t allocation_length = 0;
-        size_t skipped_bytes = 0;
-        while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
+        goto fail;
+    }
+    MB_JSON_update_offset(buffer);
+
+    /* check if reallocate is available */
+    if (hooks->reallocate != NULL)
+    {
+        printed = (unsigned char *)hooks->reallocate(buffer->buffer, buffer->offset + 1);
+        if (printed == NULL)
         {
-            /* is escape sequence */
-            if (input_end[0] == '\\')
-            {
-                if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
-                {
-                    /* prevent buffer overflow when last input character is a backslash */
-                    goto fail;
-                }
-                skipped_bytes++;
-                input_end++;
-            }
-            input_end++;
+            goto fail;
         }
-        if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+        buffer->buffer = NULL;
+    }
+    else /* otherwise copy the JSON over to a new buffer */
+    {
+        printed = (unsigned char *)hooks->allocate(buffer->offset + 1);
+        if (printed == NULL)
         {
-            goto fail; /* string ended unexpectedly */
+            goto fail;
         }
+        memcpy(printed, buffer->buffer, MB_JSON_min(buffer->length, buffer->offset + 1));
+        printed[buffer->offset] = '\0'; /* just to be sure */
 
-        /* This is at most how much we need for the output */
-        allocation_length = (size_t)(input_end - MB_JSON_buffer_at_offset(input_buffer)) - skipped_bytes;
-        output = (unsigned char *)input_buffer->hooks.allocate(allocation_length + sizeof(""));
+        /* free the buffer */
+        hooks->deallocate(buffer->buffer);
+    }
+
+    return printed;
+
+fail:
+    if (buffer->buffer != NULL)
+    {
+        hooks->deallocate(buffer->buffer);
+    }
+
+    if (printed != NULL)
+    {
+        hooks->deallocate(printed);
+    }
+
+    return NULL;
+}
+
+/* Render a MB_JSON item/entity/structure to text. */
+MB_JSON_PUBLIC(char *)
+MB_JSON_Print(const MB_JSON *item)
+{
+    return (char *)MB_JSON_print(item, true, &MB_JSON_global_hooks);
+}
+
+MB_JSON_PUBLIC(char *)
+MB_JSON_PrintUnformatted(const MB_JSON *item)
+{
+    return (char *)MB_JSON_print(item, false, &MB_JSON_global_hooks);
+}
+
+MB_JSON_PUBLIC(char *)
+MB_JSON_PrintBuffered(const MB_JSON *item, int prebuffer, MB_JSON_bool fmt)
+{
+    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0}, 0, 0, 0};
+
+    if (prebuffer < 0)
+    {
+        return NULL;
+    }
+
+    p.buffer = (unsigned char *)MB_JSON_global_hooks.allocate((size_t)prebuffer);
+    if (!p.buffer)
+    {
+        return NULL;
+    }
+
+    p.length = (size_t)prebuffer;
+    p.offset = 0;
+    p.noalloc = false;
+    p.format = fmt;
+    p.hooks = MB_JSON_global_hooks;
+
+    if (!MB_JSON_print_value(item, &p))
+    {
+        MB_JSON_global_hooks.deallocate(p.buffer);
+        return NULL;
+    }
+
+    return (char *)p.buffer;
+}
+
+MB_JSON_PUBLIC(MB_JSON_bool)
+MB_JSON_PrintToWriter(const MB_JSON *item, MB_JSON_bool format, char *buffer, size_t length, MB_JSON_Writer write, void *user)
+{
+    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0}, 0, 0, 0};
+    MB_JSON_bool success = false;
+
+    if ((buffer == NULL) || (length < 2) || (write == NULL))
+    {
+        return false;
+    }
+
+    p.buffer = (unsigned char *)buffer;
+    p.length = length;
+    p.format = format;
+    p.hooks = MB_JSON_global_hooks;
+    p.write = write;
+    p.user = user;
+    p.borrowed = true;
+
+    if (MB_JSON_print_value(item, &p))
+    {
+        MB_JSON_update_offset(&p);
+        success = (p.offset == 0) || p.write((const char *)p.buffer, p.offset, p.user);
+    }
+
+    if ((p.buffer != NULL) && !p.borrowed)
+    {
+        p.hooks.deallocate(p.buffer);
+    }
+
+    return success;
+}
+
+MB_JSON_PUBLIC(MB_JSON_bool)
+MB_JSON_PrintPreallocated(MB_JSON *item, char *buffer, const int length, const MB_JSON_bool format)
+{
+    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0}, 0, 0, 0};
+
+    if ((length < 0) || (buffer == NULL))
+    {
+        return false;
+    }
+
+    p.buffer = (unsigned char *)buffer;
+    p.length = (size_t)length;
+    p.offset = 0;
+    p.noalloc = true;
+    p.format = format;
+    p.hooks = MB_JSON_global_hooks;
+
+    return MB_JSON_print_value(item, &p);
+}
+
+/* CBOR (RFC 8949) - the same tree as compact binary, written through a MB_JSON_printbuffer like the text. */
+
+/* initial byte of an item, with the argument in the fewest bytes */
+static MB_JSON_bool MB_JSON_cbor_head(MB_JSON_printbuffer *const p, unsigned char major, uint64_t value)
+{
+    unsigned char *output = NULL;
+    unsigned char info = (unsigned char)value;
+    size_t length = 0;
+    size_t i = 0;
+
+    if (value >= 24)
+    {
+        length = (value <= 0xFF) ? 1 : (value <= 0xFFFF) ? 2 : (value <= 0xFFFFFFFFUL) ? 4 : 8;
+        info = (unsigned char)((length == 1) ? 24 : (length == 2) ? 25 : (length == 4) ? 26 : 27);
+    }
+
+    output = MB_JSON_ensure(p, length + 1);
+    if (output == NULL)
+    {
+        return false;
+    }
+
+    output[0] = (unsigned char)((major << 5) | info);
+    /* big endian */
+    for (i = length; i > 0; i--)
+    {
+        output[i] = (unsigned char)(value & 0xFF);
+        value >>= 8;
+    }
+    p->offset += length + 1;
+
+    return true;
+}
+
+/* copies data in pieces of at most one buffer, so a long string never grows the buffer of a writer */
+static MB_JSON_bool MB_JSON_cbor_bytes(MB_JSON_printbuffer *const p, const unsigned char *data, size_t length)
+{
+    unsigned char *output = NULL;
+    size_t piece = 0;
+
+    while (length > 0)
+    {
+        piece = length;
+        if ((p->write != NULL) && (piece > p->length - 1))
+        {
+            piece = p->length - 1;
+        }
+
+        output = MB_JSON_ensure(p, piece);
         if (output == NULL)
         {
-            goto fail; /* allocation failure */
+            return false;
         }
+        memcpy(output, data, piece);
+        p->offset += piece;
+        data += piece;
+        length -= piece;
+    }
+
+    return true;
+}
+
+static MB_JSON_bool MB_JSON_cbor_string(MB_JSON_printbuffer *const p, const char *string)
+{
+    size_t length = (string == NULL) ? 0 : strlen(string);
+
+    return MB_JSON_cbor_head(p, 3, length) && MB_JSON_cbor_bytes(p, (const unsigned char *)string, length);
+}
+
+/* integers as integers, the rest as the smaller float that holds the value exactly */
+static MB_JSON_bool MB_JSON_cbor_number(MB_JSON_printbuffer *const p, double d)
+{
+    unsigned char *output = NULL;
+    uint64_t bits = 0;
+    uint32_t bits32 = 0;
+    float f = 0;
+    size_t length = 0;
+    size_t i = 0;
+
+    memcpy(&bits, &d, sizeof(bits));
+
+    if ((d != d) || (d > DBL_MAX) || (d < -DBL_MAX))
+    {
+        /* NaN and Infinity are null, as in the text */
+        return MB_JSON_cbor_head(p, 7, 22);
     }
 
-    output_pointer = output;
-    /* loop through the string literal */
-    while (input_pointer < input_end)
+    /* 2^64, compared as double so the test is exact; -0.0 keeps its sign as a float */
+    if ((d >= 0) && (d < 18446744073709551616.0) && !(bits >> 63))
     {
-        if (*input_pointer != '\\')
+        uint64_t u = (uint64_t)d;
+        if ((double)u == d)
         {
-            *output_pointer++ = *input_pointer++;
+            return MB_JSON_cbor_head(p, 0, u);
         }
-        /* escape sequence */
-        else
+    }
+    else if ((d < 0) && (d > -18446744073709551616.0))
+    {
+        uint64_t u = (uint64_t)(-d);
+        if ((double)u == -d)
         {
-            unsigned char sequence_length = 2;
-            if ((input_end - input_pointer) < 1)
-            {
-                goto fail;
-            }
+            return MB_JSON_cbor_head(p, 1, u - 1);
+        }
+    }
 
-            switch (input_pointer[1])
-            {
-            case 'b':
-                *output_pointer++ = '\b';
-                break;
-            case 'f':
-                *output_pointer++ = '\f';
-                break;
-            case 'n':
-                *output_pointer++ = '\n';
-                break;
-            case 'r':
-                *output_pointer++ = '\r';
-                break;
-            case 't':
-                *output_pointer++ = '\t';
-                break;
-            case '\"':
-            case '\\':
-            case '/':
-                *output_pointer++ = input_pointer[1];
-                break;
+    f = (float)d;
+    length = ((double)f == d) ? 4 : 8;
+    output = MB_JSON_ensure(p, length + 1);
+    if (output == NULL)
+    {
+        return false;
+    }
 
-            /* UTF-16 literal */
-            case 'u':
-                sequence_length = MB_JSON_utf16_literal_to_utf8(input_pointer, input_end, &output_pointer);
-                if (sequence_length == 0)
-                {
-                    /* failed to convert UTF16-literal to UTF-8 */
-                    goto fail;
-                }
-                break;
+    if (length == 4)
+    {
+        memcpy(&bits32, &f, sizeof(bits32));
+        bits = bits32;
+        output[0] = 0xFA;
+    }
+    else
+    {
+        output[0] = 0xFB;
+    }
 
-            default:
-                goto fail;
-            }
-            input_pointer += sequence_length;
-        }
+    for (i = length; i > 0; i--)
+    {
+        output[i] = (unsigned char)(bits & 0xFF);
+        bits >>= 8;
     }
+    p->offset += length + 1;
 
-    /* zero terminate the output */
-    *output_pointer = '\0';
+    return true;
+}
 
-    item->type = MB_JSON_String;
-    item->valuestring = (char *)output;
+/* an integer written as digits only, exact beyond 2^53 where a double is not */
+static MB_JSON_bool MB_JSON_cbor_integer_text(const char *text, MB_JSON_bool *negative, uint64_t *value)
+{
+    uint64_t u = 0;
 
-    input_buffer->offset = (size_t)(input_end - input_buffer->content);
-    input_buffer->offset++;
+    *negative = (*text == '-');
+    if (*negative)
+    {
+        text++;
+    }
 
-    return true;
+    if (*text == '\0')
+    {
+        return false;
+    }
 
-fail:
-    if (output != NULL)
+    for (; *text != '\0'; text++)
     {
-        input_buffer->hooks.deallocate(output);
+        if ((*text < '0') || (*text > '9') || (u > UINT64_MAX / 10) || ((u == UINT64_MAX / 10) && ((uint64_t)(*text - '0') > UINT64_MAX % 10)))
+        {
+            return false;
+        }
+        u = u * 10 + (uint64_t)(*text - '0');
     }
 
-    if (input_pointer != NULL)
+    if (*negative && (u == 0))
     {
-        input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+        return false; /* "-0" */
     }
+    *value = u;
 
-    return false;
+    return true;
 }
 
-static MB_JSON_bool MB_JSON_get_string_buffer_length_ptr(const unsigned char *const input, MB_JSON_buffer_len_data_t *const buf_len)
+static MB_JSON_bool MB_JSON_cbor_value(const MB_JSON *const item, MB_JSON_printbuffer *const p);
+
+/* raw text is stored by FirebaseJson for numbers (and may hold any JSON), so it is written as what it reads as */
+static MB_JSON_bool MB_JSON_cbor_raw(const MB_JSON *const item, MB_JSON_printbuffer *const p)
 {
-    const unsigned char *input_pointer = NULL;
-    size_t output_length = 0;
-    /* numbers of additional characters needed for escaping */
-    size_t escape_characters = 0;
+    const char *raw = item->valuestring;
+    size_t length = (raw == NULL) ? 0 : strlen(raw);
+    MB_JSON_bool negative = false;
+    uint64_t u = 0;
+    double d = 0;
+    MB_JSON *parsed = NULL;
+    MB_JSON_bool success = false;
 
-    if (input == NULL)
+    if (length == 0)
     {
-        buf_len->size += 2;
+        return MB_JSON_cbor_string(p, "");
+    }
 
-        return true;
+    if (MB_JSON_cbor_integer_text(raw, &negative, &u))
+    {
+        return MB_JSON_cbor_head(p, negative ? 1 : 0, negative ? u - 1 : u);
     }
 
-    /* set "flag" to 1 if something needs to be escaped */
-    for (input_pointer = input; *input_pointer; input_pointer++)
+    if (MB_JSON_ParseNumber(raw, length, &d) == length)
     {
-        switch (*input_pointer)
-        {
-        case '\"':
-        case '\\':
-        case '\b':
-        case '\f':
-        case '\n':
-        case '\r':
-        case '\t':
-            /* one character escape sequence */
-            escape_characters++;
-            break;
-        default:
-            if (*input_pointer < 32)
-            {
-                /* UTF-16 escape sequence uXXXX */
-                escape_characters += 5;
-            }
-            break;
-        }
+        return MB_JSON_cbor_number(p, d);
     }
-    output_length = (size_t)(input_pointer - input) + escape_characters + 2;
 
-    buf_len->size += output_length;
+    parsed = MB_JSON_ParseWithLength(raw, length);
+    if (parsed == NULL)
+    {
+        return MB_JSON_cbor_string(p, raw);
+    }
+    success = MB_JSON_cbor_value(parsed, p);
+    MB_JSON_Delete(parsed);
 
-    return true;
+    return success;
 }
 
-/* Render the cstring provided to an escaped version that can be printed. */
-static MB_JSON_bool MB_JSON_print_string_ptr(const unsigned char *const input, MB_JSON_printbuffer *const output_buffer)
+static MB_JSON_bool MB_JSON_cbor_value(const MB_JSON *const item, MB_JSON_printbuffer *const p)
 {
-    const unsigned char *input_pointer = NULL;
-    unsigned char *output = NULL;
-    unsigned char *output_pointer = NULL;
-    size_t output_length = 0;
-    /* numbers of additional characters needed for escaping */
-    size_t escape_characters = 0;
+    const MB_JSON *child = NULL;
+    uint64_t count = 0;
 
-    if (output_buffer == NULL)
+    if (item == NULL)
     {
         return false;
     }
 
-    /* empty string */
-    if (input == NULL)
+    switch ((item->type) & 0xFF)
     {
-        output = MB_JSON_ensure(output_buffer, sizeof("\"\""));
-        if (output == NULL)
+    case MB_JSON_False:
+        return MB_JSON_cbor_head(p, 7, 20);
+
+    case MB_JSON_True:
+        return MB_JSON_cbor_head(p, 7, 21);
+
+    case MB_JSON_NULL:
+        return MB_JSON_cbor_head(p, 7, 22);
+
+    case MB_JSON_Number:
+        return MB_JSON_cbor_number(p, item->valuedouble);
+
+    case MB_JSON_String:
+        return MB_JSON_cbor_string(p, item->valuestring);
+
+    case MB_JSON_Raw:
+        return MB_JSON_cbor_raw(item, p);
+
+    case MB_JSON_Array:
+    case MB_JSON_Object:
+        for (child = item->child; child != NULL; child = child->next)
         {
-            return false;
+            count++;
         }
-        strcpy((char *)output, "\"\"");
 
-        return true;
-    }
+        if (!MB_JSON_cbor_head(p, (item->type & MB_JSON_Array) ? 4 : 5, count))
+        {
+            return false;
+        }
 
-    /* set "flag" to 1 if something needs to be escaped */
-    for (input_pointer = input; *input_pointer; input_pointer++)
-    {
-        switch (*input_pointer)
+        for (child = item->child; child != NULL; child = child->next)
         {
-        case '\"':
-        case '\\':
-        case '\b':
-        case '\f':
-        case '\n':
-        case '\r':
-        case '\t':
-            /* one character escape sequence */
-            escape_characters++;
-            break;
-        default:
-            if (*input_pointer < 32)
+            if ((item->type & MB_JSON_Object) && !MB_JSON_cbor_string(p, child->string))
             {
-                /* UTF-16 escape sequence uXXXX */
-                escape_characters += 5;
+                return false;
+            }
+            if (!MB_JSON_cbor_value(child, p))
+            {
+                return false;
             }
-            break;
         }
+        return true;
+
+    default:
+        return false;
     }
-    output_length = (size_t)(input_pointer - input) + escape_characters;
+}
 
-    output = MB_JSON_ensure(output_buffer, output_length + sizeof("\"\""));
-    if (output == NULL)
+static MB_JSON_bool MB_JSON_cbor_count(const char *data, size_t length, void *user)
+{
+    (void)data;
+    *(size_t *)user += length;
+    return true;
+}
+
+MB_JSON_PUBLIC(MB_JSON_bool)
+MB_JSON_PrintCBORToWriter(const MB_JSON *item, char *buffer, size_t length, MB_JSON_Writer write, void *user)
+{
+    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0}, 0, 0, 0};
+    MB_JSON_bool success = false;
+
+    /* room for the longest head and the '\0' kept behind the data */
+    if ((buffer == NULL) || (length < 10) || (write == NULL))
     {
         return false;
     }
 
-    /* no characters have to be escaped */
-    if (escape_characters == 0)
+    p.buffer = (unsigned char *)buffer;
+    p.length = length;
+    p.hooks = MB_JSON_global_hooks;
+    p.write = write;
+    p.user = user;
+    p.borrowed = true;
+
+    if (MB_JSON_cbor_value(item, &p))
     {
-        output[0] = '\"';
-        memcpy(output + 1, input, output_length);
-        output[output_length + 1] = '\"';
-        output[output_length + 2] = '\0';
+        p.buffer[p.offset] = '\0';
+        success = (p.offset == 0) || p.write((const char *)p.buffer, p.offset, p.user);
+    }
 
-        return true;
+    if ((p.buffer != NULL) && !p.borrowed)
+    {
+        p.hooks.deallocate(p.buffer);
     }
 
-    output[0] = '\"';
-    output_pointer = output + 1;
-    /* copy the string */
-    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+    return success;
+}
+
+MB_JSON_PUBLIC(size_t)
+MB_JSON_PrintCBORPreallocated(const MB_JSON *item, unsigned char *buffer, size_t length)
+{
+    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0}, 0, 0, 0};
+
+    if ((buffer == NULL) || (length == 0))
     {
-        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
+        return 0;
+    }
+
+    /* MB_JSON_ensure keeps one byte for a '\0', which CBOR does not need */
+    p.buffer = buffer;
+    p.length = length + 1;
+    p.noalloc = true;
+    p.hooks = MB_JSON_global_hooks;
+
+    if (!MB_JSON_cbor_value(item, &p))
+    {
+        return 0;
+    }
+
+    return p.offset;
+}
+
+MB_JSON_PUBLIC(size_t)
+MB_JSON_CBORLength(const MB_JSON *item)
+{
+    char buffer[64];
+    size_t length = 0;
+
+    if (!MB_JSON_PrintCBORToWriter(item, buffer, sizeof(buffer), MB_JSON_cbor_count, &length))
+    {
+        return 0;
+    }
+
+    return length;
+}
+
+typedef struct
+{
+    const unsigned char *content;
+    size_t length;
+    size_t offset;
+    /* pulls the input when there is no content in memory */
+    MB_JSON_Reader read;
+    void *user;
+    size_t depth;
+    MB_JSON_internal_hooks hooks;
+} MB_JSON_cbor_input;
+
+static MB_JSON_bool MB_JSON_cbor_read(MB_JSON_cbor_input *const input, unsigned char *data, size_t length)
+{
+    size_t n = 0;
+
+    if (input->read == NULL)
+    {
+        if (length > input->length - input->offset)
         {
-            /* normal character, copy */
-            *output_pointer = *input_pointer;
+            return false;
         }
-        else
+        memcpy(data, input->content + input->offset, length);
+        input->offset += length;
+        return true;
+    }
+
+    while (length > 0)
+    {
+        n = input->read(data, length, input->user);
+        if ((n == 0) || (n > length))
         {
-            /* character needs to be escaped */
-            *output_pointer++ = '\\';
-            switch (*input_pointer)
-            {
-            case '\\':
-                *output_pointer = '\\';
-                break;
-            case '\"':
-                *output_pointer = '\"';
-                break;
-            case '\b':
-                *output_pointer = 'b';
-                break;
-            case '\f':
-                *output_pointer = 'f';
-                break;
-            case '\n':
-                *output_pointer = 'n';
-                break;
-            case '\r':
-                *output_pointer = 'r';
-                break;
-            case '\t':
-                *output_pointer = 't';
-                break;
-            default:
-                /* escape and print as unicode codepoint */
-                sprintf((char *)output_pointer, "u%04x", *input_pointer);
-                output_pointer += 4;
-                break;
-            }
+            return false;
         }
+        input->offset += n;
+        data += n;
+        length -= n;
     }
-    output[output_length + 1] = '\"';
-    output[output_length + 2] = '\0';
 
     return true;
 }
 
-static MB_JSON_bool MB_JSON_get_string_buffer_length(const MB_JSON *const item, MB_JSON_buffer_len_data_t *const buf_len)
+/* major type, additional information and argument of the next item; 31 (indefinite length or break) leaves value 0 */
+static MB_JSON_bool MB_JSON_cbor_read_head(MB_JSON_cbor_input *const input, unsigned char *major, unsigned char *info, uint64_t *value)
 {
-    return MB_JSON_get_string_buffer_length_ptr((unsigned char *)item->valuestring, buf_len);
-}
+    unsigned char bytes[8];
+    size_t length = 0;
+    size_t i = 0;
 
-/* Invoke print_string_ptr (which is useful) on an item. */
-static MB_JSON_bool MB_JSON_print_string(const MB_JSON *const item, MB_JSON_printbuffer *const p)
-{
-    return MB_JSON_print_string_ptr((unsigned char *)item->valuestring, p);
-}
+    if (!MB_JSON_cbor_read(input, bytes, 1))
+    {
+        return false;
+    }
 
-/* Predeclare these prototypes. */
-static MB_JSON_bool MB_JSON_parse_value(MB_JSON *const item, MB_JSON_parse_buffer *const input_buffer);
-static MB_JSON_bool MB_JSON_print_value(const MB_JSON *const item, MB_JSON_printbuffer *const output_buffer);
-static MB_JSON_bool MB_JSON_parse_array(MB_JSON *const item, MB_JSON_parse_buffer *const input_buffer);
-static MB_JSON_bool MB_JSON_print_array(const MB_JSON *const item, MB_JSON_printbuffer *const output_buffer);
-static MB_JSON_bool MB_JSON_parse_object(MB_JSON *const item, MB_JSON_parse_buffer *const input_buffer);
-static MB_JSON_bool MB_JSON_print_object(const MB_JSON *const item, MB_JSON_printbuffer *const output_buffer);
+    *major = (unsigned char)(bytes[0] >> 5);
+    *info = (unsigned char)(bytes[0] & 0x1F);
+    *value = 0;
 
-static MB_JSON_bool MB_JSON_get_object_buffer_length(const MB_JSON *const item, MB_JSON_buffer_len_data_t *const buf_len);
-static MB_JSON_bool MB_JSON_get_array_buffer_length(const MB_JSON *const item, MB_JSON_buffer_len_data_t *const buf_len);
-static MB_JSON_bool MB_JSON_get_value_buffer_length(const MB_JSON *const item, MB_JSON_buffer_len_data_t *const buf_len);
+    if (*info < 24)
+    {
+        *value = *info;
+        return true;
+    }
 
-/* Utility to jump whitespace and cr/lf */
-static MB_JSON_parse_buffer *MB_JSON_buffer_skip_whitespace(MB_JSON_parse_buffer *const buffer)
-{
-    if ((buffer == NULL) || (buffer->content == NULL))
+    if (*info == 31)
     {
-        return NULL;
+        /* no indefinite length for integers and tags */
+        return (*major >= 2) && (*major != 6);
     }
 
-    if (MB_JSON_cannot_access_at_index(buffer, 0))
+    if (*info > 27)
     {
-        return buffer;
+        return false; /* reserved */
     }
 
-    while (MB_JSON_can_access_at_index(buffer, 0) && (MB_JSON_buffer_at_offset(buffer)[0] <= 32))
+    length = (size_t)1 << (*info - 24);
+    if (!MB_JSON_cbor_read(input, bytes, length))
     {
-        buffer->offset++;
+        return false;
     }
 
-    if (buffer->offset == buffer->length)
+    for (i = 0; i < length; i++)
     {
-        buffer->offset--;
+        *value = (*value << 8) | bytes[i];
     }
 
-    return buffer;
+    return true;
 }
 
-/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
-static MB_JSON_parse_buffer *MB_JSON_skip_utf8_bom(MB_JSON_parse_buffer *const buffer)
+/* text of the given length, or of the chunks up to a break when indefinite; a chunk that fits is read into place */
+static char *MB_JSON_cbor_read_text(MB_JSON_cbor_input *const input, unsigned char info, uint64_t value, size_t *text_length)
 {
-    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    char *text = NULL;
+    char *grown = NULL;
+    size_t length = 0;
+    unsigned char major = 0;
+
+    if (info != 31)
     {
-        return NULL;
+        if ((value >= (uint64_t)(INT_MAX)) || ((input->read == NULL) && (value > input->length - input->offset)))
+        {
+            return NULL;
+        }
+
+        text = (char *)input->hooks.allocate((size_t)value + sizeof(""));
+        if (text == NULL)
+        {
+            return NULL;
+        }
+        if (!MB_JSON_cbor_read(input, (unsigned char *)text, (size_t)value))
+        {
+            input->hooks.deallocate(text);
+            return NULL;
+        }
+        text[value] = '\0';
+        *text_length = (size_t)value;
+        return text;
     }
 
-    if (MB_JSON_can_access_at_index(buffer, 4) && (strncmp((const char *)MB_JSON_buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+    for (;;)
     {
-        buffer->offset += 3;
-    }
+        if (!MB_JSON_cbor_read_head(input, &major, &info, &value))
+        {
+            goto fail;
+        }
+        if ((major == 7) && (info == 31))
+        {
+            break;
+        }
+        /* chunks are definite text strings */
+        if ((major != 3) || (info == 31) || (value >= (uint64_t)(INT_MAX - length)) || ((input->read == NULL) && (value > input->length - input->offset)))
+        {
+            goto fail;
+        }
 
-    return buffer;
-}
+        grown = (char *)input->hooks.allocate(length + (size_t)value + sizeof(""));
+        if (grown == NULL)
+        {
+            goto fail;
+        }
+        if (text != NULL)
+        {
+            memcpy(grown, text, length);
+            input->hooks.deallocate(text);
+        }
+        text = grown;
 
-MB_JSON_PUBLIC(MB_JSON *)
-MB_JSON_ParseWithOpts(const char *value, const char **return_parse_end, MB_JSON_bool require_null_terminated)
-{
-    size_t buffer_length;
+        if (!MB_JSON_cbor_read(input, (unsigned char *)text + length, (size_t)value))
+        {
+            goto fail;
+        }
+        length += (size_t)value;
+    }
 
-    if (NULL == value)
+    if (text == NULL)
     {
-        return NULL;
+        text = (char *)input->hooks.allocate(sizeof(""));
+        if (text == NULL)
+        {
+            return NULL;
+        }
     }
+    text[length] = '\0';
+    *text_length = length;
 
-    /* Adding null character size due to require_null_terminated. */
-    buffer_length = strlen(value) + sizeof("");
+    return text;
 
-    return MB_JSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+fail:
+    if (text != NULL)
+    {
+        input->hooks.deallocate(text);
+    }
+
+    return NULL;
 }
 
-/* Parse an object - create a new root, and populate. */
-MB_JSON_PUBLIC(MB_JSON *)
-MB_JSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, MB_JSON_bool require_null_terminated)
+static double MB_JSON_cbor_half(uint64_t value)
 {
-    MB_JSON_parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}};
-    MB_JSON *item = NULL;
-
-    /* reset error position */
-    MB_JSON_global_error.json = NULL;
-    MB_JSON_global_error.position = 0;
+    int exponent = (int)((value >> 10) & 0x1F);
+    double mantissa = (double)(value & 0x3FF);
+    double d = 0;
 
-    if (value == NULL || 0 == buffer_length)
+    if (exponent == 0)
     {
-        goto fail;
+        d = ldexp(mantissa, -24);
+    }
+    else if (exponent != 31)
+    {
+        d = ldexp(mantissa + 1024, exponent - 25);
+    }
+    else
+    {
+        d = (mantissa == 0) ? HUGE_VAL : (double)NAN;
     }
 
-    buffer.content = (const unsigned char *)value;
-    buffer.length = buffer_length;
-    buffer.offset = 0;
-    buffer.hooks = MB_JSON_global_hooks;
+    return (value & 0x8000) ? -d : d;
+}
 
-    item = MB_JSON_New_Item(&MB_JSON_global_hooks);
-    if (item == NULL) /* memory fail */
+/* integers beyond 2^53 keep their digits as raw text, the way FirebaseJson stores 64 bit values */
+static MB_JSON_bool MB_JSON_cbor_integer(MB_JSON *const item, MB_JSON_cbor_input *const input, MB_JSON_bool negative, uint64_t value)
+{
+    char digits[24];
+    char *p = digits + sizeof(digits) - 1;
+    MB_JSON_bool carry = false;
+
+    if ((value < ((uint64_t)1 << 53)) || (!negative && (value == ((uint64_t)1 << 53))))
     {
-        goto fail;
+        item->type = MB_JSON_Number;
+        MB_JSON_set_number(item, negative ? -(double)value - 1 : (double)value);
+        return true;
     }
 
-    if (!MB_JSON_parse_value(item, MB_JSON_buffer_skip_whitespace(MB_JSON_skip_utf8_bom(&buffer))))
+    if (negative)
     {
-        /* parse failure. ep is set. */
-        goto fail;
+        /* -1 - value, without overflow at 2^64 - 1 */
+        value++;
+        carry = (value == 0);
     }
 
-    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
-    if (require_null_terminated)
+    *p = '\0';
+    if (carry)
     {
-        MB_JSON_buffer_skip_whitespace(&buffer);
-        if ((buffer.offset >= buffer.length) || MB_JSON_buffer_at_offset(&buffer)[0] != '\0')
+        p -= sizeof("18446744073709551616") - 1;
+        memcpy(p, "18446744073709551616", sizeof("18446744073709551616") - 1);
+    }
+    else
+    {
+        do
         {
-            goto fail;
-        }
+            *--p = (char)('0' + (value % 10));
+            value /= 10;
+        } while (value > 0);
     }
-    if (return_parse_end)
+
+    if (negative)
     {
-        *return_parse_end = (const char *)MB_JSON_buffer_at_offset(&buffer);
+        *--p = '-';
     }
 
-    return item;
+    item->valuestring = (char *)MB_JSON_strdup((const unsigned char *)p, &input->hooks);
+    if (item->valuestring == NULL)
+    {
+        return false;
+    }
+    item->type = MB_JSON_Raw;
 
-fail:
-    if (item != NULL)
+    return true;
+}
+
+static MB_JSON_bool MB_JSON_cbor_parse_value(MB_JSON *const item, MB_JSON_cbor_input *const input);
+static MB_JSON_bool MB_JSON_cbor_parse_item(MB_JSON *const item, MB_JSON_cbor_input *const input, unsigned char major, unsigned char info, uint64_t value);
+
+/* the elements (or key and value pairs) of a container whose head was read */
+static MB_JSON_bool MB_JSON_cbor_parse_children(MB_JSON *const item, MB_JSON_cbor_input *const input, unsigned char major, unsigned char info, uint64_t value)
+{
+    MB_JSON *head = NULL;
+    MB_JSON *current_item = NULL;
+    MB_JSON *new_item = NULL;
+    unsigned char key_major = 0;
+    unsigned char key_info = 0;
+    uint64_t key_value = 0;
+    char *name = NULL;
+    size_t name_length = 0;
+    uint64_t i = 0;
+
+    if (input->depth >= MB_JSON_NESTING_LIMIT)
     {
-        MB_JSON_Delete(item);
+        return false; /* to deeply nested */
     }
+    input->depth++;
 
-    if (value != NULL)
+    /* every element takes at least one byte */
+    if ((info != 31) && (input->read == NULL) && (value > input->length - input->offset))
     {
-        MB_JSON_error local_error;
-        local_error.json = (const unsigned char *)value;
-        local_error.position = 0;
+        goto fail;
+    }
 
-        if (buffer.offset < buffer.length)
+    for (i = 0; (info == 31) || (i < value); i++)
+    {
+        if (!MB_JSON_cbor_read_head(input, &key_major, &key_info, &key_value))
         {
-            local_error.position = buffer.offset;
+            goto fail;
         }
-        else if (buffer.length > 0)
+        if ((info == 31) && (key_major == 7) && (key_info == 31))
         {
-            local_error.position = buffer.length - 1;
+            break;
         }
 
-        if (return_parse_end != NULL)
+        new_item = MB_JSON_New_Item(&(input->hooks));
+        if (new_item == NULL)
         {
-            *return_parse_end = (const char *)local_error.json + local_error.position;
+            goto fail; /* allocation failure */
         }
 
-        MB_JSON_global_error = local_error;
-    }
+        /* attach next item to list */
+        if (head == NULL)
+        {
+            current_item = head = new_item;
+        }
+        else
+        {
+            MB_JSON_suffix_object(current_item, new_item);
+            current_item = new_item;
+        }
 
-    return NULL;
-}
+        if (major == 5)
+        {
+            /* only text keys have a place in JSON */
+            if (key_major != 3)
+            {
+                goto fail;
+            }
 
-/* Default options for MB_JSON_Parse */
-MB_JSON_PUBLIC(MB_JSON *)
-MB_JSON_Parse(const char *value)
-{
-    return MB_JSON_ParseWithOpts(value, 0, 0);
-}
+            name = MB_JSON_cbor_read_text(input, key_info, key_value, &name_length);
+            if (name == NULL)
+            {
+                goto fail;
+            }
 
-MB_JSON_PUBLIC(MB_JSON *)
-MB_JSON_ParseWithLength(const char *value, size_t buffer_length)
-{
-    return MB_JSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
-}
+            current_item->string = name;
+            if (MB_JSON_intern_keys)
+            {
+                /* up to a '\0' inside the text, which is where the key ends for every lookup */
+                current_item->string = MB_JSON_key_new(name, strlen(name), &(input->hooks));
+                input->hooks.deallocate(name);
+                if (current_item->string == NULL)
+                {
+                    goto fail; /* allocation failure */
+                }
+            }
+
+            if (!MB_JSON_cbor_parse_value(current_item, input))
+            {
+                goto fail;
+            }
+        }
+        else
+        {
+            /* the head read for the break check is the element's own */
+            if (!MB_JSON_cbor_parse_item(current_item, input, key_major, key_info, key_value))
+            {
+                goto fail;
+            }
+        }
+    }
 
-#define MB_JSON_min(a, b) (((a) < (b)) ? (a) : (b))
+    input->depth--;
+    item->type = (major == 4) ? MB_JSON_Array : MB_JSON_Object;
+    item->child = head;
+    MB_JSON_set_last_item(item, current_item);
 
-size_t MB_JSON_SerializedBufferLength(const MB_JSON *const item, MB_JSON_bool format)
-{
-    MB_JSON_buffer_len_data_t buf_len[1];
-    buf_len->depth = 0;
-    buf_len->format = format > 0 ? true : false;
-    buf_len->size = 0;
+    return true;
 
-    MB_JSON_get_value_buffer_length(item, buf_len);
-    return buf_len->size;
+fail:
+    if (head != NULL)
+    {
+        MB_JSON_Delete(head);
+    }
+
+    return false;
 }
 
-static unsigned char *MB_JSON_print(const MB_JSON *const item, MB_JSON_bool format, const MB_JSON_internal_hooks *const hooks)
+static MB_JSON_bool MB_JSON_cbor_parse_item(MB_JSON *const item, MB_JSON_cbor_input *const input, unsigned char major, unsigned char info, uint64_t value)
 {
-    static const size_t default_buffer_size = 256;
-    MB_JSON_printbuffer buffer[1];
-    unsigned char *printed = NULL;
-
-    memset(buffer, 0, sizeof(buffer));
-
-    /* create buffer */
-    buffer->buffer = (unsigned char *)hooks->allocate(default_buffer_size);
-    buffer->length = default_buffer_size;
-    buffer->format = format;
-    buffer->hooks = *hooks;
-    if (buffer->buffer == NULL)
-    {
-        goto fail;
-    }
+    size_t length = 0;
 
-    /* print the value */
-    if (!MB_JSON_print_value(item, buffer))
+    switch (major)
     {
-        goto fail;
-    }
-    MB_JSON_update_offset(buffer);
+    case 0:
+    case 1:
+        return MB_JSON_cbor_integer(item, input, major == 1, value);
 
-    /* check if reallocate is available */
-    if (hooks->reallocate != NULL)
-    {
-        printed = (unsigned char *)hooks->reallocate(buffer->buffer, buffer->offset + 1);
-        if (printed == NULL)
-        {
-            goto fail;
-        }
-        buffer->buffer = NULL;
-    }
-    else /* otherwise copy the JSON over to a new buffer */
-    {
-        printed = (unsigned char *)hooks->allocate(buffer->offset + 1);
-        if (printed == NULL)
+    case 3:
+        item->valuestring = MB_JSON_cbor_read_text(input, info, value, &length);
+        if (item->valuestring == NULL)
         {
-            goto fail;
+            return false;
         }
-        memcpy(printed, buffer->buffer, MB_JSON_min(buffer->length, buffer->offset + 1));
-        printed[buffer->offset] = '\0'; /* just to be sure */
+        item->type = MB_JSON_String;
+        return true;
 
-        /* free the buffer */
-        hooks->deallocate(buffer->buffer);
-    }
+    case 4:
+    case 5:
+        return MB_JSON_cbor_parse_children(item, input, major, info, value);
 
-    return printed;
+    case 6:
+        /* tags only add meaning, the value that follows them is kept */
+        do
+        {
+            if (!MB_JSON_cbor_read_head(input, &major, &info, &value))
+            {
+                return false;
+            }
+        } while (major == 6);
+        return MB_JSON_cbor_parse_item(item, input, major, info, value);
 
-fail:
-    if (buffer->buffer != NULL)
-    {
-        hooks->deallocate(buffer->buffer);
-    }
+    case 7:
+        switch (info)
+        {
+        case 20:
+            item->type = MB_JSON_False;
+            return true;
+        case 21:
+            item->type = MB_JSON_True;
+#if !defined(MB_JSON_COMPACT_ITEMS)
+            item->valueint = 1;
+#endif
+            return true;
+        case 22:
+        case 23: /* undefined */
+            item->type = MB_JSON_NULL;
+            return true;
+        case 25:
+            item->type = MB_JSON_Number;
+            MB_JSON_set_number(item, MB_JSON_cbor_half(value));
+            return true;
+        case 26:
+        {
+            uint32_t bits = (uint32_t)value;
+            float f = 0;
+            memcpy(&f, &bits, sizeof(f));
+            item->type = MB_JSON_Number;
+            MB_JSON_set_number(item, f);
+            return true;
+        }
+        case 27:
+        {
+            double d = 0;
+            memcpy(&d, &value, sizeof(d));
+            item->type = MB_JSON_Number;
+            MB_JSON_set_number(item, d);
+            return true;
+        }
+        default:
+            return false; /* other simple values and a stray break */
+        }
 
-    if (printed != NULL)
-    {
-        hooks->deallocate(printed);
+    default:
+        return false; /* byte strings have no JSON form */
     }
-
-    return NULL;
 }
 
-/* Render a MB_JSON item/entity/structure to text. */
-MB_JSON_PUBLIC(char *)
-MB_JSON_Print(const MB_JSON *item)
+static MB_JSON_bool MB_JSON_cbor_parse_value(MB_JSON *const item, MB_JSON_cbor_input *const input)
 {
-    return (char *)MB_JSON_print(item, true, &MB_JSON_global_hooks);
-}
+    unsigned char major = 0;
+    unsigned char info = 0;
+    uint64_t value = 0;
 
-MB_JSON_PUBLIC(char *)
-MB_JSON_PrintUnformatted(const MB_JSON *item)
-{
-    return (char *)MB_JSON_print(item, false, &MB_JSON_global_hooks);
+    return MB_JSON_cbor_read_head(input, &major, &info, &value) && MB_JSON_cbor_parse_item(item, input, major, info, value);
 }
 
-MB_JSON_PUBLIC(char *)
-MB_JSON_PrintBuffered(const MB_JSON *item, int prebuffer, MB_JSON_bool fmt)
+static MB_JSON *MB_JSON_cbor_parse(MB_JSON_cbor_input *const input)
 {
-    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0}};
+    MB_JSON *item = NULL;
 
-    if (prebuffer < 0)
+    input->hooks = MB_JSON_global_hooks;
+
+    item = MB_JSON_New_Item(&MB_JSON_global_hooks);
+    if (item == NULL)
     {
         return NULL;
     }
 
-    p.buffer = (unsigned char *)MB_JSON_global_hooks.allocate((size_t)prebuffer);
-    if (!p.buffer)
+    if (!MB_JSON_cbor_parse_value(item, input))
     {
+        MB_JSON_Delete(item);
         return NULL;
     }
 
-    p.length = (size_t)prebuffer;
-    p.offset = 0;
-    p.noalloc = false;
-    p.format = fmt;
-    p.hooks = MB_JSON_global_hooks;
+    return item;
+}
 
-    if (!MB_JSON_print_value(item, &p))
+MB_JSON_PUBLIC(MB_JSON *)
+MB_JSON_ParseCBOR(const unsigned char *data, size_t length, size_t *used)
+{
+    MB_JSON_cbor_input input = {0, 0, 0, 0, 0, 0, {0, 0, 0}};
+    MB_JSON *item = NULL;
+
+    if ((data == NULL) || (length == 0))
     {
-        MB_JSON_global_hooks.deallocate(p.buffer);
         return NULL;
     }
 
-    return (char *)p.buffer;
+    input.content = data;
+    input.length = length;
+
+    item = MB_JSON_cbor_parse(&input);
+    if ((item != NULL) && (used != NULL))
+    {
+        *used = input.offset;
+    }
+
+    return item;
 }
 
-MB_JSON_PUBLIC(MB_JSON_bool)
-MB_JSON_PrintPreallocated(MB_JSON *item, char *buffer, const int length, const MB_JSON_bool format)
+MB_JSON_PUBLIC(MB_JSON *)
+MB_JSON_ParseCBORFromReader(MB_JSON_Reader read, void *user)
 {
-    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0}};
+    MB_JSON_cbor_input input = {0, 0, 0, 0, 0, 0, {0, 0, 0}};
 
-    if ((length < 0) || (buffer == NULL))
+    if (read == NULL)
     {
-        return false;
+        return NULL;
     }
 
-    p.buffer = (unsigned char *)buffer;
-    p.length = (size_t)length;
-    p.offset = 0;
-    p.noalloc = true;
-    p.format = format;
-    p.hooks = MB_JSON_global_hooks;
+    input.read = read;
+    input.user = user;
 
-    return MB_JSON_print_value(item, &p);
+    return MB_JSON_cbor_parse(&input);
 }
 
 /* Parser core - when encountering text, process appropriately. */
@@ -1433,7 +4170,9 @@ static MB_JSON_bool MB_JSON_parse_value(MB_JSON *const item, MB_JSON_parse_buffe
     if (MB_JSON_can_read(input_buffer, 4) && (strncmp((const char *)MB_JSON_buffer_at_offset(input_buffer), "true", 4) == 0))
     {
         item->type = MB_JSON_True;
+#if !defined(MB_JSON_COMPACT_ITEMS)
         item->valueint = 1;
+#endif
         input_buffer->offset += 4;
         return true;
     }
@@ -1478,6 +4217,9 @@ static MB_JSON_bool MB_JSON_get_value_buffer_length(const MB_JSON *const item, M
         buf_len->size += 4;
         return true;
 
+    case MB_JSON_Number:
+        return MB_JSON_get_number_buffer_length(item, buf_len);
+
     case MB_JSON_Raw:
     {
 
@@ -1632,8 +4374,7 @@ static MB_JSON_bool MB_JSON_parse_array(MB_JSON *const item, MB_JSON_parse_buffe
         else
         {
             /* add to the end and advance */
-            current_item->next = new_item;
-            new_item->prev = current_item;
+            MB_JSON_suffix_object(current_item, new_item);
             current_item = new_item;
         }
 
@@ -1655,13 +4396,9 @@ static MB_JSON_bool MB_JSON_parse_array(MB_JSON *const item, MB_JSON_parse_buffe
 success:
     input_buffer->depth--;
 
-    if (head != NULL)
-    {
-        head->prev = current_item;
-    }
-
     item->type = MB_JSON_Array;
     item->child = head;
+    MB_JSON_set_last_item(item, current_item);
 
     input_buffer->offset++;
 
@@ -1910,8 +4647,7 @@ static MB_JSON_bool MB_JSON_parse_object(MB_JSON *const item, MB_JSON_parse_buff
         else
         {
             /* add to the end and advance */
-            current_item->next = new_item;
-            new_item->prev = current_item;
+            MB_JSON_suffix_object(current_item, new_item);
             current_item = new_item;
         }
 
@@ -1927,6 +4663,16 @@ static MB_JSON_bool MB_JSON_parse_object(MB_JSON *const item, MB_JSON_parse_buff
         /* swap valuestring and string, because we parsed the name */
         current_item->string = current_item->valuestring;
         current_item->valuestring = NULL;
+        if (MB_JSON_intern_keys)
+        {
+            char *name = current_item->string;
+            current_item->string = MB_JSON_key_new(name, strlen(name), &(input_buffer->hooks));
+            input_buffer->hooks.deallocate(name);
+            if (current_item->string == NULL)
+            {
+                goto fail; /* allocation failure */
+            }
+        }
 
         if (MB_JSON_cannot_access_at_index(input_buffer, 0) || (MB_JSON_buffer_at_offset(input_buffer)[0] != ':'))
         {
@@ -1951,13 +4697,9 @@ static MB_JSON_bool MB_JSON_parse_object(MB_JSON *const item, MB_JSON_parse_buff
 success:
     input_buffer->depth--;
 
-    if (head != NULL)
-    {
-        head->prev = current_item;
-    }
-
     item->type = MB_JSON_Object;
     item->child = head;
+    MB_JSON_set_last_item(item, current_item);
 
     input_buffer->offset++;
     return true;
@@ -1979,13 +4721,13 @@ static MB_JSON_bool MB_JSON_get_object_buffer_length(const MB_JSON *const item,
     //'{' or "{\n"
     length = (size_t)(buf_len->format && current_item != NULL ? 2 : 1); 
 
+    buf_len->size += length;
+
     //do nothing for empty object
     if (current_item != NULL)
     {
         buf_len->depth++;
 
-        buf_len->size += length;
-
         while (current_item)
         {
             //'\t'
@@ -2210,20 +4952,15 @@ static MB_JSON *MB_JSON_get_object_item(const MB_JSON *const object, const char
         return NULL;
     }
 
-    current_element = object->child;
     if (case_sensitive)
     {
-        while ((current_element != NULL) && (current_element->string != NULL) && (strcmp(name, current_element->string) != 0))
-        {
-            current_element = current_element->next;
-        }
+        return MB_JSON_get_object_item_length(object, name, strlen(name));
     }
-    else
+
+    current_element = object->child;
+    while ((current_element != NULL) && (MB_JSON_case_insensitive_strcmp((const unsigned char *)name, (const unsigned char *)(current_element->string)) != 0))
     {
-        while ((current_element != NULL) && (MB_JSON_case_insensitive_strcmp((const unsigned char *)name, (const unsigned char *)(current_element->string)) != 0))
-        {
-            current_element = current_element->next;
-        }
+        current_element = current_element->next;
     }
 
     if ((current_element == NULL) || (current_element->string == NULL))
@@ -2246,17 +4983,16 @@ MB_JSON_GetObjectItemCaseSensitive(const MB_JSON *const object, const char *cons
     return MB_JSON_get_object_item(object, string, true);
 }
 
-MB_JSON_PUBLIC(MB_JSON_bool)
-MB_JSON_HasObjectItem(const MB_JSON *object, const char *string)
+MB_JSON_PUBLIC(MB_JSON *)
+MB_JSON_GetObjectItemCaseSensitiveWithLength(const MB_JSON *const object, const char *const string, size_t length)
 {
-    return MB_JSON_GetObjectItem(object, string) ? 1 : 0;
+    return MB_JSON_get_object_item_length(object, string, length);
 }
 
-/* Utility for array list handling. */
-static void MB_JSON_suffix_object(MB_JSON *prev, MB_JSON *item)
+MB_JSON_PUBLIC(MB_JSON_bool)
+MB_JSON_HasObjectItem(const MB_JSON *object, const char *string)
 {
-    prev->next = item;
-    item->prev = prev;
+    return MB_JSON_GetObjectItem(object, string) ? 1 : 0;
 }
 
 /* Utility for handling references. */
@@ -2277,7 +5013,10 @@ static MB_JSON *MB_JSON_create_reference(const MB_JSON *item, const MB_JSON_inte
     memcpy(reference, item, sizeof(MB_JSON));
     reference->string = NULL;
     reference->type |= MB_JSON_IsReference;
-    reference->next = reference->prev = NULL;
+    reference->next = NULL;
+#if !defined(MB_JSON_COMPACT_ITEMS)
+    reference->prev = NULL;
+#endif
     return reference;
 }
 
@@ -2290,26 +5029,20 @@ static MB_JSON_bool MB_JSON_add_item_to_array(MB_JSON *array, MB_JSON *item)
         return false;
     }
 
+    MB_JSON_index_drop(array);
     child = array->child;
-    /*
-     * To find the last item in array quickly, we use prev in array
-     */
+    item->next = NULL;
     if (child == NULL)
     {
         /* list is empty, start new one */
         array->child = item;
-        item->prev = item;
-        item->next = NULL;
     }
     else
     {
-        /* append to the end */
-        if (child->prev)
-        {
-            MB_JSON_suffix_object(child->prev, item);
-            array->child->prev = item;
-        }
+        /* append to the end, found quickly through the last item kept by the list */
+        MB_JSON_suffix_object(MB_JSON_last_item(array), item);
     }
+    MB_JSON_set_last_item(array, item);
 
     return true;
 }
@@ -2321,20 +5054,6 @@ MB_JSON_AddItemToArray(MB_JSON *array, MB_JSON *item)
     return MB_JSON_add_item_to_array(array, item);
 }
 
-#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-#pragma GCC diagnostic push
-#endif
-#ifdef __GNUC__
-#pragma GCC diagnostic ignored "-Wcast-qual"
-#endif
-/* helper function to cast away const */
-static void *cast_away_const(const void *string)
-{
-    return (void *)string;
-}
-#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-#pragma GCC diagnostic pop
-#endif
 
 static MB_JSON_bool MB_JSON_add_item_to_object(MB_JSON *const object, const char *const string, MB_JSON *const item, const MB_JSON_internal_hooks *const hooks, const MB_JSON_bool constant_key)
 {
@@ -2353,7 +5072,7 @@ static MB_JSON_bool MB_JSON_add_item_to_object(MB_JSON *const object, const char
     }
     else
     {
-        new_key = (char *)MB_JSON_strdup((const unsigned char *)string, hooks);
+        new_key = MB_JSON_key_new(string, strlen(string), hooks);
         if (new_key == NULL)
         {
             return false;
@@ -2364,7 +5083,7 @@ static MB_JSON_bool MB_JSON_add_item_to_object(MB_JSON *const object, const char
 
     if (!(item->type & MB_JSON_StringIsConst) && (item->string != NULL))
     {
-        hooks->deallocate(item->string);
+        MB_JSON_key_free(item->string, hooks);
     }
 
     item->string = new_key;
@@ -2528,35 +5247,46 @@ MB_JSON_AddArrayToObject(MB_JSON *const object, const char *const name)
 MB_JSON_PUBLIC(MB_JSON *)
 MB_JSON_DetachItemViaPointer(MB_JSON *parent, MB_JSON *const item)
 {
+    MB_JSON *previous = NULL;
+
     if ((parent == NULL) || (item == NULL))
     {
         return NULL;
     }
 
-    if (item != parent->child)
+    MB_JSON_index_drop(parent);
+    previous = MB_JSON_previous_item(parent, item);
+    if (item == parent->child)
     {
-        /* not the first element */
-        item->prev->next = item->next;
+        /* first element */
+        parent->child = item->next;
     }
-    if (item->next != NULL)
+    else if (previous == NULL)
     {
-        /* not the last element */
-        item->next->prev = item->prev;
+        return NULL; /* not a child of parent */
+    }
+    else
+    {
+        previous->next = item->next;
     }
 
-    if (item == parent->child)
+#if !defined(MB_JSON_COMPACT_ITEMS)
+    if (item->next != NULL)
     {
-        /* first element */
-        parent->child = item->next;
+        /* not the last element */
+        item->next->prev = item->prev;
     }
-    else if (item->next == NULL)
+#endif
+    if (item->next == NULL)
     {
         /* last element */
-        parent->child->prev = item->prev;
+        MB_JSON_set_last_item(parent, previous);
     }
 
     /* make sure the detached item doesn't point anywhere anymore */
+#if !defined(MB_JSON_COMPACT_ITEMS)
     item->prev = NULL;
+#endif
     item->next = NULL;
 
     return item;
@@ -2612,6 +5342,7 @@ MB_JSON_PUBLIC(MB_JSON_bool)
 MB_JSON_InsertItemInArray(MB_JSON *array, int which, MB_JSON *newitem)
 {
     MB_JSON *after_inserted = NULL;
+    MB_JSON *previous = NULL;
 
     if (which < 0)
     {
@@ -2624,16 +5355,20 @@ MB_JSON_InsertItemInArray(MB_JSON *array, int which, MB_JSON *newitem)
         return MB_JSON_add_item_to_array(array, newitem);
     }
 
+    MB_JSON_index_drop(array);
+    previous = MB_JSON_previous_item(array, after_inserted);
     newitem->next = after_inserted;
+#if !defined(MB_JSON_COMPACT_ITEMS)
     newitem->prev = after_inserted->prev;
     after_inserted->prev = newitem;
+#endif
     if (after_inserted == array->child)
     {
         array->child = newitem;
     }
     else
     {
-        newitem->prev->next = newitem;
+        previous->next = newitem;
     }
     return true;
 }
@@ -2641,6 +5376,8 @@ MB_JSON_InsertItemInArray(MB_JSON *array, int which, MB_JSON *newitem)
 MB_JSON_PUBLIC(MB_JSON_bool)
 MB_JSON_ReplaceItemViaPointer(MB_JSON *const parent, MB_JSON *const item, MB_JSON *replacement)
 {
+    MB_JSON *previous = NULL;
+
     if ((parent == NULL) || (replacement == NULL) || (item == NULL))
     {
         return false;
@@ -2651,38 +5388,38 @@ MB_JSON_ReplaceItemViaPointer(MB_JSON *const parent, MB_JSON *const item, MB_JSO
         return true;
     }
 
+    MB_JSON_index_drop(parent);
+    previous = MB_JSON_previous_item(parent, item);
+    if (parent->child == item)
+    {
+        parent->child = replacement;
+    }
+    else if (previous == NULL)
+    {
+        return false; /* not a child of parent */
+    }
+    else
+    {
+        previous->next = replacement;
+    }
     replacement->next = item->next;
+#if !defined(MB_JSON_COMPACT_ITEMS)
     replacement->prev = item->prev;
-
     if (replacement->next != NULL)
     {
         replacement->next->prev = replacement;
     }
-    if (parent->child == item)
+#endif
+    if (replacement->next == NULL)
     {
-        if (parent->child->prev == parent->child)
-        {
-            replacement->prev = replacement;
-        }
-        parent->child = replacement;
-    }
-    else
-    { /*
-         * To find the last item in array quickly, we use prev in array.
-         * We can't modify the last item's next pointer where this item was the parent's child
-         */
-        if (replacement->prev != NULL)
-        {
-            replacement->prev->next = replacement;
-        }
-        if (replacement->next == NULL)
-        {
-            parent->child->prev = replacement;
-        }
+        /* last element */
+        MB_JSON_set_last_item(parent, replacement);
     }
 
     item->next = NULL;
+#if !defined(MB_JSON_COMPACT_ITEMS)
     item->prev = NULL;
+#endif
     MB_JSON_Delete(item);
 
     return true;
@@ -2709,9 +5446,9 @@ static MB_JSON_bool MB_JSON_replace_item_in_object(MB_JSON *object, const char *
     /* replace the name in the replacement */
     if (!(replacement->type & MB_JSON_StringIsConst) && (replacement->string != NULL))
     {
-        MB_JSON_free(replacement->string);
+        MB_JSON_key_free(replacement->string, &MB_JSON_global_hooks);
     }
-    replacement->string = (char *)MB_JSON_strdup((const unsigned char *)string, &MB_JSON_global_hooks);
+    replacement->string = MB_JSON_key_new(string, strlen(string), &MB_JSON_global_hooks);
     replacement->type &= ~MB_JSON_StringIsConst;
 
     return MB_JSON_ReplaceItemViaPointer(object, MB_JSON_get_object_item(object, string, case_sensitive), replacement);
@@ -2785,21 +5522,7 @@ MB_JSON_CreateNumber(double num)
     if (item)
     {
         item->type = MB_JSON_Number;
-        item->valuedouble = num;
-
-        /* use saturation in case of overflow */
-        if (num >= INT_MAX)
-        {
-            item->valueint = INT_MAX;
-        }
-        else if (num <= (double)INT_MIN)
-        {
-            item->valueint = INT_MIN;
-        }
-        else
-        {
-            item->valueint = (int)num;
-        }
+        MB_JSON_set_number(item, num);
     }
 
     return item;
@@ -2941,7 +5664,7 @@ MB_JSON_CreateIntArray(const int *numbers, int count)
 
     if (a && a->child)
     {
-        a->child->prev = n;
+        MB_JSON_set_last_item(a, n);
     }
 
     return a;
@@ -2983,7 +5706,7 @@ MB_JSON_CreateFloatArray(const float *numbers, int count)
 
     if (a && a->child)
     {
-        a->child->prev = n;
+        MB_JSON_set_last_item(a, n);
     }
 
     return a;
@@ -3025,7 +5748,7 @@ MB_JSON_CreateDoubleArray(const double *numbers, int count)
 
     if (a && a->child)
     {
-        a->child->prev = n;
+        MB_JSON_set_last_item(a, n);
     }
 
     return a;
@@ -3067,7 +5790,7 @@ MB_JSON_CreateStringArray(const char *const *strings, int count)
 
     if (a && a->child)
     {
-        a->child->prev = n;
+        MB_JSON_set_last_item(a, n);
     }
 
     return a;
@@ -3095,9 +5818,16 @@ MB_JSON_Duplicate(const MB_JSON *item, MB_JSON_bool recurse)
     }
     /* Copy over all vars */
     newitem->type = item->type & (~MB_JSON_IsReference);
+#if defined(MB_JSON_COMPACT_ITEMS)
+    if (item->type & MB_JSON_Number)
+    {
+        newitem->valuedouble = item->valuedouble;
+    }
+#else
     newitem->valueint = item->valueint;
     newitem->valuedouble = item->valuedouble;
-    if (item->valuestring)
+#endif
+    if ((item->type & (MB_JSON_String | MB_JSON_Raw)) && item->valuestring)
     {
         newitem->valuestring = (char *)MB_JSON_strdup((unsigned char *)item->valuestring, &MB_JSON_global_hooks);
         if (!newitem->valuestring)
@@ -3107,7 +5837,7 @@ MB_JSON_Duplicate(const MB_JSON *item, MB_JSON_bool recurse)
     }
     if (item->string)
     {
-        newitem->string = (item->type & MB_JSON_StringIsConst) ? item->string : (char *)MB_JSON_strdup((unsigned char *)item->string, &MB_JSON_global_hooks);
+        newitem->string = (item->type & MB_JSON_StringIsConst) ? item->string : MB_JSON_key_copy(item->string, &MB_JSON_global_hooks);
         if (!newitem->string)
         {
             goto fail;
@@ -3130,8 +5860,7 @@ MB_JSON_Duplicate(const MB_JSON *item, MB_JSON_bool recurse)
         if (next != NULL)
         {
             /* If newitem->child already set, then crosswire ->prev and ->next and move on */
-            next->next = newchild;
-            newchild->prev = next;
+            MB_JSON_suffix_object(next, newchild);
             next = newchild;
         }
         else
@@ -3144,7 +5873,7 @@ MB_JSON_Duplicate(const MB_JSON *item, MB_JSON_bool recurse)
     }
     if (newitem && newitem->child)
     {
-        newitem->child->prev = newchild;
+        MB_JSON_set_last_item(newitem, newchild);
     }
 
     return newitem;
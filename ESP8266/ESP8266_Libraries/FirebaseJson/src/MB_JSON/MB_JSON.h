@@ -31,6 +31,17 @@
 #ifndef MB_JSON_H
 #define MB_JSON_H
 
+/* FirebaseJson selects the item layout in FBJS_Config.h, found the same way as by FirebaseJson.h so that a config
+ * supplied by the sketch applies to both */
+#if defined __has_include
+#if __has_include(<FBJS_Config.h>)
+#include <FBJS_Config.h>
+#endif
+#endif
+#if defined(FIREBASEJSON_COMPACT_ITEMS) && !defined(MB_JSON_COMPACT_ITEMS)
+#define MB_JSON_COMPACT_ITEMS
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -108,6 +119,33 @@ then using the MB_JSON_API_VISIBILITY flag to "export" the same symbols the way
 #define MB_JSON_StringIsConst 512
 
 /* The MB_JSON structure: */
+#if defined(MB_JSON_COMPACT_ITEMS)
+/* Compact layout, 24 bytes per item on 32-bit targets instead of 40: no prev link and no valueint, and only one value
+ * is stored per type. Every file including this header must agree on MB_JSON_COMPACT_ITEMS. */
+typedef struct MB_JSON
+{
+    /* next allows you to walk array/object chains. Alternatively, use GetArraySize/GetArrayItem/GetObjectItem */
+    struct MB_JSON *next;
+    /* An array or object item will have a child pointer pointing to a chain of the items in the array/object. */
+    struct MB_JSON *child;
+
+    /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
+    char *string;
+
+    /* The type of the item, as above. */
+    int type;
+
+    union
+    {
+        /* The item's string, if type==MB_JSON_String  and type == MB_JSON_Raw */
+        char *valuestring;
+        /* The item's number, if type==MB_JSON_Number */
+        double valuedouble;
+        /* The last item of the chain in child, if type==MB_JSON_Array or type==MB_JSON_Object */
+        struct MB_JSON *last;
+    };
+} MB_JSON;
+#else
 typedef struct MB_JSON
 {
     /* next/prev allow you to walk array/object chains. Alternatively, use GetArraySize/GetArrayItem/GetObjectItem */
@@ -129,6 +167,7 @@ typedef struct MB_JSON
     /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
     char *string;
 } MB_JSON;
+#endif
 
 typedef struct MB_JSON_Hooks
 {
@@ -146,15 +185,49 @@ typedef int MB_JSON_bool;
 #define MB_JSON_NESTING_LIMIT 1000
 #endif
 
+/* Members a lookup by name walks before the object gets a hash index, and how many objects have one at a time.
+ * See MB_JSON_IndexObjects. */
+#ifndef MB_JSON_INDEX_MIN_ITEMS
+#define MB_JSON_INDEX_MIN_ITEMS 16
+#endif
+#ifndef MB_JSON_INDEX_LIMIT
+#define MB_JSON_INDEX_LIMIT 4
+#endif
+
 /* returns the version of MB_JSON as a string */
 MB_JSON_PUBLIC(const char*) MB_JSON_Version(void);
 
 /* Supply malloc, realloc and free functions to MB_JSON */
 MB_JSON_PUBLIC(void) MB_JSON_InitHooks(MB_JSON_Hooks* hooks);
 
+/* Share one copy of every object key among the items created while enabled, e.g. the member names repeated in every
+ * element of an array. Shared keys are taken from malloc_fn, never from an arena, and freed with their last item. */
+MB_JSON_PUBLIC(void) MB_JSON_InternKeys(MB_JSON_bool enable);
+
+/* Let the case sensitive lookups by name index the members of large objects, so the next lookups in them don't walk
+ * the members. The indexes are taken from malloc_fn and dropped when the members change, disabling frees them. */
+MB_JSON_PUBLIC(void) MB_JSON_IndexObjects(MB_JSON_bool enable);
+
+/* Arena of a single block to allocate a tree from, which frees it at once with MB_JSON_ArenaReset instead of item by
+ * item. While an arena is selected, every allocation is taken from it and falls back to the malloc_fn of
+ * MB_JSON_InitHooks when it is full. The block itself is taken from malloc_fn. Pointers in an arena can be freed
+ * (or MB_JSON_Delete'd) at any time, which is a no-op except for the last allocation. Not thread safe, like
+ * MB_JSON_InitHooks. */
+typedef struct MB_JSON_Arena MB_JSON_Arena;
+
+MB_JSON_PUBLIC(MB_JSON_Arena *) MB_JSON_ArenaCreate(size_t size);
+/* Selects the arena for the next allocations, NULL for the heap. Returns the previous one. */
+MB_JSON_PUBLIC(MB_JSON_Arena *) MB_JSON_ArenaSelect(MB_JSON_Arena *arena);
+/* Bytes taken from the block, and how many of them are still in use. */
+MB_JSON_PUBLIC(size_t) MB_JSON_ArenaUsed(const MB_JSON_Arena *arena);
+MB_JSON_PUBLIC(size_t) MB_JSON_ArenaLive(const MB_JSON_Arena *arena);
+/* Frees everything allocated from the arena, nothing in it must be used afterwards. */
+MB_JSON_PUBLIC(void) MB_JSON_ArenaReset(MB_JSON_Arena *arena);
+MB_JSON_PUBLIC(void) MB_JSON_ArenaDelete(MB_JSON_Arena *arena);
+
 size_t MB_JSON_SerializedBufferLength(const MB_JSON *const item, MB_JSON_bool format);
 
-/* Memory Management: the caller is always responsible to free the results from all variants of MB_JSON_Parse (with MB_JSON_Delete) and MB_JSON_Print (with stdlib free, MB_JSON_Hooks.free_fn, or MB_JSON_free as appropriate). The exception is MB_JSON_PrintPreallocated, where the caller has full responsibility of the buffer. */
+/* Memory Management: the caller is always responsible to free the results from all variants of MB_JSON_Parse (with MB_JSON_Delete) and MB_JSON_Print (with stdlib free, MB_JSON_Hooks.free_fn, or MB_JSON_free as appropriate). While an arena is selected, print buffers are taken from it, so whenever one may be selected they must be freed with MB_JSON_free. The exception is MB_JSON_PrintPreallocated, where the caller has full responsibility of the buffer. */
 /* Supply a block of JSON, and this returns a MB_JSON object you can interrogate. */
 MB_JSON_PUBLIC(MB_JSON *)
 MB_JSON_Parse(const char *value);
@@ -164,6 +237,29 @@ MB_JSON_PUBLIC(MB_JSON *) MB_JSON_ParseWithLength(const char *value, size_t buff
 MB_JSON_PUBLIC(MB_JSON *) MB_JSON_ParseWithOpts(const char *value, const char **return_parse_end, MB_JSON_bool require_null_terminated);
 MB_JSON_PUBLIC(MB_JSON *) MB_JSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, MB_JSON_bool require_null_terminated);
 
+/* Incremental parser for input that arrives in chunks, e.g. from a network client. The tree is built while the
+ * input is fed, so only the string or number being read is buffered, never the whole text. */
+typedef struct MB_JSON_Stream MB_JSON_Stream;
+
+/* Results of MB_JSON_StreamFeed and MB_JSON_StreamEnd */
+#define MB_JSON_StreamMore (0)   /* the value is not complete yet */
+#define MB_JSON_StreamDone (1)   /* a complete value was parsed, get it with MB_JSON_StreamDetach */
+#define MB_JSON_StreamError (-1) /* syntax error or allocation failure at MB_JSON_StreamPosition */
+
+MB_JSON_PUBLIC(MB_JSON_Stream *) MB_JSON_StreamCreate(void);
+/* Parses the next length characters. Input after the end of the value is not consumed, consumed (if not NULL) returns
+ * how many characters were. */
+MB_JSON_PUBLIC(int) MB_JSON_StreamFeed(MB_JSON_Stream *stream, const char *data, size_t length, size_t *consumed);
+/* Signals the end of the input, which completes a number at the root. */
+MB_JSON_PUBLIC(int) MB_JSON_StreamEnd(MB_JSON_Stream *stream);
+/* Returns the parsed value (to free with MB_JSON_Delete) and resets the stream for the next one. */
+MB_JSON_PUBLIC(MB_JSON *) MB_JSON_StreamDetach(MB_JSON_Stream *stream);
+/* Number of characters parsed since the last reset. */
+MB_JSON_PUBLIC(size_t) MB_JSON_StreamPosition(const MB_JSON_Stream *stream);
+/* Drops the partial value and any error, keeping the buffers for reuse. */
+MB_JSON_PUBLIC(void) MB_JSON_StreamReset(MB_JSON_Stream *stream);
+MB_JSON_PUBLIC(void) MB_JSON_StreamDelete(MB_JSON_Stream *stream);
+
 /* Render a MB_JSON entity to text for transfer/storage. */
 MB_JSON_PUBLIC(char *) MB_JSON_Print(const MB_JSON *item);
 /* Render a MB_JSON entity to text for transfer/storage without any formatting. */
@@ -173,6 +269,23 @@ MB_JSON_PUBLIC(char *) MB_JSON_PrintBuffered(const MB_JSON *item, int prebuffer,
 /* Render a MB_JSON entity to text using a buffer already allocated in memory with given length. Returns 1 on success and 0 on failure. */
 /* NOTE: MB_JSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need */
 MB_JSON_PUBLIC(MB_JSON_bool) MB_JSON_PrintPreallocated(MB_JSON *item, char *buffer, const int length, const MB_JSON_bool format);
+/* Render a MB_JSON entity to text in pieces, through a buffer of the given length that the caller owns. Every piece is
+ * passed to write as soon as the buffer is full, terminated by '\0' at data[length]; returning false from write stops
+ * the printing. Only a string longer than the buffer takes a larger one from malloc_fn for a while. */
+typedef MB_JSON_bool (*MB_JSON_Writer)(const char *data, size_t length, void *user);
+MB_JSON_PUBLIC(MB_JSON_bool) MB_JSON_PrintToWriter(const MB_JSON *item, MB_JSON_bool format, char *buffer, size_t length, MB_JSON_Writer write, void *user);
+/* Render a MB_JSON entity as CBOR (RFC 8949): through a writer like MB_JSON_PrintToWriter (the buffer holds at least 10
+ * bytes), or into a buffer returning the number of bytes, 0 when it does not fit. MB_JSON_CBORLength counts the bytes.
+ * Integers are written as integers, other numbers as float32 when that is exact and float64 otherwise. */
+MB_JSON_PUBLIC(MB_JSON_bool) MB_JSON_PrintCBORToWriter(const MB_JSON *item, char *buffer, size_t length, MB_JSON_Writer write, void *user);
+MB_JSON_PUBLIC(size_t) MB_JSON_PrintCBORPreallocated(const MB_JSON *item, unsigned char *buffer, size_t length);
+MB_JSON_PUBLIC(size_t) MB_JSON_CBORLength(const MB_JSON *item);
+/* Build a MB_JSON entity from one CBOR item, in memory (used gets the number of bytes read) or pulled from read, which
+ * returns how many of the requested bytes it filled, 0 at the end. Byte strings and keys that are not text are rejected,
+ * tags are skipped, and integers beyond 2^53 are kept exactly as raw text. */
+typedef size_t (*MB_JSON_Reader)(unsigned char *data, size_t length, void *user);
+MB_JSON_PUBLIC(MB_JSON *) MB_JSON_ParseCBOR(const unsigned char *data, size_t length, size_t *used);
+MB_JSON_PUBLIC(MB_JSON *) MB_JSON_ParseCBORFromReader(MB_JSON_Reader read, void *user);
 /* Delete a MB_JSON entity and all subentities. */
 MB_JSON_PUBLIC(void) MB_JSON_Delete(MB_JSON *item);
 
@@ -183,6 +296,8 @@ MB_JSON_PUBLIC(MB_JSON *) MB_JSON_GetArrayItem(const MB_JSON *array, int index);
 /* Get item "string" from object. Case insensitive. */
 MB_JSON_PUBLIC(MB_JSON *) MB_JSON_GetObjectItem(const MB_JSON * const object, const char * const string);
 MB_JSON_PUBLIC(MB_JSON *) MB_JSON_GetObjectItemCaseSensitive(const MB_JSON * const object, const char * const string);
+/* Get the item named by the first length characters of "string", which needs no terminating '\0'. Case sensitive. */
+MB_JSON_PUBLIC(MB_JSON *) MB_JSON_GetObjectItemCaseSensitiveWithLength(const MB_JSON * const object, const char * const string, size_t length);
 MB_JSON_PUBLIC(MB_JSON_bool) MB_JSON_HasObjectItem(const MB_JSON *object, const char *string);
 /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when MB_JSON_Parse() returns 0. 0 when MB_JSON_Parse() succeeds. */
 MB_JSON_PUBLIC(const char *) MB_JSON_GetErrorPtr(void);
@@ -191,6 +306,13 @@ MB_JSON_PUBLIC(const char *) MB_JSON_GetErrorPtr(void);
 MB_JSON_PUBLIC(char *) MB_JSON_GetStringValue(const MB_JSON * const item);
 MB_JSON_PUBLIC(double) MB_JSON_GetNumberValue(const MB_JSON * const item);
 
+/* Convert between numbers and JSON text without sprintf/strtod in the common cases.
+ * MB_JSON_FormatNumber writes the shortest text that reads back as the same double (NaN and Infinity as null)
+ * into a buffer of at least 26 bytes and returns its length. MB_JSON_ParseNumber reads a number from the first
+ * length characters of value and returns how many it used, 0 if value does not start with a number. */
+MB_JSON_PUBLIC(int) MB_JSON_FormatNumber(double number, char *buffer);
+MB_JSON_PUBLIC(size_t) MB_JSON_ParseNumber(const char *value, size_t length, double *number);
+
 /* These functions check the type of an item */
 MB_JSON_PUBLIC(MB_JSON_bool) MB_JSON_IsInvalid(const MB_JSON * const item);
 MB_JSON_PUBLIC(MB_JSON_bool) MB_JSON_IsFalse(const MB_JSON * const item);
@@ -283,8 +405,13 @@ MB_JSON_PUBLIC(MB_JSON*) MB_JSON_AddRawToObject(MB_JSON * const object, const ch
 MB_JSON_PUBLIC(MB_JSON*) MB_JSON_AddObjectToObject(MB_JSON * const object, const char * const name);
 MB_JSON_PUBLIC(MB_JSON*) MB_JSON_AddArrayToObject(MB_JSON * const object, const char * const name);
 
+#if defined(MB_JSON_COMPACT_ITEMS)
+/* Integers are stored in valuedouble. */
+#define MB_JSON_SetIntValue(object, number) ((object) ? (object)->valuedouble = (number) : (number))
+#else
 /* When assigning an integer value, it needs to be propagated to valuedouble too. */
 #define MB_JSON_SetIntValue(object, number) ((object) ? (object)->valueint = (object)->valuedouble = (number) : (number))
+#endif
 /* helper for the MB_JSON_SetNumberValue macro */
 MB_JSON_PUBLIC(double) MB_JSON_SetNumberHelper(MB_JSON *object, double number);
 #define MB_JSON_SetNumberValue(object, number) ((object != NULL) ? MB_JSON_SetNumberHelper(object, (double)number) : (number))
@@ -294,7 +421,7 @@ MB_JSON_PUBLIC(char*) MB_JSON_SetValuestring(MB_JSON *object, const char *values
 /* Macro for iterating over an array or object */
 #define MB_JSON_ArrayForEach(element, array) for(element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
 
-/* malloc/free objects using the malloc/free functions that have been set with MB_JSON_InitHooks */
+/* malloc/free objects using the selected arena or the malloc/free functions that have been set with MB_JSON_InitHooks */
 MB_JSON_PUBLIC(void *) MB_JSON_malloc(size_t size);
 MB_JSON_PUBLIC(void) MB_JSON_free(void *object);
 
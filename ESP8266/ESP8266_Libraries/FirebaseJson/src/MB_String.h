@@ -97,6 +97,14 @@
 #define ESP8266_USE_EXTERNAL_HEAP
 #endif
 
+// Bytes kept inside the object for short strings before the heap is used, 0 to always use the heap
+#if defined(ESP8266_USE_EXTERNAL_HEAP)
+#undef MB_STRING_INLINE_SIZE
+#define MB_STRING_INLINE_SIZE 0
+#elif !defined(MB_STRING_INLINE_SIZE)
+#define MB_STRING_INLINE_SIZE 16
+#endif
+
 #if defined(ESP8266) || defined(ESP32)
 #define MBSTRING_FLASH_MCR FPSTR
 #elif defined(ARDUINO_ARCH_SAMD) || defined(__AVR_ATmega4809__) || defined(ARDUINO_NANO_RP2040_CONNECT)
@@ -517,6 +525,11 @@ public:
         *this = value;
     }
 
+    MB_String(MB_String &&value) noexcept
+    {
+        move(value);
+    }
+
     MB_String(const __FlashStringHelper *str)
     {
         *this = str;
@@ -601,45 +614,17 @@ public:
 
     MB_String(float value, unsigned char decimalPlaces = 2)
     {
-        reserve(33);
-        if (bufLen > 0)
-        {
-            char *v = toFloatStr(value, 0, decimalPlaces);
-            if (v)
-            {
-                strcpy(buf, v);
-                delP(&v);
-            }
-        }
+        appendFloat(value, 0, decimalPlaces);
     }
 
     MB_String(double value, unsigned char decimalPlaces = 3)
     {
-        reserve(33);
-
-        if (bufLen > 0)
-        {
-            char *v = toFloatStr(value, 1, decimalPlaces);
-            if (v)
-            {
-                strcpy(buf, v);
-                delP(&v);
-            }
-        }
+        appendFloat(value, 1, decimalPlaces);
     }
 
     MB_String(long double value, unsigned char decimalPlaces = 3)
     {
-        reserve(65);
-        if (bufLen > 0)
-        {
-            char *v = toFloatStr(value, 2, decimalPlaces);
-            if (v)
-            {
-                strcpy(buf, v);
-                delP(&v);
-            }
-        }
+        appendFloat(value, 2, decimalPlaces);
     }
 
 #if !defined(__AVR__)
@@ -741,6 +726,14 @@ public:
         return *this;
     }
 
+    MB_String &operator=(MB_String &&rhs) noexcept
+    {
+        if (this != &rhs)
+            move(rhs);
+
+        return *this;
+    }
+
     MB_String &operator+=(const MB_String &rhs)
     {
         concat(rhs);
@@ -889,33 +882,34 @@ public:
     template <typename T = int>
     auto appendNum(T value, int precision = 0) -> typename std::enable_if<is_num_int<T>::value || is_bool<T>::value, MB_String &>::type
     {
-        char *s = NULL;
-
         if (is_bool<T>::value)
-            s = boolStr(value);
-        else if (is_num_neg_int<T>::value)
         {
-#if defined(ARDUINO_ARCH_SAMD) || defined(__AVR_ATmega4809__) || defined(ARDUINO_NANO_RP2040_CONNECT)
-            s = int32Str(value);
-#else
-            s = int64Str(value);
-#endif
+            *this += value ? (const char *)MBSTRING_FLASH_MCR("true") : (const char *)MBSTRING_FLASH_MCR("false");
+            return (*this);
         }
-        else if (is_num_pos_int<T>::value)
-        {
+
 #if defined(ARDUINO_ARCH_SAMD) || defined(__AVR_ATmega4809__) || defined(ARDUINO_NANO_RP2040_CONNECT)
-            s = uint32Str(value);
+        typedef unsigned long num_t;
 #else
-            s = uint64Str(value);
+        typedef unsigned long long num_t;
 #endif
-        }
-
-        if (s)
+        // the digits are written backwards from the end of a stack buffer
+        char s[24];
+        char *p = s + sizeof(s) - 1;
+        bool negative = is_num_neg_int<T>::value && static_cast<long long>(value) < 0;
+        num_t n = negative ? 0 - (num_t)value : (num_t)value;
+
+        *p = '\0';
+        do
         {
-            *this += s;
-            delP(&s);
-        }
+            *--p = '0' + n % 10;
+            n /= 10;
+        } while (n > 0);
+
+        if (negative)
+            *--p = '-';
 
+        concat(p, s + sizeof(s) - 1 - p);
         return (*this);
     }
 
@@ -924,12 +918,7 @@ public:
         if (precision < 0)
             precision = 5;
 
-        char *s = toFloatStr(value, 0, precision);
-        if (s)
-        {
-            *this += s;
-            delP(&s);
-        }
+        appendFloat(value, 0, precision);
         return (*this);
     }
 
@@ -938,12 +927,7 @@ public:
         if (precision < 0)
             precision = 9;
 
-        char *s = toFloatStr(value, 1, precision);
-        if (s)
-        {
-            *this += s;
-            delP(&s);
-        }
+        appendFloat(value, 1, precision);
         return (*this);
     }
 
@@ -952,12 +936,7 @@ public:
         if (precision < 0)
             precision = 9;
 
-        char *s = toFloatStr(value, 2, precision);
-        if (s)
-        {
-            *this += s;
-            delP(&s);
-        }
+        appendFloat(value, 2, precision);
         return (*this);
     }
 
@@ -1195,12 +1174,14 @@ public:
         }
     }
 
+    // The buffer is kept for the next contents, shrink_to_fit() returns it.
     void clear()
     {
 #if defined(ESP8266_USE_EXTERNAL_HEAP)
         reset(1);
 #else
-        allocate(0, false);
+        if (buf)
+            buf[0] = '\0';
 #endif
     }
 
@@ -1470,63 +1451,85 @@ public:
     static const size_t npos = -1;
 
 private:
-#if defined(ARDUINO_ARCH_SAMD) || defined(__AVR_ATmega4809__) || defined(ARDUINO_NANO_RP2040_CONNECT)
-
-    char *int32Str(signed long value)
+    void appendFloat(long double value, int type, int precision)
     {
-        char *t = (char *)newP(64);
-        sprintf(t, (const char *)MBSTRING_FLASH_MCR("%ld"), value);
-        return t;
-    }
+        char t[32];
 
-    char *uint32Str(unsigned long value)
-    {
-        char *t = (char *)newP(64);
-        sprintf(t, (const char *)MBSTRING_FLASH_MCR("%lu"), value);
-        return t;
-    }
+        if (type == 2 || !fixedFloatStr(t, (double)value, precision))
+        {
+            MB_String fmt = MBSTRING_FLASH_MCR("%.");
+            fmt += precision;
+            if (type == 2)
+                fmt += MBSTRING_FLASH_MCR("L");
+            fmt += MBSTRING_FLASH_MCR("f");
 
-#endif
+            int len = type == 2 ? snprintf(t, sizeof(t), fmt.c_str(), value) : snprintf(t, sizeof(t), fmt.c_str(), (double)value);
 
-    char *int64Str(signed long long value)
-    {
-        char *t = (char *)newP(64);
-        sprintf(t, (const char *)MBSTRING_FLASH_MCR("%lld"), value);
-        return t;
-    }
+            // very large values only
+            if (len >= (int)sizeof(t))
+            {
+                char *s = (char *)newP(len + 1);
+                if (s)
+                {
+                    type == 2 ? snprintf(s, len + 1, fmt.c_str(), value) : snprintf(s, len + 1, fmt.c_str(), (double)value);
+                    trim(s);
+                    *this += s;
+                    delP(&s);
+                }
+                return;
+            }
+        }
 
-    char *uint64Str(unsigned long long value)
-    {
-        char *t = (char *)newP(64);
-        sprintf(t, (const char *)MBSTRING_FLASH_MCR("%llu"), value);
-        return t;
+        trim(t);
+        *this += t;
     }
 
-    char *boolStr(bool value)
+    // Prints the same text as "%.<precision>f" with integer arithmetic.
+    // Returns false for values that need sprintf, i.e. too large ones and
+    // the ones too close to a rounding tie to decide from the scaled double.
+    bool fixedFloatStr(char *s, double value, int precision)
     {
-        char *t = (char *)newP(8);
-        value ? strcpy(t, (const char *)MBSTRING_FLASH_MCR("true")) : strcpy(t, (const char *)MBSTRING_FLASH_MCR("false"));
-        return t;
-    }
+        static const uint32_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
 
-    char *toFloatStr(long double value, int type, int precision)
-    {
-        int width = type == 0 ? 32 : 64;
+        if (precision < 0 || precision > 9 || !(value > -9007199254740992.0 && value < 9007199254740992.0))
+            return false;
 
-        char *t = (char *)newP(width);
+        bool negative = value < 0 || (value == 0 && 1 / value < 0);
+        double scaled = (negative ? -value : value) * pow10[precision];
 
-        if (t)
+        if (scaled >= 9007199254740992.0)
+            return false;
+
+        uint64_t n = (uint64_t)scaled;
+        double tie = scaled - (double)n - 0.5;
+
+        // the product is off by half an ulp at most
+        if ((tie < 0 ? -tie : tie) <= scaled * 2.3e-16)
+            return false;
+
+        if (tie > 0)
+            n++;
+
+        char digits[24];
+        int len = 0;
+        do
         {
-            MB_String fmt = MBSTRING_FLASH_MCR("%.");
-            fmt += precision;
-            if (type == 2)
-                fmt += MBSTRING_FLASH_MCR("L");
-            fmt += MBSTRING_FLASH_MCR("f");
-            sprintf(t, fmt.c_str(), value);
-            trim(t);
+            digits[len++] = '0' + n % 10;
+            n /= 10;
+        } while (n > 0 || len <= precision);
+
+        if (negative)
+            *s++ = '-';
+        while (len > precision)
+            *s++ = digits[--len];
+        if (precision > 0)
+        {
+            *s++ = '.';
+            while (len > 0)
+                *s++ = digits[--len];
         }
-
-        return t;
+        *s = '\0';
+        return true;
     }
 
     char *nullStr()
@@ -1545,7 +1548,7 @@ private:
 
     void trim(char *s)
     {
-        if (!s)
+        if (!s || !strchr(s, '.'))
             return;
         size_t i = strlen(s) - 1;
         while (s[i] == '0' && i > 0)
@@ -1676,23 +1679,32 @@ private:
 
     void move(MB_String &rhs)
     {
-        if (buf)
+        // a heap buffer changes hands, inline contents are copied
+        if (rhs.buf && rhs.buf != rhs.inlineBuf)
         {
-            if (bufLen >= rhs.bufLen)
-            {
-                strcpy(buf, rhs.buf);
-                bufLen = rhs.bufLen;
-                rhs.bufLen = 0;
-                return;
-            }
+            allocate(0, false);
+            buf = rhs.buf;
+            bufLen = rhs.bufLen;
+            rhs.buf = NULL;
+            rhs.bufLen = 0;
+        }
+        else
+        {
+            if (rhs.length() > 0)
+                copy(rhs.buf, rhs.length());
             else
-            {
-                free(buf);
-            }
+                clear();
+            rhs.clear();
         }
-        buf = rhs.buf;
-        bufLen = rhs.bufLen;
-        rhs.buf = NULL;
+    }
+
+    char *heapAlloc(size_t len)
+    {
+#if defined(BOARD_HAS_PSRAM) && defined(MB_STRING_USE_PSRAM)
+        if (ESP.getPsramSize() > 0)
+            return (char *)ps_malloc(len);
+#endif
+        return (char *)malloc(len);
     }
 
     void allocate(size_t len, bool shrink)
@@ -1700,24 +1712,56 @@ private:
 
         if (len == 0)
         {
-            if (buf)
+            if (buf && buf != inlineBuf)
                 free(buf);
             buf = NULL;
             bufLen = 0;
             return;
         }
 
+        // short strings live in inlineBuf, shrinking brings them back from the heap
+        if (len <= MB_STRING_INLINE_SIZE && (!buf || buf == inlineBuf || shrink))
+        {
+            if (buf != inlineBuf)
+            {
+                size_t slen = length();
+                if (slen >= len)
+                    slen = len - 1;
+                if (buf)
+                {
+                    memcpy(inlineBuf, buf, slen);
+                    free(buf);
+                }
+                inlineBuf[slen] = '\0';
+                buf = inlineBuf;
+                bufLen = MB_STRING_INLINE_SIZE;
+            }
+            return;
+        }
+
         if (len > bufLen || shrink)
         {
 
 #if defined(ESP8266_USE_EXTERNAL_HEAP)
             ESP.setExternalHeap();
 #endif
+            size_t slen = length();
+            if (slen >= len)
+                slen = len - 1;
 
-            if (shrink || (bufLen > 0 && buf))
+            if (buf == inlineBuf)
+            {
+                char *p = heapAlloc(len);
+                if (p)
+                {
+                    memcpy(p, buf, slen);
+                    p[slen] = '\0';
+                    buf = p;
+                    bufLen = len;
+                }
+            }
+            else if (shrink || (bufLen > 0 && buf))
             {
-                int slen = length();
-
 #if defined(BOARD_HAS_PSRAM) && defined(MB_STRING_USE_PSRAM)
                 if (ESP.getPsramSize() > 0)
                     buf = (char *)ps_realloc(buf, len);
@@ -1734,14 +1778,7 @@ private:
             }
             else
             {
-#if defined(BOARD_HAS_PSRAM) && defined(MB_STRING_USE_PSRAM)
-                if (ESP.getPsramSize() > 0)
-                    buf = (char *)ps_malloc(len);
-                else
-                    buf = (char *)malloc(len);
-#else
-                buf = (char *)malloc(len);
-#endif
+                buf = heapAlloc(len);
                 if (buf)
                 {
                     buf[0] = '\0';
@@ -2023,6 +2060,7 @@ private:
 
     char *buf = NULL;
     size_t bufLen = 0;
+    char inlineBuf[MB_STRING_INLINE_SIZE > 0 ? MB_STRING_INLINE_SIZE : 1];
 };
 
 inline MB_String operator+(const MB_String &lhs, const MB_String &rhs)
@@ -2044,25 +2082,29 @@ inline MB_String operator+(MB_String &&lhs, const MB_String &rhs)
 
 inline MB_String operator+(MB_String &lhs, MB_String &&rhs)
 {
-    lhs += rhs;
-    return std::move(lhs);
+    MB_String res(lhs);
+    res += rhs;
+    return res;
 }
 
 inline MB_String operator+(MB_String &lhs, char rhs)
 {
-    lhs += rhs;
-    return std::move(lhs);
+    MB_String res(lhs);
+    res += rhs;
+    return res;
 }
 
 inline MB_String operator+(char lhs, MB_String &rhs)
 {
-    rhs.insert(0, lhs);
-    return rhs;
+    MB_String res(rhs);
+    res.insert(0, lhs);
+    return res;
 }
 
 inline MB_String operator+(MB_String &&lhs, char rhs)
 {
-    return std::move(lhs.insert(0, rhs));
+    lhs += rhs;
+    return std::move(lhs);
 }
 
 #endif
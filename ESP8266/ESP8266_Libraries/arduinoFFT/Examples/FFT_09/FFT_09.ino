@@ -0,0 +1,84 @@
+/*
+
+	Example of use of the FFT library to measure a few known frequencies with
+  the Goertzel algorithm.
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+  In this example, the Arduino samples the ADC and measures the level of the
+  first harmonics of a 50 Hz motor. Only these frequencies are evaluated, so
+  no imaginary array is needed and the cost grows with the number of
+  frequencies instead of with a full transform. The samples are weighed with
+  a Hann window on the fly, without being modified.
+*/
+
+#include "arduinoFFT.h"
+
+/*
+These values can be changed in order to evaluate the functions
+*/
+#define CHANNEL A0
+const uint16_t samples = 256;
+const float samplingFrequency = 1000; //Hz, must be less than 10000 due to ADC
+unsigned int sampling_period_us;
+unsigned long microseconds;
+
+/*
+This is the input vector
+*/
+float vData[samples];
+
+/* Frequencies to measure */
+const uint8_t count = 4;
+const float frequencies[count] = {50, 100, 150, 200};
+float levels[count];
+
+/* Create Goertzel object with weighing factor storage */
+ArduinoGoertzel<float> detector = ArduinoGoertzel<float>(samples, samplingFrequency, FFTWindow::Hann, true);
+
+void setup()
+{
+  sampling_period_us = round(1000000*(1.0/samplingFrequency));
+  detector.setFrequencies(frequencies, count);
+  Serial.begin(115200);
+  while(!Serial);
+  Serial.println("Ready");
+}
+
+void loop()
+{
+  /*SAMPLING*/
+  microseconds = micros();
+  for(int i=0; i<samples; i++)
+  {
+      vData[i] = analogRead(CHANNEL);
+      while(micros() - microseconds < sampling_period_us){
+        //empty loop
+      }
+      microseconds += sampling_period_us;
+  }
+  detector.compute(vData);
+  detector.magnitudes(levels);
+  for (uint8_t i = 0; i < count; i++)
+  {
+    Serial.print(frequencies[i], 0);
+    Serial.print("Hz ");
+    Serial.println(levels[i], 2);
+  }
+  Serial.println();
+  delay(2000); /* Repeat after delay */
+}
@@ -0,0 +1,93 @@
+/*
+
+	Example of use of the FFT library to find several peaks and follow a
+  harmonic series
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+  In this example, the Arduino simulates the sampling of a rotating machine
+  whose speed slowly rises: a fundamental around 50 Hz with its second and
+  third harmonics. The five largest peaks are extracted in one scan of the
+  magnitudes, and a tracker follows the fundamental and the level of each
+  harmonic from frame to frame.
+*/
+
+#include "arduinoFFT.h"
+
+/*
+These values can be changed in order to evaluate the functions
+*/
+const uint16_t samples = 128; //This value MUST ALWAYS be a power of 2
+const float samplingFrequency = 1000;
+const uint8_t peaks = 5;
+float signalFrequency = 50;
+
+/*
+These are the input and output vectors
+Input vectors receive computed results from FFT
+*/
+float vReal[samples];
+float vImag[samples];
+float frequencies[peaks];
+float magnitudes[peaks];
+
+/* Create FFT object */
+ArduinoFFT<float> FFT = ArduinoFFT<float>(vReal, vImag, samples, samplingFrequency, true);
+
+/* Track 3 harmonics of a fundamental between 20 Hz and 150 Hz */
+ArduinoFFTHarmonics<float> tracker = ArduinoFFTHarmonics<float>(3, 20, 150);
+
+void setup()
+{
+  Serial.begin(115200);
+  while(!Serial);
+  Serial.println("Ready");
+}
+
+void loop()
+{
+  /* Build raw data */
+  float ratio = twoPi * signalFrequency / samplingFrequency;
+  for (uint16_t i = 0; i < samples; i++)
+  {
+    vReal[i] = 50.0 * sin(i * ratio) + 20.0 * sin(2 * i * ratio) + 10.0 * sin(3 * i * ratio);
+    vImag[i] = 0.0;
+  }
+  FFT.windowing(FFTWindow::Hann, FFTDirection::Forward);
+  FFT.compute(FFTDirection::Forward);
+  FFT.complexToMagnitude();
+  /* Peaks at least 2 bins apart, with Gaussian interpolation */
+  uint8_t found = FFT.majorPeaks(frequencies, magnitudes, peaks, 2, FFTInterpolation::Gaussian);
+  if (tracker.update(frequencies, magnitudes, found))
+  {
+    Serial.print("Fundamental: ");
+    Serial.print(tracker.fundamental(), 2);
+    Serial.print("Hz, harmonics:");
+    for (uint8_t h = 1; h <= 3; h++)
+    {
+      Serial.print(" ");
+      Serial.print(tracker.magnitude(h), 1);
+    }
+    Serial.println();
+  }
+  signalFrequency += 0.5;
+  if (signalFrequency > 100)
+  {
+    signalFrequency = 50;
+  }
+  delay(500);
+}
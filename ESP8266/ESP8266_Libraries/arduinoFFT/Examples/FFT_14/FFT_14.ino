@@ -0,0 +1,69 @@
+/*
+
+	Example of use of the FFT library to run a long FIR filter
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+  In this example, a 128 taps low-pass filter (windowed sinc) is applied to
+  the samples read through the ADC with 512 point FFTs. Each FFT filters 385
+  samples, which costs far less than 128 multiplications per sample. The
+  filtered samples come out with a delay of one block.
+*/
+
+#include "arduinoFFT.h"
+
+/*
+These values can be changed in order to evaluate the functions
+*/
+#define CHANNEL A0
+const uint16_t taps = 128;
+const uint16_t samples = 512; //This value MUST ALWAYS be a power of 2
+const float samplingFrequency = 1000; //Hz, must be less than 10000 due to ADC
+const float cutoffFrequency = 50;
+unsigned int sampling_period_us;
+unsigned long microseconds;
+
+float coefficients[taps];
+ArduinoFFTConvolver<float> *filter;
+
+void setup()
+{
+  sampling_period_us = round(1000000*(1.0/samplingFrequency));
+  /* Build a windowed sinc low-pass filter */
+  float ratio = 2 * cutoffFrequency / samplingFrequency;
+  for (uint16_t i = 0; i < taps; i++)
+  {
+    float x = i - (taps - 1) / 2.0;
+    float sinc = (x == 0) ? ratio : sin(PI * ratio * x) / (PI * x);
+    coefficients[i] = sinc * ArduinoFFT<float>::windowingFactor(FFTWindow::Blackman, i < taps / 2 ? i : taps - 1 - i, taps);
+  }
+  /* The frequency response is computed once here */
+  filter = new ArduinoFFTConvolver<float>(coefficients, taps, samples, FFTConvolution::OverlapSave);
+  Serial.begin(115200);
+  while(!Serial);
+  Serial.println("Ready");
+}
+
+void loop()
+{
+  microseconds = micros();
+  float filtered = filter->push(analogRead(CHANNEL));
+  Serial.println(filtered, 2);
+  while(micros() - microseconds < sampling_period_us){
+    //empty loop
+  }
+}
@@ -0,0 +1,227 @@
+/*
+
+        FFT library, host benchmark
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// Times compute(), computeReal(), windowing() and complexToMagnitude() for
+// float and double over 64 to 4096 samples, and measures the accuracy of the
+// forward transform, of the real-input transform and of the magnitudes against
+// a double precision DFT.
+// Build with the Makefile in this folder, which compiles the library once per
+// combination of FFT_SPEED_OVER_PRECISION and FFT_SQRT_APPROXIMATION.
+
+#include "arduinoFFT.h"
+
+#include <chrono>
+#include <string.h>
+
+// Each timing is repeated until it takes at least this long
+#define MIN_TIME_US 20000
+
+typedef std::chrono::steady_clock Clock;
+
+// Deterministic noise in [-1, 1)
+static double noise(uint32_t *seed) {
+  *seed = (*seed * 1664525) + 1013904223;
+  return ((*seed >> 8) / 8388608.0) - 1.0;
+}
+
+// Reference DFT of a real signal, with exact twiddle factors
+static void reference(const double *x, double *re, double *im,
+                      uint_fast16_t samples) {
+  double *c = new double[samples];
+  double *s = new double[samples];
+  for (uint_fast16_t i = 0; i < samples; i++) {
+    c[i] = cos((6.283185307179586476925 * i) / samples);
+    s[i] = sin((6.283185307179586476925 * i) / samples);
+  }
+  for (uint_fast16_t k = 0; k < samples; k++) {
+    double sumRe = 0;
+    double sumIm = 0;
+    uint_fast32_t index = 0;
+    for (uint_fast16_t n = 0; n < samples; n++) {
+      sumRe += x[n] * c[index];
+      sumIm -= x[n] * s[index];
+      index += k;
+      if (index >= samples) {
+        index -= samples;
+      }
+    }
+    re[k] = sumRe;
+    im[k] = sumIm;
+  }
+  delete[] c;
+  delete[] s;
+}
+
+// Signal to noise ratio in dB of a result against its reference
+static double snr(double signal, double error) {
+  if (error == 0) {
+    return 999.9;
+  }
+  return 10 * log10(signal / error);
+}
+
+enum class Operation { Compute, Radix4, Real, Windowing, Magnitude };
+
+// Average time in microseconds of an operation on fresh copies of the input.
+// The cost of the copy is measured separately and subtracted.
+template <typename T>
+static double timeOperation(Operation op, const T *input, T *vReal, T *vImag,
+                            uint_fast16_t samples, bool copyOnly) {
+  ArduinoFFT<T> FFT(vReal, vImag, samples, 1000, true);
+  if (op == Operation::Radix4) {
+    FFT.setKernel(FFTKernel::Radix4);
+  }
+  long runs = 0;
+  Clock::time_point start = Clock::now();
+  double elapsed;
+  do {
+    for (int i = 0; i < 16; i++) {
+      memcpy(vReal, input, samples * sizeof(T));
+      memcpy(vImag, input + samples, samples * sizeof(T));
+      if (copyOnly) {
+        continue;
+      }
+      switch (op) {
+      case Operation::Compute:
+      case Operation::Radix4:
+        FFT.compute(FFTDirection::Forward);
+        break;
+      case Operation::Real:
+        FFT.computeReal(FFTDirection::Forward);
+        break;
+      case Operation::Windowing:
+        FFT.windowing(FFTWindow::Hamming, FFTDirection::Forward);
+        break;
+      case Operation::Magnitude:
+        FFT.complexToMagnitude();
+        break;
+      }
+    }
+    runs += 16;
+    elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start)
+                  .count();
+  } while (elapsed < MIN_TIME_US);
+  return elapsed / runs;
+}
+
+template <typename T> static void run(const char *name) {
+  for (uint_fast16_t samples = 64; samples <= 4096; samples <<= 1) {
+    double *x = new double[samples];
+    double *refRe = new double[samples];
+    double *refIm = new double[samples];
+    T *input = new T[samples * 2];
+    T *vReal = new T[samples];
+    T *vImag = new T[samples];
+    uint32_t seed = samples;
+    for (uint_fast16_t i = 0; i < samples; i++) {
+      x[i] = noise(&seed);
+      input[i] = x[i];
+      input[samples + i] = 0;
+    }
+    // Round the reference input the same way as the tested one
+    for (uint_fast16_t i = 0; i < samples; i++) {
+      x[i] = input[i];
+    }
+    reference(x, refRe, refIm, samples);
+
+    // Accuracy of the transform and of the magnitudes
+    memcpy(vReal, input, samples * sizeof(T));
+    memcpy(vImag, input + samples, samples * sizeof(T));
+    ArduinoFFT<T> FFT(vReal, vImag, samples, 1000);
+    FFT.compute(FFTDirection::Forward);
+    double signal = 0;
+    double error = 0;
+    for (uint_fast16_t k = 0; k < samples; k++) {
+      signal += sq(refRe[k]) + sq(refIm[k]);
+      error += sq(vReal[k] - refRe[k]) + sq(vImag[k] - refIm[k]);
+    }
+    double computeSnr = snr(signal, error);
+    FFT.complexToMagnitude();
+    signal = 0;
+    error = 0;
+    for (uint_fast16_t k = 0; k <= (samples >> 1); k++) {
+      double magnitude = sqrt(sq(refRe[k]) + sq(refIm[k]));
+      signal += sq(magnitude);
+      error += sq(vReal[k] - magnitude);
+    }
+    double magnitudeSnr = snr(signal, error);
+    memcpy(vReal, input, samples * sizeof(T));
+    memcpy(vImag, input + samples, samples * sizeof(T));
+    FFT.computeReal(FFTDirection::Forward);
+    signal = 0;
+    error = 0;
+    for (uint_fast16_t k = 0; k <= (samples >> 1); k++) {
+      signal += sq(refRe[k]) + sq(refIm[k]);
+      error += sq(vReal[k] - refRe[k]) + sq(vImag[k] - refIm[k]);
+    }
+    double realSnr = snr(signal, error);
+
+    // Timings
+    double copy =
+        timeOperation(Operation::Compute, input, vReal, vImag, samples, true);
+    double us[5];
+    for (int op = 0; op < 5; op++) {
+      us[op] = timeOperation(static_cast<Operation>(op), input, vReal, vImag,
+                             samples, false) -
+               copy;
+    }
+    printf("%-6s %5u %10.2f %10.2f %10.2f %10.2f %10.2f %8.1f %8.1f %8.1f\n",
+           name, (unsigned)samples, us[0], us[1], us[2], us[3], us[4],
+           computeSnr, realSnr, magnitudeSnr);
+    delete[] x;
+    delete[] refRe;
+    delete[] refIm;
+    delete[] input;
+    delete[] vReal;
+    delete[] vImag;
+  }
+}
+
+int main(void) {
+  printf("arduinoFFT host benchmark\n");
+#ifdef FFT_SPEED_OVER_PRECISION
+  printf("FFT_SPEED_OVER_PRECISION on, ");
+#else
+  printf("FFT_SPEED_OVER_PRECISION off, ");
+#endif
+#ifdef FFT_SQRT_APPROXIMATION
+  printf("FFT_SQRT_APPROXIMATION on, ");
+#else
+  printf("FFT_SQRT_APPROXIMATION off, ");
+#endif
+#if defined(FFT_NO_SIMD)
+  printf("scalar kernels\n\n");
+#elif defined(__AVX2__)
+  printf("AVX2 kernels for float\n\n");
+#elif defined(__SSE2__)
+  printf("SSE2 kernels for float\n\n");
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  printf("NEON kernels for float\n\n");
+#else
+  printf("scalar kernels\n\n");
+#endif
+  printf("%-6s %5s %10s %10s %10s %10s %10s %8s %8s %8s\n", "type", "N",
+         "compute", "radix-4", "real", "windowing", "magnitude", "SNR",
+         "real SNR", "mag SNR");
+  printf("%-6s %5s %10s %10s %10s %10s %10s %8s %8s %8s\n", "", "", "(us)",
+         "(us)", "(us)", "(us)", "(us)", "(dB)", "(dB)", "(dB)");
+  run<float>("float");
+  run<double>("double");
+  return 0;
+}
@@ -0,0 +1,52 @@
+/*
+
+        FFT library, target backends
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoFFTBackend_h /* Prevent loading library twice */
+#define ArduinoFFTBackend_h
+
+// The core of the library is the same on every target. Whatever depends on
+// the target lives in one backend header, picked here at compile time:
+//
+//   FFTSample                   sample type of ArduinoFFTDefault
+//   FFT_PROGMEM                 storage of the constant tables
+//   FFT_RAM_PLANS               1 when fftReadTable() also reads RAM, so
+//                               FFTPlan can compute its table at run time
+//   fftReadTable(p)             reads a value of such a table
+//   fftRotationTable(l, c1, c2) twiddle rotation of stage l from a table,
+//                               false when it has to be computed
+//   kernelStage(...)            radix-2 stage, false when not handled
+//   kernelMagnitude(...)        magnitudes, returns how many were computed
+//   kernelWindowing(...)        precompiled window, returns how many factors
+//                               were applied
+//
+// The kernels return constants where a target has none, so the calls fold
+// away instead of branching at run time.
+//
+// AVR and ESP8266 keep their tables in flash. ESP32 and host builds keep them
+// in RAM, and host builds add vector kernels for float.
+
+#if defined(__AVR__)
+#include "arduinoFFTBackendAVR.h"
+#elif defined(ESP8266)
+#include "arduinoFFTBackendESP8266.h"
+#else
+#include "arduinoFFTBackendRAM.h"
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+/*
+
+        FFT library, ESP8266 backend
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoFFTBackendESP8266_h /* Prevent loading library twice */
+#define ArduinoFFTBackendESP8266_h
+
+// Tables in flash, so the compile-time tables of ArduinoFFTStatic take no RAM.
+// Flash is mapped into the address space and read through aligned 32-bit
+// loads, which the pgm_read functions also do on RAM addresses, so tables
+// built at run time go through the same reads.
+
+#include <pgmspace.h>
+
+typedef float FFTSample;
+
+#define FFT_PROGMEM PROGMEM
+#define FFT_RAM_PLANS 1
+
+template <typename T> static inline T fftReadTable(const T *p) {
+  T value;
+  memcpy_P(&value, p, sizeof(T));
+  return value;
+}
+
+static inline float fftReadTable(const float *p) { return pgm_read_float(p); }
+
+static inline uint16_t fftReadTable(const uint16_t *p) {
+  return pgm_read_word(p);
+}
+
+static inline int32_t fftReadTable(const int32_t *p) {
+  return (int32_t)pgm_read_dword(p);
+}
+
+template <typename T>
+static inline bool fftRotationTable(uint_fast8_t, T *, T *) {
+  return false;
+}
+
+// No vector unit
+template <typename T>
+static inline bool kernelStage(T *, T *, uint_fast16_t, uint_fast8_t,
+                               FFTDirection, const FFTPlan<T> *, T, T) {
+  return false;
+}
+
+template <typename T>
+static inline uint_fast16_t kernelMagnitude(T *, T *, uint_fast16_t) {
+  return 0;
+}
+
+template <typename T>
+static inline uint_fast16_t kernelWindowing(T *, uint_fast16_t, const T *,
+                                            FFTDirection) {
+  return 0;
+}
+
+#endif
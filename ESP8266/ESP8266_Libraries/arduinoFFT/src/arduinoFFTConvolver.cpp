@@ -0,0 +1,160 @@
+/*
+
+        FFT library, block convolution
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "arduinoFFT.h"
+
+template <typename T>
+ArduinoFFTConvolver<T>::ArduinoFFTConvolver(const T *taps,
+                                            uint_fast16_t tapCount,
+                                            uint_fast16_t samples,
+                                            FFTConvolution method)
+    : _method(method), _samples(samples), _tapCount(tapCount) {
+  // The taps must leave room for at least one new sample per block
+  if (tapCount == 0 || tapCount > samples) {
+    return;
+  }
+  uint_fast16_t half = (samples >> 1);
+  _vReal = new T[samples];
+  _vImag = new T[half + 1];
+  _hReal = new T[half + 1];
+  _hImag = new T[half + 1];
+  _history = new T[tapCount];
+  _blockSize = samples - tapCount + 1;
+  _input = new T[_blockSize];
+  _output = new T[_blockSize];
+  if (!_vReal || !_vImag || !_hReal || !_hImag || !_history || !_input ||
+      !_output) {
+    _blockSize = 0;
+    return;
+  }
+  // Frequency response of the zero-padded taps
+  for (uint_fast16_t i = 0; i < samples; i++) {
+    _vReal[i] = (i < tapCount) ? taps[i] : 0;
+  }
+  _fft.computeReal(_vReal, _vImag, samples, FFTDirection::Forward);
+  for (uint_fast16_t i = 0; i <= half; i++) {
+    _hReal[i] = _vReal[i];
+    _hImag[i] = _vImag[i];
+  }
+  reset();
+}
+
+template <typename T> ArduinoFFTConvolver<T>::~ArduinoFFTConvolver(void) {
+  // Destructor
+  delete[] _vReal;
+  delete[] _vImag;
+  delete[] _hReal;
+  delete[] _hImag;
+  delete[] _history;
+  delete[] _input;
+  delete[] _output;
+}
+
+// Number of samples taken and returned by process(), 0 if the filter could
+// not be set up
+template <typename T>
+uint_fast16_t ArduinoFFTConvolver<T>::blockSize(void) const {
+  return _blockSize;
+}
+
+// Filters blockSize() samples. input and output may be the same array.
+template <typename T>
+void ArduinoFFTConvolver<T>::process(const T *input, T *output) {
+  if (!_blockSize) {
+    return;
+  }
+  uint_fast16_t overlap = _tapCount - 1;
+  if (_method == FFTConvolution::OverlapSave) {
+    // The last input samples of the previous block come first
+    for (uint_fast16_t i = 0; i < overlap; i++) {
+      _vReal[i] = _history[i];
+    }
+    for (uint_fast16_t i = 0; i < _blockSize; i++) {
+      _vReal[overlap + i] = input[i];
+    }
+    for (uint_fast16_t i = 0; i < overlap; i++) {
+      _history[i] = _vReal[_blockSize + i];
+    }
+    filter();
+    // The first values are wrapped around by the circular convolution
+    for (uint_fast16_t i = 0; i < _blockSize; i++) {
+      output[i] = _vReal[overlap + i];
+    }
+  } else {
+    for (uint_fast16_t i = 0; i < _blockSize; i++) {
+      _vReal[i] = input[i];
+    }
+    for (uint_fast16_t i = _blockSize; i < _samples; i++) {
+      _vReal[i] = 0;
+    }
+    filter();
+    // Add the tail of the previous block and keep this one's
+    for (uint_fast16_t i = 0; i < _blockSize; i++) {
+      output[i] = _vReal[i] + ((i < overlap) ? _history[i] : 0);
+    }
+    for (uint_fast16_t i = 0; i < overlap; i++) {
+      _history[i] = _vReal[_blockSize + i];
+    }
+  }
+}
+
+// Filters one sample, the output is delayed by blockSize() samples
+template <typename T> T ArduinoFFTConvolver<T>::push(T sample) {
+  if (!_blockSize) {
+    return 0;
+  }
+  T result = _output[_position];
+  _input[_position] = sample;
+  if (++_position == _blockSize) {
+    process(_input, _output);
+    _position = 0;
+  }
+  return result;
+}
+
+// Clears the state, as if the input had been zero
+template <typename T> void ArduinoFFTConvolver<T>::reset(void) {
+  if (!_blockSize) {
+    return;
+  }
+  for (uint_fast16_t i = 0; i < _tapCount; i++) {
+    _history[i] = 0;
+  }
+  for (uint_fast16_t i = 0; i < _blockSize; i++) {
+    _output[i] = 0;
+  }
+  _position = 0;
+}
+
+// Private functions
+
+// Circular convolution of vReal with the taps
+template <typename T> void ArduinoFFTConvolver<T>::filter(void) {
+  _fft.computeReal(_vReal, _vImag, _samples, FFTDirection::Forward);
+  for (uint_fast16_t i = 0; i <= (_samples >> 1); i++) {
+    T re = (_vReal[i] * _hReal[i]) - (_vImag[i] * _hImag[i]);
+    T im = (_vReal[i] * _hImag[i]) + (_vImag[i] * _hReal[i]);
+    _vReal[i] = re;
+    _vImag[i] = im;
+  }
+  _fft.computeReal(_vReal, _vImag, _samples, FFTDirection::Reverse);
+}
+
+template class ArduinoFFTConvolver<double>;
+template class ArduinoFFTConvolver<float>;
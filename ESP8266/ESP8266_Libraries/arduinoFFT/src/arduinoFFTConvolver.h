@@ -0,0 +1,67 @@
+/*
+
+        FFT library, block convolution
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoFFTConvolver_h /* Prevent loading library twice */
+#define ArduinoFFTConvolver_h
+
+// FIR filtering through FFTs of `samples` points (a power of 2). The
+// frequency response of the taps is computed once. Each block of
+// samples - taps + 1 input values then costs a forward and a reverse
+// computeReal() and one complex multiplication per bin, instead of `taps`
+// multiplications per sample. A size of about 2 to 4 times the number of taps
+// is usually the fastest.
+//
+// process() filters whole blocks. push() filters one sample at a time and
+// returns the output delayed by one block.
+template <typename T> class ArduinoFFTConvolver {
+public:
+  ArduinoFFTConvolver(const T *taps, uint_fast16_t tapCount,
+                      uint_fast16_t samples,
+                      FFTConvolution method = FFTConvolution::OverlapSave);
+
+  ~ArduinoFFTConvolver();
+
+  uint_fast16_t blockSize(void) const;
+
+  void process(const T *input, T *output);
+
+  T push(T sample);
+
+  void reset(void);
+
+private:
+  /* Variables */
+  uint_fast16_t _blockSize = 0;
+  ArduinoFFT<T> _fft;
+  T *_hImag = nullptr;
+  T *_hReal = nullptr;
+  T *_history = nullptr;
+  T *_input = nullptr;
+  FFTConvolution _method;
+  T *_output = nullptr;
+  uint_fast16_t _position = 0;
+  uint_fast16_t _samples;
+  uint_fast16_t _tapCount;
+  T *_vImag = nullptr;
+  T *_vReal = nullptr;
+  /* Functions */
+  void filter(void);
+};
+
+#endif
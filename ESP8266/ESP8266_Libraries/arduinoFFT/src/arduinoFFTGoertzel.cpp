@@ -0,0 +1,180 @@
+/*
+
+        FFT library, Goertzel detector
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "arduinoFFT.h"
+
+template <typename T>
+ArduinoGoertzel<T>::ArduinoGoertzel(uint_fast16_t samples, T samplingFrequency,
+                                    FFTWindow windowType,
+                                    bool windowingFactors)
+    : _samples(samples), _samplingFrequency(samplingFrequency),
+      _windowFunction(windowType) {
+  if (windowingFactors) {
+    _precompiledWindowingFactors = new T[samples / 2];
+  }
+}
+
+template <typename T> ArduinoGoertzel<T>::~ArduinoGoertzel(void) {
+  // Destructor
+  if (_precompiledWindowingFactors) {
+    delete[] _precompiledWindowingFactors;
+  }
+  freeBins();
+}
+
+// Runs the detector over samples values of vData
+template <typename T> void ArduinoGoertzel<T>::compute(const T *vData) {
+  if (_precompiledWindowingFactors && !_isPrecompiled &&
+      _windowFunction != FFTWindow::Rectangle) {
+    for (uint_fast16_t i = 0; i < (_samples >> 1); i++) {
+      _precompiledWindowingFactors[i] = ArduinoFFT<T>::windowingFactor(
+          _windowFunction, i, _samples);
+    }
+    _isPrecompiled = true;
+  }
+  for (uint_fast16_t n = 0; n < ((uint_fast16_t)_bins << 1); n++) {
+    _state[n] = 0;
+  }
+  uint_fast16_t half = _samples >> 1;
+  for (uint_fast16_t i = 0; i < _samples; i++) {
+    T value = vData[i];
+    if (_windowFunction != FFTWindow::Rectangle) {
+      // The window is symmetric, only the first half is computed
+      uint_fast16_t index = (i < half) ? i : (_samples - (i + 1));
+      value *= _isPrecompiled
+                   ? _precompiledWindowingFactors[index]
+                   : ArduinoFFT<T>::windowingFactor(_windowFunction, index,
+                                                    _samples);
+    }
+    // s(n) = x(n) + 2 * cos(w) * s(n - 1) - s(n - 2)
+    for (uint_fast8_t n = 0; n < _bins; n++) {
+      T *s = &_state[n << 1];
+      T s0 = value + (2 * _rotation[n << 2] * s[0]) - s[1];
+      s[1] = s[0];
+      s[0] = s0;
+    }
+  }
+  // X = e^(-i * w * N) * (e^(i * w) * s(N - 1) - s(N - 2)), stored in place
+  for (uint_fast8_t n = 0; n < _bins; n++) {
+    T *r = &_rotation[n << 2];
+    T *s = &_state[n << 1];
+    T re = (r[0] * s[0]) - s[1];
+    T im = r[1] * s[0];
+    s[0] = (re * r[2]) + (im * r[3]);
+    s[1] = (im * r[2]) - (re * r[3]);
+  }
+}
+
+// Magnitude of the n-th bin, scaled like the output of compute()
+template <typename T> T ArduinoGoertzel<T>::magnitude(uint_fast8_t n) const {
+  if (n >= _bins) {
+    return 0;
+  }
+  return sqrt(sq(_state[n << 1]) + sq(_state[(n << 1) + 1]));
+}
+
+// Writes the magnitudes of all the bins in vData
+template <typename T> void ArduinoGoertzel<T>::magnitudes(T *vData) const {
+  for (uint_fast8_t n = 0; n < _bins; n++) {
+    vData[n] = magnitude(n);
+  }
+}
+
+// Phase of the n-th bin in radians, relative to the first sample
+template <typename T> T ArduinoGoertzel<T>::phase(uint_fast8_t n) const {
+  if (n >= _bins) {
+    return 0;
+  }
+  return atan2(_state[(n << 1) + 1], _state[n << 1]);
+}
+
+// Selects the bins to evaluate by index
+template <typename T>
+bool ArduinoGoertzel<T>::setBins(const uint_fast16_t *bins,
+                                 uint_fast8_t count) {
+  if (!allocate(count)) {
+    return false;
+  }
+  for (uint_fast8_t n = 0; n < count; n++) {
+    setBin(n, bins[n]);
+  }
+  return true;
+}
+
+// Selects the bins to evaluate by frequency
+template <typename T>
+bool ArduinoGoertzel<T>::setFrequencies(const T *frequencies,
+                                        uint_fast8_t count) {
+  if (!allocate(count)) {
+    return false;
+  }
+  for (uint_fast8_t n = 0; n < count; n++) {
+    setBin(n, (frequencies[n] * _samples) / _samplingFrequency);
+  }
+  return true;
+}
+
+template <typename T> void ArduinoGoertzel<T>::setWindow(FFTWindow windowType) {
+  if (windowType != _windowFunction) {
+    _windowFunction = windowType;
+    _isPrecompiled = false;
+  }
+}
+
+// Private functions
+
+template <typename T> bool ArduinoGoertzel<T>::allocate(uint_fast8_t count) {
+  freeBins();
+  if (count == 0) {
+    return true;
+  }
+  _rotation = new T[count << 2];
+  _state = new T[count << 1];
+  if (!_rotation || !_state) {
+    freeBins();
+    return false;
+  }
+  for (uint_fast16_t n = 0; n < ((uint_fast16_t)count << 1); n++) {
+    _state[n] = 0;
+  }
+  _bins = count;
+  return true;
+}
+
+// Also frees the buffers of an allocate() that failed halfway
+template <typename T> void ArduinoGoertzel<T>::freeBins(void) {
+  delete[] _rotation;
+  delete[] _state;
+  _rotation = nullptr;
+  _state = nullptr;
+  _bins = 0;
+}
+
+// Records cos(w), sin(w), cos(w * N) and sin(w * N) for a (fractional) bin
+template <typename T> void ArduinoGoertzel<T>::setBin(uint_fast8_t n, T bin) {
+  T angle = (twoPi * bin) / _samples;
+  T *r = &_rotation[n << 2];
+  r[0] = cos(angle);
+  r[1] = sin(angle);
+  r[2] = cos(twoPi * bin);
+  r[3] = sin(twoPi * bin);
+}
+
+template class ArduinoGoertzel<double>;
+template class ArduinoGoertzel<float>;
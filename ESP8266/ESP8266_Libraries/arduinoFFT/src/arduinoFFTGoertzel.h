@@ -0,0 +1,68 @@
+/*
+
+        FFT library, Goertzel detector
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoGoertzel_h /* Prevent loading library twice */
+#define ArduinoGoertzel_h
+
+// Evaluates a few bins of the spectrum with the Goertzel algorithm. Each bin
+// costs one multiplication and two additions per sample, so for a handful of
+// bins this is cheaper than a full transform, and no imaginary array is
+// needed. The input is not modified.
+//
+// The window is applied on the fly with the same factors as
+// ArduinoFFT::windowing() (without compensation), so magnitudes and phases
+// match those of compute() on the windowed data. Bins may be given as
+// indexes or as frequencies, which don't need to fall on a bin.
+template <typename T> class ArduinoGoertzel {
+public:
+  ArduinoGoertzel(uint_fast16_t samples, T samplingFrequency,
+                  FFTWindow windowType = FFTWindow::Rectangle,
+                  bool windowingFactors = false);
+
+  ~ArduinoGoertzel();
+
+  void compute(const T *vData);
+
+  T magnitude(uint_fast8_t n) const;
+  void magnitudes(T *vData) const;
+
+  T phase(uint_fast8_t n) const;
+
+  bool setBins(const uint_fast16_t *bins, uint_fast8_t count);
+  bool setFrequencies(const T *frequencies, uint_fast8_t count);
+
+  void setWindow(FFTWindow windowType);
+
+private:
+  /* Variables */
+  uint_fast8_t _bins = 0;
+  bool _isPrecompiled = false;
+  T *_precompiledWindowingFactors = nullptr;
+  T *_rotation = nullptr;
+  uint_fast16_t _samples;
+  T _samplingFrequency;
+  T *_state = nullptr;
+  FFTWindow _windowFunction;
+  /* Functions */
+  bool allocate(uint_fast8_t count);
+  void freeBins(void);
+  void setBin(uint_fast8_t n, T bin);
+};
+
+#endif
@@ -0,0 +1,165 @@
+/*
+
+        FFT library, harmonic series tracker
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "arduinoFFT.h"
+
+template <typename T>
+ArduinoFFTHarmonics<T>::ArduinoFFTHarmonics(uint_fast8_t harmonics,
+                                            T minFrequency, T maxFrequency,
+                                            T tolerance, T smoothing)
+    : _harmonics(harmonics), _maxFrequency(maxFrequency),
+      _minFrequency(minFrequency), _smoothing(smoothing),
+      _tolerance(tolerance) {
+  _magnitudes = new T[harmonics];
+  reset();
+}
+
+template <typename T> ArduinoFFTHarmonics<T>::~ArduinoFFTHarmonics(void) {
+  // Destructor
+  delete[] _magnitudes;
+}
+
+// Frequency of a harmonic, 1 being the fundamental
+template <typename T>
+T ArduinoFFTHarmonics<T>::frequency(uint_fast8_t harmonic) const {
+  return _fundamental * harmonic;
+}
+
+template <typename T> T ArduinoFFTHarmonics<T>::fundamental(void) const {
+  return _fundamental;
+}
+
+template <typename T> bool ArduinoFFTHarmonics<T>::locked(void) const {
+  return _locked;
+}
+
+// Magnitude of a harmonic, 1 being the fundamental
+template <typename T>
+T ArduinoFFTHarmonics<T>::magnitude(uint_fast8_t harmonic) const {
+  if (harmonic == 0 || harmonic > _harmonics || !_magnitudes) {
+    return 0;
+  }
+  return _magnitudes[harmonic - 1];
+}
+
+template <typename T> void ArduinoFFTHarmonics<T>::reset(void) {
+  _fundamental = 0;
+  _locked = false;
+  if (_magnitudes) {
+    for (uint_fast8_t h = 0; h < _harmonics; h++) {
+      _magnitudes[h] = 0;
+    }
+  }
+}
+
+// Updates the estimates with the peaks of a new frame. Returns true if a
+// harmonic series was found in them.
+template <typename T>
+bool ArduinoFFTHarmonics<T>::update(const T *frequencies, const T *magnitudes,
+                                    uint_fast8_t count) {
+  if (!_magnitudes) {
+    return false;
+  }
+  T best = 0;
+  T bestScore = 0;
+  // The previous estimate competes with the candidates from the peaks
+  if (_locked) {
+    best = fit(_fundamental, frequencies, magnitudes, count, &bestScore);
+  }
+  for (uint_fast8_t n = 0; n < count; n++) {
+    for (uint_fast8_t h = 1; h <= _harmonics; h++) {
+      T candidate = frequencies[n] / h;
+      if (candidate < _minFrequency || candidate > _maxFrequency) {
+        continue;
+      }
+      T score;
+      T refined = fit(candidate, frequencies, magnitudes, count, &score);
+      // A lower fundamental with the same peaks would score the same, so
+      // prefer the highest of ties
+      if (score > bestScore * (1.0 + _tolerance)) {
+        best = refined;
+        bestScore = score;
+      }
+    }
+  }
+  if (bestScore == 0) {
+    // Nothing found, the harmonics fade out
+    for (uint_fast8_t h = 0; h < _harmonics; h++) {
+      _magnitudes[h] *= (1.0 - _smoothing);
+    }
+    _locked = false;
+    return false;
+  }
+  bool follows =
+      _locked && (fabs(best - _fundamental) <= (_tolerance * _fundamental));
+  _fundamental = follows ? _fundamental + _smoothing * (best - _fundamental)
+                         : best;
+  for (uint_fast8_t h = 0; h < _harmonics; h++) {
+    int_fast16_t n = match(_fundamental * (h + 1), frequencies, count);
+    T measured = (n < 0) ? 0 : magnitudes[n];
+    _magnitudes[h] = follows
+                         ? _magnitudes[h] + _smoothing * (measured - _magnitudes[h])
+                         : measured;
+  }
+  _locked = true;
+  return true;
+}
+
+// Private functions
+
+// Least squares fundamental of the peaks matching the harmonics of a
+// candidate, weighted by magnitude. The score is the sum of their magnitudes.
+template <typename T>
+T ArduinoFFTHarmonics<T>::fit(T candidate, const T *frequencies,
+                              const T *magnitudes, uint_fast8_t count,
+                              T *score) const {
+  T numerator = 0;
+  T denominator = 0;
+  *score = 0;
+  for (uint_fast8_t h = 1; h <= _harmonics; h++) {
+    int_fast16_t n = match(candidate * h, frequencies, count);
+    if (n < 0) {
+      continue;
+    }
+    *score += magnitudes[n];
+    numerator += magnitudes[n] * h * frequencies[n];
+    denominator += magnitudes[n] * h * h;
+  }
+  if (denominator == 0) {
+    return candidate;
+  }
+  return numerator / denominator;
+}
+
+// Index of the largest peak within tolerance of a frequency, -1 if none. The
+// peaks from majorPeaks() are sorted by decreasing magnitude.
+template <typename T>
+int_fast16_t ArduinoFFTHarmonics<T>::match(T target, const T *frequencies,
+                                           uint_fast8_t count) const {
+  T margin = _tolerance * target;
+  for (uint_fast8_t n = 0; n < count; n++) {
+    if (fabs(frequencies[n] - target) <= margin) {
+      return n;
+    }
+  }
+  return -1;
+}
+
+template class ArduinoFFTHarmonics<double>;
+template class ArduinoFFTHarmonics<float>;
@@ -0,0 +1,236 @@
+/*
+
+        FFT library, compile-time sized transforms
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoFFTStatic_h /* Prevent loading library twice */
+#define ArduinoFFTStatic_h
+
+// ArduinoFFTStatic<T, N, W> is an ArduinoFFT<T> whose size N and window W are
+// fixed at compile time. The bit reversal permutation, the twiddle factors and
+// the window factors are constexpr tables, stored where the backend keeps
+// its tables (FFT_PROGMEM), so the object needs no heap and no setup work.
+//
+// The tables are generated by the compiler for each N and W in use, so this
+// part of the library lives in the header. Only C++11 constexpr is used.
+
+/* Compile-time math */
+
+// Taylor series terms of cos and sin, enough for double precision on
+// [0, pi / 4]
+constexpr double fftConstCosSeries(double x2, double term, uint8_t n) {
+  return (n > 12) ? term
+                  : term + fftConstCosSeries(
+                               x2, -term * x2 / ((2 * n + 1) * (2 * n + 2)),
+                               n + 1);
+}
+
+constexpr double fftConstSinSeries(double x2, double term, uint8_t n) {
+  return (n > 12) ? term
+                  : term + fftConstSinSeries(
+                               x2, -term * x2 / ((2 * n + 2) * (2 * n + 3)),
+                               n + 1);
+}
+
+// cos(x) for x in [0, pi]
+constexpr double fftConstCosReduced(double x) {
+  return (x > twoPiDouble / 4)
+             ? -fftConstCosReduced(twoPiDouble / 2 - x)
+         : (x > twoPiDouble / 8)
+             ? fftConstSinSeries(sq(twoPiDouble / 4 - x), twoPiDouble / 4 - x,
+                                 0)
+             : fftConstCosSeries(sq(x), 1.0, 0);
+}
+
+// cos(x) for x in [-pi, 3 * pi]
+constexpr double fftConstCos(double x) {
+  return (x < 0) ? fftConstCos(-x)
+         : (x > twoPiDouble / 2) ? fftConstCos(twoPiDouble - x)
+             : fftConstCosReduced(x);
+}
+
+constexpr double fftConstAbs(double x) { return (x < 0) ? -x : x; }
+
+// Same formulas as ArduinoFFT::windowingFactor()
+constexpr double fftConstWindow(FFTWindow windowType, uint16_t index,
+                                uint16_t samples) {
+  return (windowType == FFTWindow::Hamming)
+             ? 0.54 - (0.46 * fftConstCos(twoPi * index / (samples - 1.0)))
+         : (windowType == FFTWindow::Hann)
+             ? 0.54 * (1.0 - fftConstCos(twoPi * index / (samples - 1.0)))
+         : (windowType == FFTWindow::Triangle)
+             ? 1.0 - ((2.0 * fftConstAbs(index - ((samples - 1.0) / 2.0))) /
+                      (samples - 1.0))
+         : (windowType == FFTWindow::Nuttall)
+             ? 0.355768 -
+                   (0.487396 * fftConstCos(twoPi * index / (samples - 1.0))) +
+                   (0.144232 * fftConstCos(fourPi * index / (samples - 1.0))) -
+                   (0.012604 * fftConstCos(sixPi * index / (samples - 1.0)))
+         : (windowType == FFTWindow::Blackman)
+             ? 0.42323 -
+                   (0.49755 * fftConstCos(twoPi * index / (samples - 1.0))) +
+                   (0.07922 * fftConstCos(fourPi * index / (samples - 1.0)))
+         : (windowType == FFTWindow::Blackman_Nuttall)
+             ? 0.3635819 -
+                   (0.4891775 * fftConstCos(twoPi * index / (samples - 1.0))) +
+                   (0.1365995 * fftConstCos(fourPi * index / (samples - 1.0))) -
+                   (0.0106411 * fftConstCos(sixPi * index / (samples - 1.0)))
+         : (windowType == FFTWindow::Blackman_Harris)
+             ? 0.35875 -
+                   (0.48829 * fftConstCos(twoPi * index / (samples - 1.0))) +
+                   (0.14128 * fftConstCos(fourPi * index / (samples - 1.0))) -
+                   (0.01168 * fftConstCos(sixPi * index / (samples - 1.0)))
+         : (windowType == FFTWindow::Flat_top)
+             ? 0.2810639 -
+                   (0.5208972 * fftConstCos(twoPi * index / (samples - 1.0))) +
+                   (0.1980399 * fftConstCos(fourPi * index / (samples - 1.0)))
+         : (windowType == FFTWindow::Welch)
+             ? 1.0 - sq((index - (samples - 1.0) / 2.0) /
+                        ((samples - 1.0) / 2.0))
+             : 1.0;
+}
+
+// index with its lowest bits reversed
+constexpr uint16_t fftConstReverse(uint16_t index, uint8_t bits,
+                                   uint16_t result = 0) {
+  return (bits == 0) ? result
+                     : fftConstReverse(index >> 1, bits - 1,
+                                       (result << 1) | (index & 1));
+}
+
+constexpr uint8_t fftConstExponent(uint16_t value) {
+  return (value <= 1) ? 0 : 1 + fftConstExponent(value >> 1);
+}
+
+/* Compile-time tables */
+
+// List 0, 1, ..., N - 1 built by halves, so the template depth is log2(N)
+template <uint16_t... I> struct FFTIndexes {};
+
+template <typename A, typename B> struct FFTConcatIndexes;
+template <uint16_t... I, uint16_t... J>
+struct FFTConcatIndexes<FFTIndexes<I...>, FFTIndexes<J...>> {
+  typedef FFTIndexes<I..., (sizeof...(I) + J)...> type;
+};
+
+template <uint16_t N> struct FFTMakeIndexes {
+  typedef typename FFTConcatIndexes<
+      typename FFTMakeIndexes<N / 2>::type,
+      typename FFTMakeIndexes<N - N / 2>::type>::type type;
+};
+template <> struct FFTMakeIndexes<0> { typedef FFTIndexes<> type; };
+template <> struct FFTMakeIndexes<1> { typedef FFTIndexes<0> type; };
+
+// cos(2 * pi * i / N) for i in [0, N / 2), the table layout of FFTPlan
+template <typename T, uint16_t N, typename I> struct FFTStaticCosine;
+template <typename T, uint16_t N, uint16_t... I>
+struct FFTStaticCosine<T, N, FFTIndexes<I...>> {
+  static constexpr T values[sizeof...(I)] FFT_PROGMEM = {
+      T(fftConstCos((twoPiDouble * I) / N))...};
+};
+template <typename T, uint16_t N, uint16_t... I>
+constexpr T FFTStaticCosine<T, N, FFTIndexes<I...>>::values[sizeof...(I)];
+
+// First half of the symmetric window
+template <typename T, uint16_t N, FFTWindow W, typename I>
+struct FFTStaticWindow;
+template <typename T, uint16_t N, FFTWindow W, uint16_t... I>
+struct FFTStaticWindow<T, N, W, FFTIndexes<I...>> {
+  static constexpr T values[sizeof...(I)] FFT_PROGMEM = {
+      T(fftConstWindow(W, I, N))...};
+};
+template <typename T, uint16_t N, FFTWindow W, uint16_t... I>
+constexpr T FFTStaticWindow<T, N, W, FFTIndexes<I...>>::values[sizeof...(I)];
+
+// Bit reversal permutation of N values
+template <uint16_t N, typename I> struct FFTStaticBitReversal;
+template <uint16_t N, uint16_t... I>
+struct FFTStaticBitReversal<N, FFTIndexes<I...>> {
+  static constexpr uint16_t values[sizeof...(I)] FFT_PROGMEM = {
+      fftConstReverse(I, fftConstExponent(N))...};
+};
+template <uint16_t N, uint16_t... I>
+constexpr uint16_t
+    FFTStaticBitReversal<N, FFTIndexes<I...>>::values[sizeof...(I)];
+
+template <typename T, uint16_t N, FFTWindow W = FFTWindow::Hamming>
+class ArduinoFFTStatic : public ArduinoFFT<T> {
+  static_assert(N >= 4 && (N & (N - 1)) == 0,
+                "N must be a power of 2 of at least 4");
+  // The tables hold the factors as they are, not scaled to Q15/Q31
+  static_assert(T(0.5) != T(0),
+                "T must be a floating point type, use ArduinoFFT<int16_t> or "
+                "ArduinoFFT<int32_t> for fixed point");
+
+public:
+  static constexpr uint8_t power = fftConstExponent(N);
+
+  ArduinoFFTStatic(T *vReal, T *vImag, T samplingFrequency)
+      : ArduinoFFT<T>(vReal, vImag, N, samplingFrequency),
+        _staticPlan(Cosine::values, N) {
+    this->setPlan(&_staticPlan);
+    this->_bitReversal = BitReversal::values;
+  }
+
+  using ArduinoFFT<T>::compute;
+  using ArduinoFFT<T>::computeReal;
+  using ArduinoFFT<T>::windowing;
+
+  void compute(FFTDirection dir) const {
+    ArduinoFFT<T>::compute(this->_vReal, this->_vImag, N, power, dir);
+  }
+
+  void computeReal(FFTDirection dir) const {
+    ArduinoFFT<T>::computeReal(this->_vReal, this->_vImag, N, power, dir);
+  }
+
+  // Only points the object to other arrays of N values, without allocating
+  // windowing factors like ArduinoFFT::setArrays()
+  void setArrays(T *vReal, T *vImag) {
+    ArduinoFFT<T>::setArrays(vReal, vImag, 0);
+  }
+
+  // Applies the window W from the table
+  void windowing(FFTDirection dir) const {
+    T *vData = this->_vReal;
+    for (uint_fast16_t i = 0; i < (N >> 1); i++) {
+      T factor = fftReadTable(&Window::values[i]);
+      if (dir == FFTDirection::Forward) {
+        vData[i] *= factor;
+        vData[N - (i + 1)] *= factor;
+      } else {
+        vData[i] /= factor;
+        vData[N - (i + 1)] /= factor;
+      }
+    }
+  }
+
+private:
+  typedef FFTStaticCosine<T, N, typename FFTMakeIndexes<N / 2>::type> Cosine;
+  typedef FFTStaticWindow<T, N, W, typename FFTMakeIndexes<N / 2>::type>
+      Window;
+  typedef FFTStaticBitReversal<N, typename FFTMakeIndexes<N>::type>
+      BitReversal;
+
+  /* Variables */
+  FFTPlan<T> _staticPlan;
+};
+
+template <typename T, uint16_t N, FFTWindow W>
+constexpr uint8_t ArduinoFFTStatic<T, N, W>::power;
+
+#endif
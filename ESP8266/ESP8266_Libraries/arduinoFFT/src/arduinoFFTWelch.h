@@ -0,0 +1,64 @@
+/*
+
+        FFT library, Welch power spectral density
+
+        This program is free software: you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation, either version 3 of the License, or
+        (at your option) any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ArduinoFFTWelch_h /* Prevent loading library twice */
+#define ArduinoFFTWelch_h
+
+// Averages the power spectrum of successive frames (Welch's method). Each
+// add() windows the real samples in vReal, transforms them with
+// computeReal() and accumulates |X|^2 for bins 0 to samples / 2, so vImag
+// only needs (samples / 2) + 1 values. Overlapping frames can be fed from an
+// ArduinoFFTStream or by hand.
+//
+// psd() scales the average as a one-sided density in units^2 / Hz, using the
+// power of the window. powerSpectrum() scales it with the window amplitude
+// compensation, so a sinusoid of amplitude A centered on a bin reads A^2 / 2.
+template <typename T> class ArduinoFFTWelch {
+public:
+  ArduinoFFTWelch(T *vReal, T *vImag, uint_fast16_t samples,
+                  T samplingFrequency, FFTWindow windowType = FFTWindow::Hann);
+
+  ~ArduinoFFTWelch();
+
+  void add(void);
+
+  uint_fast32_t frames(void) const;
+
+  void powerSpectrum(T *vData) const;
+
+  void psd(T *vData) const;
+
+  void reset(void);
+
+private:
+  /* Variables */
+  T *_accumulator = nullptr;
+  ArduinoFFT<T> _fft;
+  uint_fast32_t _frames = 0;
+  uint_fast16_t _samples;
+  T _samplingFrequency;
+  T *_vImag;
+  T *_vReal;
+  FFTWindow _windowType;
+  T _windowPower = 0;
+  /* Functions */
+  void average(T *vData, T scale) const;
+};
+
+#endif
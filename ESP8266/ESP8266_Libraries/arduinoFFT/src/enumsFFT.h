@@ -22,6 +22,8 @@
 
 /* Mathematial constants */
 #define twoPi 6.28318531
+/* twoPi only holds float precision, which would cap the accuracy of doubles */
+#define twoPiDouble 6.283185307179586476925
 #define fourPi 12.56637061
 #define sixPi 18.84955593
 
@@ -39,5 +41,25 @@ enum class FFTWindow {
   Precompiled       // Placeholder for using custom or precompiled window values
 };
 
+enum class FFTConvolution {
+  OverlapAdd, // zero-padded blocks, the tails are added to the next block
+  OverlapSave // overlapping blocks, the wrapped-around part is discarded
+};
+
 enum class FFTDirection { Forward, Reverse };
+
+enum class FFTInterpolation {
+  Parabola, // parabola through the three bins around a peak
+  Gaussian  // parabola through their logarithms, exact for Gaussian peaks
+};
+
+enum class FFTLayout {
+  Planar,     // one channel after the other: vData[channel * samples + i]
+  Interleaved // one sample of each channel: vData[i * channels + channel]
+};
+
+enum class FFTKernel {
+  Radix2, // radix-2 butterflies
+  Radix4  // radix-4 butterflies, radix-2 first stage for odd powers
+};
 #endif
\ No newline at end of file